@@ -0,0 +1,5 @@
+find_package(PkgConfig REQUIRED)
+pkg_check_modules(brotli REQUIRED IMPORTED_TARGET libbrotlienc libbrotlidec)
+
+add_library(roar-brotli INTERFACE)
+target_link_libraries(roar-brotli INTERFACE PkgConfig::brotli)
\ No newline at end of file
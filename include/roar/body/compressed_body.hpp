@@ -0,0 +1,167 @@
+#pragma once
+
+#include <roar/mechanics/compression.hpp>
+#include <roar/literals/memory.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Roar
+{
+    /**
+     * @brief Wraps another body, which is compressed while it is written if the route has compression options and the
+     * client accepts one of the supported codings (see RouteOptions::compression). Compressed responses are sent
+     * chunked, in pieces of about chunkSize bytes, so memory use does not grow with the size of the body.
+     *
+     * @tparam BodyT The wrapped body, for instance http::string_body or http::file_body.
+     */
+    template <typename BodyT>
+    struct CompressedBody
+    {
+        constexpr static std::size_t chunkSize = 16_KiB;
+
+        /**
+         * @brief Is the value of the wrapped body, so it can be filled like that one.
+         */
+        class value_type : public BodyT::value_type
+        {
+          public:
+            using BodyT::value_type::value_type;
+            using BodyT::value_type::operator=;
+
+            value_type() = default;
+            value_type(typename BodyT::value_type&& inner)
+                : BodyT::value_type(std::move(inner))
+            {}
+
+            /// Set by the session when the response is committed.
+            ContentCoding contentCoding = ContentCoding::Identity;
+            int compressionLevel = -1;
+        };
+
+        /**
+         * @brief The size of the wrapped body, if it has one.
+         */
+        static std::optional<std::uint64_t> uncompressedSize(value_type const& body)
+        {
+            if constexpr (requires { BodyT::size(body); })
+                return static_cast<std::uint64_t>(BodyT::size(body));
+            else
+                return std::nullopt;
+        }
+
+        class writer
+        {
+          public:
+            using const_buffers_type = std::span<boost::asio::const_buffer const>;
+
+            template <bool isRequest, class Fields>
+            writer(boost::beast::http::header<isRequest, Fields>& header, value_type& body)
+                : inner_{header, static_cast<typename BodyT::value_type&>(body)}
+                , contentCoding_{body.contentCoding}
+                , compressionLevel_{body.compressionLevel}
+                , compressor_{}
+                , output_{}
+                , buffers_{}
+                , finished_{false}
+            {}
+
+            void init(boost::beast::error_code& ec)
+            {
+                inner_.init(ec);
+                if (ec || contentCoding_ == ContentCoding::Identity)
+                    return;
+
+                try
+                {
+                    compressor_.emplace(contentCoding_, compressionLevel_);
+                }
+                catch (...)
+                {
+                    ec = boost::system::errc::make_error_code(boost::system::errc::not_supported);
+                }
+            }
+
+            boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec)
+            {
+                buffers_.clear();
+                if (!compressor_)
+                {
+                    auto next = inner_.get(ec);
+                    if (ec || !next)
+                        return boost::none;
+                    for (auto buffer : boost::beast::buffers_range_ref(next->first))
+                        buffers_.push_back(buffer);
+                    return {{const_buffers_type{buffers_}, next->second}};
+                }
+
+                output_.clear();
+                while (!finished_ && output_.size() < chunkSize)
+                {
+                    auto next = inner_.get(ec);
+                    if (ec)
+                        return boost::none;
+
+                    if (next)
+                    {
+                        for (auto buffer : boost::beast::buffers_range_ref(next->first))
+                        {
+                            if (!compressor_->compress(
+                                    {static_cast<char const*>(buffer.data()), buffer.size()}, false, output_))
+                                return fail(ec);
+                        }
+                    }
+
+                    if (!next || !next->second)
+                    {
+                        if (!compressor_->compress({}, true, output_))
+                            return fail(ec);
+                        finished_ = true;
+                    }
+                }
+
+                if (output_.empty())
+                    return boost::none;
+                buffers_.emplace_back(output_.data(), output_.size());
+                return {{const_buffers_type{buffers_}, !finished_}};
+            }
+
+          private:
+            boost::none_t fail(boost::beast::error_code& ec)
+            {
+                ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+                return boost::none;
+            }
+
+          private:
+            typename BodyT::writer inner_;
+            ContentCoding contentCoding_;
+            int compressionLevel_;
+            std::optional<StreamCompressor> compressor_;
+            std::string output_;
+            std::vector<boost::asio::const_buffer> buffers_;
+            bool finished_;
+        };
+    };
+
+    namespace Detail
+    {
+        template <typename>
+        struct IsCompressedBody : std::false_type
+        {};
+        template <typename BodyT>
+        struct IsCompressedBody<CompressedBody<BodyT>> : std::true_type
+        {};
+    }
+}
@@ -1,16 +1,28 @@
 #pragma once
 
 #include <roar/mechanics/ranges.hpp>
+#include <roar/detail/send_file.hpp>
+#include <roar/detail/file_io.hpp>
+#include <boost/beast/core/file.hpp>
 #include <boost/beast/http/message.hpp>
 #include <roar/literals/memory.hpp>
 
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <ios>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <random>
 #include <string_view>
+#include <system_error>
 #include <algorithm>
+#include <iterator>
+#include <vector>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#endif
 
 namespace Roar
 {
@@ -23,6 +35,9 @@ namespace Roar
         {
             constexpr static unsigned SplitterLength = 16;
 
+          public:
+            constexpr static std::size_t defaultBufferSize = 128_KiB;
+
           private:
             struct Sequence
             {
@@ -64,6 +79,9 @@ namespace Roar
           public:
             RangeFileBodyImpl()
                 : file_{}
+                , fileSize_{0}
+                , bufferSize_{defaultBufferSize}
+                , advisedUntil_{0}
                 , sequences_{}
                 , splitter_(SplitterLength + 2, '-')
                 , totalSize_{0}
@@ -84,11 +102,21 @@ namespace Roar
             RangeFileBodyImpl& operator=(RangeFileBodyImpl const&) = delete;
             RangeFileBodyImpl& operator=(RangeFileBodyImpl&&) = default;
 
-            std::fstream& file()
+            /**
+             * @brief The opened file. This is a boost::beast::file and no longer a std::fstream, because reads use
+             * pread and sendfile on the native handle. Use its read, seek and pos members instead of stream
+             * operations.
+             */
+            boost::beast::file& file()
             {
                 return file_;
             }
 
+            boost::beast::file::native_handle_type nativeHandle() const
+            {
+                return file_.native_handle();
+            }
+
             std::uint64_t size() const
             {
                 return totalSize_;
@@ -109,13 +137,27 @@ namespace Roar
                 return {sequences_.rbegin()->start, sequences_.rbegin()->end};
             }
 
-            std::uint64_t fileSize()
+            /**
+             * @brief The size of the file, determined when it was opened.
+             */
+            std::uint64_t fileSize() const
+            {
+                return fileSize_;
+            }
+
+            /**
+             * @brief Sets how much is read from the file per write to the client. Defaults to defaultBufferSize.
+             */
+            void bufferSize(std::size_t size)
             {
-                auto pos = file_.tellg();
-                file_.seekg(0, std::ios::end);
-                auto size = file_.tellg();
-                file_.seekg(pos);
-                return static_cast<std::uint64_t>(size);
+                if (size == 0)
+                    throw std::invalid_argument("Buffer size must not be 0");
+                bufferSize_ = size;
+            }
+
+            std::size_t bufferSize() const
+            {
+                return bufferSize_;
             }
 
             bool isOpen() const
@@ -125,30 +167,35 @@ namespace Roar
 
             void close()
             {
-                file_.close();
+                boost::beast::error_code ec;
+                file_.close(ec);
             }
 
             /**
              * @brief Opens the file.
              *
              * @param filename
-             * @param mode
-             * @param ec
+             * @param mode in to read, out (optionally with in and trunc) to write a truncated file, in | out to write an
+             * existing file and app to append. The file is always opened in binary mode. Other modes, like ate, are
+             * not supported.
+             * @param ec Set to std::errc::invalid_argument for unsupported modes.
              */
             void open(std::filesystem::path const& filename, std::ios_base::openmode mode, std::error_code& ec)
             {
                 ec = {};
-                auto excMask = file_.exceptions();
-                file_.exceptions(excMask | std::ios::failbit | std::ios::badbit);
-                try
+                const auto fileMode = toFileMode(mode);
+                if (!fileMode)
                 {
-                    file_.open(filename, std::ios::binary | mode);
+                    ec = std::make_error_code(std::errc::invalid_argument);
+                    return;
                 }
-                catch (std::system_error& e)
-                {
-                    ec = e.code();
-                }
-                file_.exceptions(excMask);
+
+                boost::beast::error_code beastEc;
+                file_.open(filename.string().c_str(), *fileMode, beastEc);
+                if (!beastEc)
+                    fileSize_ = file_.size(beastEc);
+                if (beastEc)
+                    ec = std::error_code{beastEc.value(), std::system_category()};
             }
 
             /**
@@ -164,23 +211,19 @@ namespace Roar
 
                 if (ranges.ranges.size() > 1)
                 {
-                    std::size_t totalFile = fileSize();
                     sequences_.resize(ranges.ranges.size() + 1);
 
-                    if (ranges.ranges.empty())
-                        throw std::runtime_error("No ranges specified");
-
                     for (auto const& range : ranges.ranges)
                     {
                         if (range.end < range.start)
                             throw std::invalid_argument("end < start");
-                        if (range.end > fileSize())
+                        if (range.end > fileSize_)
                             throw std::invalid_argument("range.end > file size");
                     }
 
                     std::transform(
                         ranges.ranges.begin(), ranges.ranges.end(), sequences_.rbegin(), [&, this](auto const& range) {
-                            auto seq = Sequence{range.start, range.end, totalFile, contentType, splitter_};
+                            auto seq = Sequence{range.start, range.end, fileSize_, contentType, splitter_};
                             totalSize_ += seq.headSection.size() + (range.end - range.start);
                             return seq;
                         });
@@ -194,53 +237,64 @@ namespace Roar
                     sequences_.resize(1);
                     sequences_.front() = Sequence{ranges.ranges.front().start, ranges.ranges.front().end};
                     totalSize_ = ranges.ranges.front().end - ranges.ranges.front().start;
-                    file_.seekg(static_cast<std::streamoff>(ranges.ranges.front().start));
                 }
+                advisedUntil_ = 0;
             }
 
             /**
-             * @brief Reads some of the multipart data into the buffer.
+             * @brief Reads some of the (multipart) data into the buffer. Each range is read with positional reads of up
+             * to the buffer size, a short read returns early.
              *
              * @param buf
              * @param amount
-             * @return std::size_t
+             * @return std::size_t The amount of bytes read, 0 on error.
              */
             std::size_t read(char* buf, std::size_t amount)
             {
-                std::uint64_t origAmount = amount;
-                auto& current = sequences_.back();
-
-                if (current.headConsumed != current.headSection.size())
+                std::size_t produced = 0;
+                while (amount > 0 && !sequences_.empty())
                 {
-                    auto copied = current.headSection.copy(
-                        buf,
-                        std::min(
-                            static_cast<std::uint64_t>(amount),
-                            static_cast<std::uint64_t>(current.headSection.size()) - current.headConsumed),
-                        current.headConsumed);
-                    buf += copied;
-                    current.headConsumed += copied;
-                    consumed_ += copied;
-                    amount -= copied;
-                    if (amount > 0)
-                        file_.seekg(static_cast<std::streamoff>(current.start));
+                    auto& current = sequences_.back();
+
+                    if (current.headConsumed != current.headSection.size())
+                    {
+                        const auto copied = current.headSection.copy(
+                            buf,
+                            static_cast<std::size_t>(std::min(
+                                static_cast<std::uint64_t>(amount),
+                                static_cast<std::uint64_t>(current.headSection.size()) - current.headConsumed)),
+                            static_cast<std::size_t>(current.headConsumed));
+                        buf += copied;
+                        current.headConsumed += copied;
+                        consumed_ += copied;
+                        produced += copied;
+                        amount -= copied;
+                    }
+
+                    if (amount > 0 && current.start != current.end)
+                    {
+                        adviseReadahead(current);
+                        const auto toRead = static_cast<std::size_t>(
+                            std::min(static_cast<std::uint64_t>(amount), current.end - current.start));
+                        const auto readCount = readAt(current.start, buf, toRead);
+                        if (readCount == 0)
+                            return produced;
+                        buf += readCount;
+                        current.start += readCount;
+                        consumed_ += readCount;
+                        produced += readCount;
+                        amount -= readCount;
+                        if (current.start != current.end)
+                            return produced;
+                    }
+
+                    if (current.headConsumed == current.headSection.size() && current.start == current.end)
+                    {
+                        sequences_.pop_back();
+                        advisedUntil_ = 0;
+                    }
                 }
-                file_.read(
-                    buf,
-                    static_cast<std::streamoff>(
-                        std::min(static_cast<std::uint64_t>(amount), current.end - current.start)));
-                auto gcount = static_cast<std::uint64_t>(file_.gcount());
-                consumed_ += gcount;
-                current.start += gcount;
-                amount -= gcount;
-                if (current.start == current.end)
-                    sequences_.pop_back();
-
-                if (sequences_.empty())
-                    return (origAmount - amount); // amount should be 0 at this point.
-                if (amount > 0)
-                    return (origAmount - amount) + read(buf + gcount, amount);
-                return origAmount;
+                return produced;
             }
 
             /**
@@ -253,32 +307,33 @@ namespace Roar
              */
             std::streamsize write(char const* buf, std::streamsize amount, bool& error)
             {
-                file_.write(buf, amount);
-                // totalBytesProcessed_ += amount;
-                if (file_.fail())
+                boost::beast::error_code ec;
+                const auto written = file_.write(buf, static_cast<std::size_t>(amount), ec);
+                if (ec)
                     error = true;
-                return amount;
+                return static_cast<std::streamsize>(written);
             }
 
             /**
-             * @brief Resets the file stream with a new stream.
+             * @brief Resets the body with a new file.
              *
-             * @param file A fresh fstream.
+             * @param file An open file.
              */
-            void reset(std::fstream&& file)
+            void reset(boost::beast::file&& file)
             {
-                if (isOpen())
-                    file_.close();
+                close();
                 file_ = std::move(file);
+                boost::beast::error_code ec;
+                fileSize_ = file_.size(ec);
             }
 
             /**
-             * @brief Resets the fstream state and goes back to the start.
+             * @brief Goes back to the start of the file for writing.
              */
             void reset()
             {
-                file_.clear();
-                file_.seekg(0, std::ios::beg);
+                boost::beast::error_code ec;
+                file_.seek(0, ec);
             }
 
             std::string boundary() const
@@ -286,8 +341,75 @@ namespace Roar
                 return splitter_;
             }
 
+            /**
+             * @brief Describes the not yet consumed body as multipart heads followed by file ranges, in sending order.
+             * Allows sending the ranges without reading them through this object.
+             */
+            std::vector<SendFileSegment> segments() const
+            {
+                std::vector<SendFileSegment> result;
+                result.reserve(sequences_.size());
+                std::transform(sequences_.rbegin(), sequences_.rend(), std::back_inserter(result), [](auto const& seq) {
+                    return SendFileSegment{
+                        .prefix = seq.headSection.substr(static_cast<std::size_t>(seq.headConsumed)),
+                        .offset = seq.start,
+                        .length = seq.end - seq.start,
+                    };
+                });
+                return result;
+            }
+
+          private:
+            static std::optional<boost::beast::file_mode> toFileMode(std::ios_base::openmode mode)
+            {
+                using std::ios_base;
+                mode &= ~ios_base::binary;
+                if (mode == ios_base::in)
+                    return boost::beast::file_mode::read;
+                if (mode == ios_base::out || mode == (ios_base::out | ios_base::trunc) ||
+                    mode == (ios_base::in | ios_base::out | ios_base::trunc))
+                    return boost::beast::file_mode::write;
+                if (mode == (ios_base::in | ios_base::out))
+                    return boost::beast::file_mode::write_existing;
+                if (mode == ios_base::app || mode == (ios_base::out | ios_base::app))
+                    return boost::beast::file_mode::append;
+                return std::nullopt;
+            }
+
+            std::size_t readAt(std::uint64_t offset, char* buf, std::size_t amount)
+            {
+                boost::beast::error_code ec;
+                const auto readCount = Detail::readAt(file_, offset, buf, amount, ec);
+                return ec ? 0 : readCount;
+            }
+
+            /**
+             * @brief Asks the kernel to read ahead the next few buffers of the current range, so reads hit the page
+             * cache. Only a window is advised to not pull huge ranges into memory at once.
+             */
+            void adviseReadahead([[maybe_unused]] Sequence const& current)
+            {
+#if !defined(_WIN32) && !defined(__APPLE__)
+                if (current.start < advisedUntil_)
+                    return;
+                const auto window = std::min(
+                    current.end - current.start, static_cast<std::uint64_t>(readaheadBuffers) * bufferSize_);
+                ::posix_fadvise(
+                    file_.native_handle(),
+                    static_cast<off_t>(current.start),
+                    static_cast<off_t>(window),
+                    POSIX_FADV_WILLNEED);
+                advisedUntil_ = current.start + window;
+#endif
+            }
+
           private:
-            std::fstream file_{};
+            constexpr static unsigned readaheadBuffers = 4;
+
+            boost::beast::file file_{};
+            std::uint64_t fileSize_;
+            std::size_t bufferSize_;
+            std::uint64_t advisedUntil_;
             // are inserted in reverse order, so we can pop_back.
             std::vector<Sequence> sequences_;
             std::string splitter_;
@@ -295,17 +417,6 @@ namespace Roar
             std::uint64_t consumed_;
         };
 
-        constexpr static std::uint64_t bufferSize()
-        {
-            using namespace MemoryLiterals;
-            return 1_MemoryPage;
-        }
-
-        template <unsigned Size>
-        struct Buffer
-        {
-            char buf_[Size];
-        };
     }
 
     /**
@@ -330,7 +441,7 @@ namespace Roar
           private:
             value_type& body_;
         };
-        class writer : private Detail::Buffer<Detail::bufferSize()>
+        class writer
         {
           public:
             using const_buffers_type = boost::asio::const_buffer;
@@ -342,6 +453,7 @@ namespace Roar
 
           private:
             value_type& body_;
+            Detail::AlignedBuffer buffer_;
         };
 
         static std::uint64_t size(value_type const& vt)
@@ -389,6 +501,8 @@ namespace Roar
     template <bool isRequest, class Fields>
     inline RangeFileBody::writer::writer(boost::beast::http::header<isRequest, Fields>&, value_type& bodyValue)
         : body_{bodyValue}
+        , buffer_{static_cast<std::size_t>(
+              std::min<std::uint64_t>(bodyValue.bufferSize(), std::max<std::uint64_t>(bodyValue.size(), 1)))}
     {
         if (!body_.isOpen())
             throw std::invalid_argument{"File must be open"};
@@ -401,7 +515,7 @@ namespace Roar
     RangeFileBody::writer::get(boost::beast::error_code& ec)
     {
         const auto remain = body_.remaining();
-        const auto amount = remain > sizeof(buf_) ? sizeof(buf_) : static_cast<std::size_t>(remain);
+        const auto amount = remain > buffer_.size() ? buffer_.size() : static_cast<std::size_t>(remain);
 
         if (amount == 0)
         {
@@ -409,7 +523,7 @@ namespace Roar
             return boost::none;
         }
 
-        const auto readCount = body_.read(buf_, amount);
+        const auto readCount = body_.read(buffer_.data(), amount);
         if (readCount == 0)
         {
             ec = boost::beast::http::error::short_read;
@@ -421,8 +535,8 @@ namespace Roar
 
         ec = {};
         return {{
-            const_buffers_type{buf_, readCount},
-            remain > 0,
+            const_buffers_type{buffer_.data(), readCount},
+            remain > readCount,
         }};
     }
 }
\ No newline at end of file
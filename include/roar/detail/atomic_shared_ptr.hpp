@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace Roar::Detail
+{
+    /**
+     * @brief A shared pointer that can be loaded and replaced concurrently without locking on the reader side.
+     * Uses std::atomic<std::shared_ptr> where the standard library provides it.
+     */
+    template <typename T>
+    class AtomicSharedPtr
+    {
+      public:
+        AtomicSharedPtr(std::shared_ptr<T> ptr = {})
+            : ptr_{std::move(ptr)}
+        {}
+
+        std::shared_ptr<T> load() const
+        {
+#ifdef __cpp_lib_atomic_shared_ptr
+            return ptr_.load(std::memory_order_acquire);
+#else
+            return std::atomic_load_explicit(&ptr_, std::memory_order_acquire);
+#endif
+        }
+
+        void store(std::shared_ptr<T> ptr)
+        {
+#ifdef __cpp_lib_atomic_shared_ptr
+            ptr_.store(std::move(ptr), std::memory_order_release);
+#else
+            std::atomic_store_explicit(&ptr_, std::move(ptr), std::memory_order_release);
+#endif
+        }
+
+      private:
+#ifdef __cpp_lib_atomic_shared_ptr
+        std::atomic<std::shared_ptr<T>> ptr_;
+#else
+        std::shared_ptr<T> ptr_;
+#endif
+    };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define ROAR_CHARACTER_SCAN_SSE2 1
+#endif
+
+namespace Roar::Detail
+{
+    /**
+     * @brief Returns the value of a hexadecimal digit or -1 if c is none.
+     */
+    constexpr int hexDigitValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    /**
+     * @brief Sets the high bit of every byte in word that is zero. Bits above the lowest zero byte may be false
+     * positives, so only the lowest set bit is reliable.
+     */
+    constexpr std::uint64_t zeroBytes(std::uint64_t word)
+    {
+        return (word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL;
+    }
+
+    /**
+     * @brief Finds the first character in [begin, end) that is one of Chars.
+     * Compares 16 bytes at a time with SSE2 and 8 bytes at a time (SWAR) on other little endian targets.
+     *
+     * @return char const* The position of the character or end if there is none.
+     */
+    template <char... Chars>
+    char const* findFirstOf(char const* begin, char const* end)
+    {
+#ifdef ROAR_CHARACTER_SCAN_SSE2
+        while (end - begin >= 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin));
+            __m128i hits = _mm_setzero_si128();
+            ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+            if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0)
+                return begin + std::countr_zero(mask);
+            begin += 16;
+        }
+#else
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            while (end - begin >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, begin, sizeof(word));
+                std::uint64_t hits = 0;
+                ((hits |= zeroBytes(word ^ (0x0101010101010101ULL * static_cast<unsigned char>(Chars)))), ...);
+                if (hits != 0)
+                    return begin + std::countr_zero(hits) / 8;
+                begin += 8;
+            }
+        }
+#endif
+        for (; begin != end; ++begin)
+        {
+            if (((*begin == Chars) || ...))
+                return begin;
+        }
+        return end;
+    }
+}
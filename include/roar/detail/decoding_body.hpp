@@ -0,0 +1,161 @@
+#pragma once
+
+#include <roar/mechanics/compression.hpp>
+#include <roar/literals/memory.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Roar::Detail
+{
+    /**
+     * @brief Used by Session::readDecoded to decode request bodies with a Content-Encoding before they reach the
+     * reader of BodyT. Decoded bytes count against decodedBodyLimit, so small compressed bodies cannot expand into
+     * huge ones.
+     */
+    template <typename BodyT>
+    struct DecodingBody
+    {
+        constexpr static std::size_t chunkSize = 64_KiB;
+
+        class value_type : public BodyT::value_type
+        {
+          public:
+            using BodyT::value_type::value_type;
+            using BodyT::value_type::operator=;
+
+            value_type() = default;
+            value_type(typename BodyT::value_type&& inner)
+                : BodyT::value_type(std::move(inner))
+            {}
+
+            /// Limit of the decoded body size.
+            boost::optional<std::uint64_t> decodedBodyLimit = boost::none;
+
+            /// Size of the decoded body, only set once a body with a content coding was decoded completely.
+            std::optional<std::uint64_t> decodedSize = std::nullopt;
+        };
+
+        class reader
+        {
+          public:
+            template <bool isRequest, class Fields>
+            reader(boost::beast::http::header<isRequest, Fields>& header, value_type& body)
+                : inner_{header, static_cast<typename BodyT::value_type&>(body)}
+                , body_{body}
+                , fields_{header}
+                , contentCoding_{}
+                , decompressor_{}
+                , output_{}
+                , decodedSize_{0}
+            {}
+
+            void init(boost::optional<std::uint64_t> const& length, boost::beast::error_code& ec)
+            {
+                // The parser creates the reader before the header is parsed, so the coding and the limit are only
+                // known here.
+                const auto contentEncoding = fields_[boost::beast::http::field::content_encoding];
+                contentCoding_ = parseContentCoding({contentEncoding.data(), contentEncoding.size()});
+                if (contentCoding_ == ContentCoding::Identity)
+                    return inner_.init(length, ec);
+
+                try
+                {
+                    if (!contentCoding_)
+                        throw std::invalid_argument("Unknown content coding.");
+                    decompressor_.emplace(*contentCoding_);
+                }
+                catch (...)
+                {
+                    ec = boost::system::errc::make_error_code(boost::system::errc::not_supported);
+                    return;
+                }
+                inner_.init(boost::none, ec);
+            }
+
+            template <class ConstBufferSequence>
+            std::size_t put(ConstBufferSequence const& buffers, boost::beast::error_code& ec)
+            {
+                if (!decompressor_)
+                    return inner_.put(buffers, ec);
+
+                std::size_t consumed = 0;
+                for (auto buffer : boost::beast::buffers_range_ref(buffers))
+                {
+                    std::string_view input{static_cast<char const*>(buffer.data()), buffer.size()};
+                    do
+                    {
+                        output_.clear();
+                        const auto previousInput = input.size();
+                        if (!decompressor_->decompress(input, output_, chunkSize))
+                            return fail(ec, boost::system::errc::bad_message);
+                        if (input.size() == previousInput && output_.empty())
+                        {
+                            if (input.empty())
+                                break;
+                            return fail(ec, boost::system::errc::bad_message);
+                        }
+
+                        decodedSize_ += output_.size();
+                        if (body_.decodedBodyLimit && decodedSize_ > *body_.decodedBodyLimit)
+                        {
+                            ec = boost::beast::http::error::body_limit;
+                            return 0;
+                        }
+
+                        for (std::size_t written = 0; written < output_.size();)
+                        {
+                            written +=
+                                inner_.put(boost::asio::buffer(output_.data() + written, output_.size() - written), ec);
+                            if (ec)
+                                return 0;
+                        }
+                    } while (!input.empty() || output_.size() == chunkSize);
+                    consumed += buffer.size();
+                }
+                return consumed;
+            }
+
+            void finish(boost::beast::error_code& ec)
+            {
+                if (decompressor_ && !decompressor_->finished())
+                {
+                    fail(ec, boost::system::errc::bad_message);
+                    return;
+                }
+                inner_.finish(ec);
+                if (!ec && decompressor_)
+                    body_.decodedSize = decodedSize_;
+            }
+
+          private:
+            std::size_t fail(boost::beast::error_code& ec, boost::system::errc::errc_t error)
+            {
+                ec = boost::system::errc::make_error_code(error);
+                return 0;
+            }
+
+          private:
+            typename BodyT::reader inner_;
+            value_type& body_;
+            boost::beast::http::fields const& fields_;
+            std::optional<ContentCoding> contentCoding_;
+            std::optional<StreamDecompressor> decompressor_;
+            std::string output_;
+            std::uint64_t decodedSize_;
+        };
+    };
+}
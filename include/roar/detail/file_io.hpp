@@ -0,0 +1,88 @@
+#pragma once
+
+#include <roar/literals/memory.hpp>
+
+#include <boost/beast/core/file.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#ifndef _WIN32
+#    include <unistd.h>
+#endif
+
+namespace Roar::Detail
+{
+    /**
+     * @brief Page aligned buffer for file reads.
+     */
+    class AlignedBuffer
+    {
+      public:
+        constexpr static std::size_t alignment = 1_MemoryPage;
+
+        explicit AlignedBuffer(std::size_t size)
+            : data_{static_cast<char*>(::operator new(size, std::align_val_t{alignment}))}
+            , size_{size}
+        {}
+
+        char* data()
+        {
+            return data_.get();
+        }
+
+        std::size_t size() const
+        {
+            return size_;
+        }
+
+      private:
+        struct Deleter
+        {
+            void operator()(char* data) const
+            {
+                ::operator delete(data, std::align_val_t{alignment});
+            }
+        };
+
+        std::unique_ptr<char, Deleter> data_;
+        std::size_t size_;
+    };
+
+    /**
+     * @brief Reads from the given offset without using the file position (pread). Can be called concurrently for
+     * the same file, except on windows, where the file position is used.
+     *
+     * @return The amount of bytes read. Less than amount at the end of the file.
+     */
+    inline std::size_t readAt(
+        boost::beast::file& file,
+        std::uint64_t offset,
+        char* buf,
+        std::size_t amount,
+        boost::system::error_code& ec)
+    {
+        ec = {};
+#ifdef _WIN32
+        file.seek(offset, ec);
+        if (ec)
+            return 0;
+        return file.read(buf, amount, ec);
+#else
+        for (;;)
+        {
+            const auto readCount = ::pread(file.native_handle(), buf, amount, static_cast<off_t>(offset));
+            if (readCount >= 0)
+                return static_cast<std::size_t>(readCount);
+            if (errno != EINTR)
+            {
+                ec = {errno, boost::system::system_category()};
+                return 0;
+            }
+        }
+#endif
+    }
+}
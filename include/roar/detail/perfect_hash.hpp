@@ -0,0 +1,160 @@
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Roar::Detail
+{
+    /**
+     * @brief FNV-1a over the verb and path, mixed with a seed.
+     */
+    constexpr std::uint64_t hashRoute(boost::beast::http::verb method, std::string_view path, std::uint64_t seed)
+    {
+        constexpr std::uint64_t prime = 0x100000001b3ULL;
+        std::uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+        hash = (hash ^ static_cast<std::uint64_t>(method)) * prime;
+        for (auto c : path)
+            hash = (hash ^ static_cast<std::uint8_t>(c)) * prime;
+        // Final avalanche, so that the low bits used for the modulo depend on all input bytes.
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * @brief An immutable map from verb+path to values using a hash and displace perfect hash function.
+     * Every lookup hashes the key twice and does at most one string comparison.
+     *
+     * @tparam ValueT The mapped type.
+     */
+    template <typename ValueT>
+    class PerfectHashTable
+    {
+      public:
+        struct Entry
+        {
+            boost::beast::http::verb method;
+            std::string path;
+            ValueT value;
+        };
+
+        PerfectHashTable() = default;
+
+        /**
+         * @brief Builds the table. If a verb+path pair is given twice, the first one is kept.
+         *
+         * @throws std::runtime_error if no perfect hash function could be found.
+         */
+        explicit PerfectHashTable(std::vector<Entry> entries)
+        {
+            entries = withoutDuplicates(std::move(entries));
+            if (entries.empty())
+                return;
+
+            const auto bucketCount = entries.size();
+            const auto slotCount = entries.size() + entries.size() / 4 + 1;
+            std::vector<std::vector<std::size_t>> buckets(bucketCount);
+            for (std::size_t i = 0; i != entries.size(); ++i)
+                buckets[hashRoute(entries[i].method, entries[i].path, 0) % bucketCount].push_back(i);
+
+            // Place the largest buckets first, they are the hardest to fit.
+            std::vector<std::size_t> order(bucketCount);
+            std::iota(std::begin(order), std::end(order), std::size_t{0});
+            std::stable_sort(std::begin(order), std::end(order), [&buckets](auto lhs, auto rhs) {
+                return buckets[lhs].size() > buckets[rhs].size();
+            });
+
+            displacements_.resize(bucketCount, 0);
+            std::vector<std::optional<std::size_t>> slots(slotCount);
+            std::vector<std::size_t> placed;
+            for (auto bucket : order)
+            {
+                if (buckets[bucket].empty())
+                    break;
+
+                std::uint64_t seed = 1;
+                for (; seed != maxSeed; ++seed)
+                {
+                    placed.clear();
+                    for (auto index : buckets[bucket])
+                    {
+                        const auto slot = hashRoute(entries[index].method, entries[index].path, seed) % slotCount;
+                        if (slots[slot] || std::find(std::begin(placed), std::end(placed), slot) != std::end(placed))
+                            break;
+                        placed.push_back(slot);
+                    }
+                    if (placed.size() == buckets[bucket].size())
+                        break;
+                }
+                if (seed == maxSeed)
+                    throw std::runtime_error{"Could not build perfect hash table for routes."};
+
+                displacements_[bucket] = seed;
+                for (std::size_t i = 0; i != placed.size(); ++i)
+                    slots[placed[i]] = buckets[bucket][i];
+            }
+
+            entries_.reserve(slotCount);
+            for (auto const& slot : slots)
+            {
+                if (slot)
+                    entries_.push_back(std::move(entries[*slot]));
+                else
+                    entries_.push_back(std::nullopt);
+            }
+        }
+
+        /**
+         * @brief Finds the value for the verb and path.
+         */
+        ValueT const* find(boost::beast::http::verb method, std::string_view path) const
+        {
+            if (displacements_.empty())
+                return nullptr;
+            const auto bucket = hashRoute(method, path, 0) % displacements_.size();
+            const auto slot = hashRoute(method, path, displacements_[bucket]) % entries_.size();
+            auto const& entry = entries_[slot];
+            if (!entry || entry->method != method || entry->path != path)
+                return nullptr;
+            return &entry->value;
+        }
+
+        std::size_t size() const
+        {
+            return static_cast<std::size_t>(std::count_if(std::begin(entries_), std::end(entries_), [](auto const& e) {
+                return e.has_value();
+            }));
+        }
+
+      private:
+        static std::vector<Entry> withoutDuplicates(std::vector<Entry> entries)
+        {
+            std::vector<Entry> unique;
+            unique.reserve(entries.size());
+            for (auto& entry : entries)
+            {
+                const auto duplicate = std::any_of(std::begin(unique), std::end(unique), [&entry](auto const& other) {
+                    return other.method == entry.method && other.path == entry.path;
+                });
+                if (!duplicate)
+                    unique.push_back(std::move(entry));
+            }
+            return unique;
+        }
+
+      private:
+        static constexpr std::uint64_t maxSeed = 1'000'000;
+        std::vector<std::uint64_t> displacements_{};
+        std::vector<std::optional<Entry>> entries_{};
+    };
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <roar/detail/file_io.hpp>
+#include <roar/detail/send_file.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/execution/outstanding_work.hpp>
+#include <boost/asio/prefer.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Roar::Detail
+{
+    /**
+     * @brief Writes file segments to a stream without touching the disk on the thread of the stream. Chunks are read
+     * on the file io executor into one of two buffers, while the other one is written (double buffering).
+     */
+    template <typename StreamT>
+    class PrefetchedFileWrite : public std::enable_shared_from_this<PrefetchedFileWrite<StreamT>>
+    {
+      public:
+        PrefetchedFileWrite(
+            StreamT& stream,
+            boost::asio::any_io_executor fileIoExecutor,
+            boost::beast::file& file,
+            std::vector<SendFileSegment> const& segments,
+            std::size_t chunkSize,
+            std::chrono::milliseconds idleTimeout,
+            std::function<void(boost::system::error_code, std::uint64_t)> onComplete)
+            : stream_{stream}
+            , fileIoExecutor_{std::move(fileIoExecutor)}
+            , file_{file}
+            , chunks_{makeChunks(segments, std::max(chunkSize, std::size_t{1}))}
+            , slots_{Slot{AlignedBuffer{largestChunk()}}, Slot{AlignedBuffer{largestChunk()}}}
+            , idleTimeout_{idleTimeout}
+            , onComplete_{std::move(onComplete)}
+        {}
+
+        void start()
+        {
+            pump();
+        }
+
+      private:
+        struct Chunk
+        {
+            std::string prefix;
+            std::uint64_t offset;
+            std::size_t length;
+        };
+
+        struct Slot
+        {
+            AlignedBuffer buffer;
+            bool ready = false;
+        };
+
+        static std::vector<Chunk> makeChunks(std::vector<SendFileSegment> const& segments, std::size_t chunkSize)
+        {
+            std::vector<Chunk> chunks;
+            for (auto const& segment : segments)
+            {
+                auto prefix = segment.prefix;
+                auto offset = segment.offset;
+                auto remaining = segment.length;
+                if (remaining == 0 && !prefix.empty())
+                    chunks.push_back({.prefix = std::move(prefix), .offset = offset, .length = 0});
+                while (remaining > 0)
+                {
+                    const auto length = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, chunkSize));
+                    chunks.push_back({.prefix = std::move(prefix), .offset = offset, .length = length});
+                    prefix.clear();
+                    offset += length;
+                    remaining -= length;
+                }
+            }
+            return chunks;
+        }
+
+        std::size_t largestChunk() const
+        {
+            std::size_t largest = 0;
+            for (auto const& chunk : chunks_)
+                largest = std::max(largest, chunk.length);
+            return largest;
+        }
+
+        /**
+         * @brief Starts whatever can be started: The write of the next chunk when it was read, and the read of
+         * the chunk after that, as soon as its buffer was written out.
+         */
+        void pump()
+        {
+            if (!onComplete_)
+                return;
+            if (ec_)
+            {
+                if (!reading_ && !writing_)
+                    complete();
+                return;
+            }
+            if (nextWrite_ == chunks_.size())
+                return complete();
+
+            bool progressed = true;
+            while (progressed)
+            {
+                progressed = false;
+                if (!writing_ && nextWrite_ < chunks_.size() && slots_[nextWrite_ % 2].ready)
+                {
+                    writeChunk();
+                    progressed = true;
+                }
+                if (!reading_ && nextRead_ < chunks_.size() && nextRead_ < nextWrite_ + 2)
+                {
+                    readChunk(nextRead_++);
+                    progressed = true;
+                }
+            }
+        }
+
+        void readChunk(std::size_t index)
+        {
+            if (chunks_[index].length == 0)
+            {
+                slots_[index % 2].ready = true;
+                return;
+            }
+
+            reading_ = true;
+            // Keeps the io context of the stream running while only the read is outstanding.
+            auto streamExecutor =
+                boost::asio::prefer(stream_.get_executor(), boost::asio::execution::outstanding_work.tracked);
+            boost::asio::post(
+                fileIoExecutor_,
+                [self = this->shared_from_this(), index, streamExecutor = std::move(streamExecutor)]() mutable {
+                    auto const& chunk = self->chunks_[index];
+                    auto* buffer = self->slots_[index % 2].buffer.data();
+                    boost::system::error_code ec;
+                    std::size_t total = 0;
+                    while (!ec && total < chunk.length)
+                    {
+                        const auto readCount =
+                            readAt(self->file_, chunk.offset + total, buffer + total, chunk.length - total, ec);
+                        if (!ec && readCount == 0)
+                            ec = boost::beast::http::error::short_read;
+                        total += readCount;
+                    }
+
+                    // The last reference must not be dropped on the file io thread.
+                    boost::asio::post(streamExecutor, [self = std::move(self), index, ec]() {
+                        self->onRead(index, ec);
+                    });
+                });
+        }
+
+        void onRead(std::size_t index, boost::system::error_code ec)
+        {
+            reading_ = false;
+            if (ec)
+                ec_ = ec;
+            else
+                slots_[index % 2].ready = true;
+            pump();
+        }
+
+        void writeChunk()
+        {
+            const auto index = nextWrite_;
+            auto& chunk = chunks_[index];
+            writing_ = true;
+            boost::beast::get_lowest_layer(stream_).expires_after(idleTimeout_);
+            const std::array<boost::asio::const_buffer, 2> buffers{
+                boost::asio::buffer(chunk.prefix),
+                boost::asio::buffer(slots_[index % 2].buffer.data(), chunk.length),
+            };
+            boost::asio::async_write(
+                stream_,
+                buffers,
+                [self = this->shared_from_this(), index](boost::system::error_code ec, std::size_t bytesTransferred) {
+                    self->writing_ = false;
+                    self->bytesWritten_ += bytesTransferred;
+                    if (ec)
+                        self->ec_ = ec;
+                    else
+                    {
+                        self->slots_[index % 2].ready = false;
+                        ++self->nextWrite_;
+                    }
+                    self->pump();
+                });
+        }
+
+        void complete()
+        {
+            auto onComplete = std::move(onComplete_);
+            onComplete_ = {};
+            onComplete(ec_, bytesWritten_);
+        }
+
+      private:
+        StreamT& stream_;
+        boost::asio::any_io_executor fileIoExecutor_;
+        boost::beast::file& file_;
+        std::vector<Chunk> chunks_;
+        std::array<Slot, 2> slots_;
+        std::chrono::milliseconds idleTimeout_;
+        std::function<void(boost::system::error_code, std::uint64_t)> onComplete_;
+        boost::system::error_code ec_{};
+        std::size_t nextRead_{0};
+        std::size_t nextWrite_{0};
+        bool reading_{false};
+        bool writing_{false};
+        std::uint64_t bytesWritten_{0};
+    };
+
+    /**
+     * @brief Writes the segments to the stream. The file ranges are read on the file io executor, so that slow disks
+     * do not block the thread of the stream, and the next chunk is read while the previous one is written.
+     *
+     * @param stream A plain or tls stream.
+     * @param fileIoExecutor The executor for blocking file reads. Usually a thread pool.
+     * @param file The file to read from. Must stay open until onComplete was called.
+     * @param segments The segments in sending order.
+     * @param chunkSize The size of each of the two buffers.
+     * @param idleTimeout Fails with beast::error::timeout if the client does not accept data for this long.
+     * @param onComplete Called with the error and the amount of bytes written.
+     */
+    template <typename StreamT>
+    void asyncWritePrefetched(
+        StreamT& stream,
+        boost::asio::any_io_executor fileIoExecutor,
+        boost::beast::file& file,
+        std::vector<SendFileSegment> const& segments,
+        std::size_t chunkSize,
+        std::chrono::milliseconds idleTimeout,
+        std::function<void(boost::system::error_code, std::uint64_t)> onComplete)
+    {
+        std::make_shared<PrefetchedFileWrite<StreamT>>(
+            stream, std::move(fileIoExecutor), file, segments, chunkSize, idleTimeout, std::move(onComplete))
+            ->start();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <roar/detail/stream_type.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Roar::Detail
+{
+#ifdef __linux__
+    constexpr static bool sendFileSupported = true;
+#else
+    constexpr static bool sendFileSupported = false;
+#endif
+
+    /**
+     * @brief A piece of a response body: Some text that is written as is, followed by a range of a file.
+     */
+    struct SendFileSegment
+    {
+        std::string prefix;
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    /**
+     * @brief Writes the segments to the stream. The prefixes are written through the stream, the file ranges are
+     * moved by the kernel with sendfile(2) and never touch a userspace buffer.
+     *
+     * @param stream A plain tcp stream.
+     * @param fileDescriptor The file to send from. Must stay open until onComplete was called.
+     * @param segments The segments in sending order.
+     * @param idleTimeout Fails with beast::error::timeout if the client does not accept data for this long.
+     * @param onComplete Called with the error and the amount of bytes written.
+     */
+    void asyncSendFile(
+        StreamType& stream,
+        int fileDescriptor,
+        std::vector<SendFileSegment> segments,
+        std::chrono::milliseconds idleTimeout,
+        std::function<void(boost::system::error_code, std::uint64_t)> onComplete);
+}
@@ -4,14 +4,21 @@
 #include <roar/detail/bytes_to_human_readable.hpp>
 #include <roar/filesystem/special_paths.hpp>
 #include <roar/mime_type.hpp>
+#include <roar/mechanics/entity_tag.hpp>
+#include <roar/mechanics/content_encoding.hpp>
+#include <roar/utility/date.hpp>
 #include <roar/filesystem/jail.hpp>
 #include <roar/routing/request_listener.hpp>
 #include <roar/session/session.hpp>
 
 #include <boost/beast/http/file_body.hpp>
 
+#include <algorithm>
+#include <array>
 #include <ctime>
 #include <utility>
+#include <string_view>
+#include <vector>
 #include <filesystem>
 #include <sstream>
 #include <chrono>
@@ -20,17 +27,20 @@ namespace Roar::Detail
 {
     namespace
     {
-        inline static std::string to_string(std::filesystem::file_time_type const& ftime)
+        inline static std::chrono::system_clock::time_point toSystemTime(std::filesystem::file_time_type const& ftime)
         {
 #ifdef _MSC_VER
-            auto cftime =
-                std::chrono::system_clock::to_time_t(std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    std::chrono::utc_clock::to_sys(std::chrono::file_clock::to_utc(ftime))));
+            return std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                std::chrono::utc_clock::to_sys(std::chrono::file_clock::to_utc(ftime)));
 #else
-            auto cftime =
-                std::chrono::system_clock::to_time_t(std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    std::chrono::file_clock::to_sys(ftime)));
+            return std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                std::chrono::file_clock::to_sys(ftime));
 #endif
+        }
+
+        inline static std::string to_string(std::filesystem::file_time_type const& ftime)
+        {
+            auto cftime = std::chrono::system_clock::to_time_t(toSystemTime(ftime));
             std::string result(1024, '\0');
 #ifdef _MSC_VER
 #    pragma clang diagnostic push
@@ -72,6 +82,10 @@ namespace Roar::Detail
             , onFileServeComplete_{unwrapFlexibleProvider<RequestListenerT, std::function<void(bool)>>(
                   *this->listener_,
                   this->serveInfo_.serveOptions.onFileServeComplete)}
+            , fileCache_{
+                  this->serveInfo_.serveOptions.fileCache
+                      ? std::make_shared<FileCache>(*this->serveInfo_.serveOptions.fileCache)
+                      : nullptr}
         {
             if (!onError_)
                 onError_ = [](std::string const&) {};
@@ -79,7 +93,7 @@ namespace Roar::Detail
                 onFileServeComplete_ = [](bool) {};
         }
 
-        void operator()(Session& session, EmptyBodyRequest const& req)
+        void operator()(Session& session, EmptyBodyRequest const& req) const
         {
             namespace http = boost::beast::http;
 
@@ -87,11 +101,14 @@ namespace Roar::Detail
             if (this->serverIsSecure_ && !session.isSecure() && !this->serveInfo_.routeOptions.allowUnsecure)
                 return session.sendStrictTransportSecurityResponse();
 
-            const auto fileAndStatus = getFileAndStatus(req.path());
+            const auto file = getFile(req.pathView());
+            auto const& fileAndStatus = file->fileAndStatus;
+
+            // The handler may change the options for this request only.
+            auto serveOptions = this->serveInfo_.serveOptions;
 
             // File is found, now ask the library user for permissions:
-            switch (std::invoke(
-                this->serveInfo_.handler, *this->listener_, session, req, fileAndStatus, this->serveInfo_.serveOptions))
+            switch (std::invoke(this->serveInfo_.handler, *this->listener_, session, req, fileAndStatus, serveOptions))
             {
                 case (ServeDecision::Continue):
                     break;
@@ -106,33 +123,29 @@ namespace Roar::Detail
             {
                 case (http::verb::head):
                 {
-                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(
-                            *this->listener_, this->serveInfo_.serveOptions.allowDownload))
+                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowDownload))
                         return session.sendStandardResponse(http::status::method_not_allowed);
-                    return sendHeadResponse(session, req, fileAndStatus);
+                    return sendHeadResponse(session, req, file, serveOptions);
                 }
                 case (http::verb::options):
                 {
-                    return sendOptionsResponse(session, req, fileAndStatus);
+                    return sendOptionsResponse(session, req, serveOptions);
                 }
                 case (http::verb::get):
                 {
-                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(
-                            *this->listener_, this->serveInfo_.serveOptions.allowDownload))
+                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowDownload))
                         return session.sendStandardResponse(http::status::method_not_allowed);
                     break;
                 }
                 case (http::verb::delete_):
                 {
-                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(
-                            *this->listener_, this->serveInfo_.serveOptions.allowDelete))
+                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowDelete))
                         return session.sendStandardResponse(http::status::method_not_allowed);
                     break;
                 }
                 case (http::verb::put):
                 {
-                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(
-                            *this->listener_, this->serveInfo_.serveOptions.allowUpload))
+                    if (!unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowUpload))
                         return session.sendStandardResponse(http::status::method_not_allowed);
                     break;
                 }
@@ -146,7 +159,7 @@ namespace Roar::Detail
             if (fileAndStatus.status.type() == std::filesystem::file_type::none && req.method() != http::verb::put)
                 return session.sendStandardResponse(http::status::not_found);
 
-            handleFileServe(session, req, fileAndStatus);
+            handleFileServe(session, req, file, serveOptions);
         }
 
       private:
@@ -166,50 +179,58 @@ namespace Roar::Detail
             return *style;
         }
 
-        FileAndStatus getFileAndStatus(boost::beast::string_view target) const
+        /**
+         * @brief Resolves the request target within the jail and looks up the file, through the cache if enabled.
+         */
+        std::shared_ptr<CachedFile const> getFile(std::string_view target) const
         {
-            auto analyzeFile = [this](boost::beast::string_view target) -> FileAndStatus {
+            if (target.size() == basePath_.size())
+                target = "";
+            else
+                target.remove_prefix(basePath_.size() + (basePath_.size() == 1 ? 0 : 1));
+
+            auto analyzeFile = [this, target]() -> CachedFile {
                 const auto absolute = jail_.pathAsIsInJail(std::filesystem::path{std::string{target}});
                 if (absolute)
                 {
                     const auto relative = jail_.relativeToRoot(std::filesystem::path{std::string{target}});
-                    if (std::filesystem::exists(*absolute))
-                        return {.file = *absolute, .relative = *relative, .status = std::filesystem::status(*absolute)};
-                    else
-                        return {.file = *absolute, .relative = *relative, .status = std::filesystem::file_status{}};
+                    return describeFile(*absolute, *relative);
                 }
                 return {};
             };
 
-            std::pair<std::filesystem::file_type, std::filesystem::path> fileAndStatus;
-            if (target.size() == basePath_.size())
-                return analyzeFile("");
-            target.remove_prefix(basePath_.size() + (basePath_.size() == 1 ? 0 : 1));
-            return analyzeFile(target);
+            if (!fileCache_)
+                return std::make_shared<CachedFile const>(analyzeFile());
+            return fileCache_->get(std::string{target}, analyzeFile);
         }
 
-        void handleFileServe(Session& session, EmptyBodyRequest const& req, FileAndStatus const& fileAndStatus) const
+        void handleFileServe(
+            Session& session,
+            EmptyBodyRequest const& req,
+            std::shared_ptr<CachedFile const> const& file,
+            ServeOptions<RequestListenerT> const& serveOptions) const
         {
             namespace http = boost::beast::http;
+            auto const& fileAndStatus = file->fileAndStatus;
             switch (req.method())
             {
                 case (http::verb::get):
                 {
                     if (fileAndStatus.status.type() == std::filesystem::file_type::directory)
                     {
-                        if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                                *this->listener_, this->serveInfo_.serveOptions.allowListing))
+                        if (unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowListing))
                             return makeListing(session, req, fileAndStatus);
                         else
                         {
                             return download(
                                 session,
                                 req,
-                                getFileAndStatus((basePath_ / fileAndStatus.relative / "index.html").string()));
+                                getFile((basePath_ / fileAndStatus.relative / "index.html").string()),
+                                serveOptions);
                         }
                     }
                     else
-                        return download(session, req, fileAndStatus);
+                        return download(session, req, file, serveOptions);
                 }
                 case (http::verb::delete_):
                 {
@@ -222,7 +243,7 @@ namespace Roar::Detail
                     else if (fileAndStatus.status.type() == std::filesystem::file_type::directory)
                     {
                         if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                                *this->listener_, this->serveInfo_.serveOptions.allowDeleteOfNonEmptyDirectories))
+                                *this->listener_, serveOptions.allowDeleteOfNonEmptyDirectories))
                             std::filesystem::remove_all(fileAndStatus.file, ec);
                         else
                         {
@@ -237,6 +258,10 @@ namespace Roar::Detail
                         ec = std::make_error_code(std::errc::operation_not_supported);
                     }
 
+                    // After the removal, so that lookups that raced it are not cached.
+                    if (fileCache_)
+                        fileCache_->clear();
+
                     if (ec)
                         return session.sendStandardResponse(http::status::bad_request, ec.message());
                     else
@@ -244,7 +269,7 @@ namespace Roar::Detail
                 }
                 case (http::verb::put):
                 {
-                    return upload(session, req, fileAndStatus);
+                    return upload(session, req, fileAndStatus, serveOptions);
                 }
                 // Cannot happen:
                 default:
@@ -252,38 +277,161 @@ namespace Roar::Detail
             }
         }
 
-        void sendHeadResponse(Session& session, EmptyBodyRequest const& req, FileAndStatus const& fileAndStatus) const
+        /**
+         * @brief Evaluates If-None-Match, or If-Modified-Since in its absence (RFC 9110 Section 13.2.2).
+         */
+        bool isNotModified(EmptyBodyRequest const& req, CachedFile const& file) const
         {
             namespace http = boost::beast::http;
-            const auto contentType = extensionToMime(fileAndStatus.file.extension().string());
+            if (file.etag.empty())
+                return false;
+
+            if (const auto ifNoneMatch = req.find(http::field::if_none_match); ifNoneMatch != std::end(req))
+                return entityTagListMatches({ifNoneMatch->value().data(), ifNoneMatch->value().size()}, file.etag);
+
+            if (const auto ifModifiedSince = req.find(http::field::if_modified_since); ifModifiedSince != std::end(req))
+            {
+                auto since = date::fromGmtString(std::string{ifModifiedSince->value()});
+                return since && std::chrono::floor<std::chrono::seconds>(toSystemTime(file.lastWriteTime)) <=
+                    since->getTimePoint();
+            }
+            return false;
+        }
 
-            if (fileAndStatus.status.type() != std::filesystem::file_type::regular &&
-                fileAndStatus.status.type() != std::filesystem::file_type::symlink)
+        /**
+         * @brief What is actually sent for a requested file.
+         */
+        struct Representation
+        {
+            /// The requested file or a precompressed sidecar of it.
+            std::shared_ptr<CachedFile const> file;
+
+            /// The mime type of the requested file.
+            std::optional<std::string> contentType;
+
+            /// The encoding of a sidecar, empty for the requested file.
+            std::string contentEncoding;
+
+            /// Whether the choice depends on the Accept-Encoding header.
+            bool variesByEncoding;
+        };
+
+        /**
+         * @brief Picks the precompressed sidecar (file.br, file.zst, file.gz) that the client prefers, if serving them
+         * is enabled. Range requests then operate on the encoded file.
+         */
+        Representation selectRepresentation(
+            EmptyBodyRequest const& req,
+            std::shared_ptr<CachedFile const> const& file,
+            ServeOptions<RequestListenerT> const& serveOptions) const
+        {
+            namespace http = boost::beast::http;
+            Representation representation{
+                .file = file,
+                .contentType = file->contentType,
+                .contentEncoding = {},
+                .variesByEncoding =
+                    unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.servePrecompressed),
+            };
+            const auto acceptEncoding = req.find(http::field::accept_encoding);
+            if (!representation.variesByEncoding || acceptEncoding == std::end(req))
+                return representation;
+
+            const auto target = (basePath_ / file->fileAndStatus.relative).string();
+            std::vector<std::string_view> offered;
+            std::vector<std::shared_ptr<CachedFile const>> sidecars;
+            for (auto const& [encoding, extension] : precompressedExtensions)
+            {
+                auto sidecar = getFile(target + std::string{extension});
+                if (sidecar->fileAndStatus.status.type() != std::filesystem::file_type::regular)
+                    continue;
+                offered.push_back(encoding);
+                sidecars.push_back(std::move(sidecar));
+            }
+
+            const auto encoding = negotiateContentEncoding(
+                {acceptEncoding->value().data(), acceptEncoding->value().size()}, offered);
+            if (!encoding)
+                return representation;
+            const auto index = std::find(std::begin(offered), std::end(offered), *encoding) - std::begin(offered);
+            representation.file = sidecars[static_cast<std::size_t>(index)];
+            representation.contentEncoding = std::string{*encoding};
+            return representation;
+        }
+
+        /**
+         * @brief Sets ETag and Last-Modified, so that clients can revalidate with conditional requests, and the
+         * encoding headers of precompressed files.
+         */
+        template <typename BodyT>
+        static void
+        setRepresentationHeaders(Session::SendIntermediate<BodyT>& intermediate, Representation const& representation)
+        {
+            namespace http = boost::beast::http;
+            if (!representation.contentEncoding.empty())
+                intermediate.setHeader(http::field::content_encoding, representation.contentEncoding);
+            if (representation.variesByEncoding)
+                intermediate.modifyResponse([](auto& response) {
+                    response.addVary("Accept-Encoding");
+                });
+
+            auto const& file = *representation.file;
+            if (file.etag.empty())
+                return;
+            intermediate.setHeader(http::field::etag, file.etag);
+            intermediate.setHeader(http::field::last_modified, date{toSystemTime(file.lastWriteTime)}.toGmtString());
+        }
+
+        void sendNotModified(Session& session, EmptyBodyRequest const& req, Representation const& representation) const
+        {
+            namespace http = boost::beast::http;
+            auto intermediate = session.send<http::empty_body>(req);
+            intermediate->status(http::status::not_modified);
+            setRepresentationHeaders(*intermediate, representation);
+            intermediate->commit().fail([onError = onError_](auto&& err) {
+                onError(err.toString());
+            });
+        }
+
+        void sendHeadResponse(
+            Session& session,
+            EmptyBodyRequest const& req,
+            std::shared_ptr<CachedFile const> const& file,
+            ServeOptions<RequestListenerT> const& serveOptions) const
+        {
+            namespace http = boost::beast::http;
+            if (file->fileAndStatus.status.type() != std::filesystem::file_type::regular &&
+                file->fileAndStatus.status.type() != std::filesystem::file_type::symlink)
                 return session.sendStandardResponse(http::status::not_found);
 
-            session.send<http::empty_body>(req)
-                ->status(http::status::ok)
+            const auto representation = selectRepresentation(req, file, serveOptions);
+            if (isNotModified(req, *representation.file))
+                return sendNotModified(session, req, representation);
+
+            auto intermediate = session.send<http::empty_body>(req);
+            setRepresentationHeaders(*intermediate, representation);
+            intermediate->status(http::status::ok)
                 .setHeader(http::field::accept_ranges, "bytes")
-                .setHeader(http::field::content_length, std::to_string(std::filesystem::file_size(fileAndStatus.file)))
-                .contentType(contentType ? *contentType : "application/octet-stream")
+                .setHeader(http::field::content_length, std::to_string(representation.file->size))
+                .contentType(representation.contentType ? *representation.contentType : "application/octet-stream")
                 .commit()
                 .fail([onError = onError_](auto&& err) {
                     onError(err.toString());
                 });
         }
 
-        void sendOptionsResponse(Session& session, EmptyBodyRequest const& req, FileAndStatus const&) const
+        void sendOptionsResponse(
+            Session& session,
+            EmptyBodyRequest const& req,
+            ServeOptions<RequestListenerT> const& serveOptions) const
         {
             namespace http = boost::beast::http;
             std::string allow = "OPTIONS";
-            if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                    *this->listener_, this->serveInfo_.serveOptions.allowDownload))
+            if (unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowDownload))
                 allow += ", GET, HEAD";
-            if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                    *this->listener_, this->serveInfo_.serveOptions.allowUpload))
+            if (unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowUpload))
                 allow += ", PUT";
-            if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                    *this->listener_, this->serveInfo_.serveOptions.allowDelete))
+            if (unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowDelete))
                 allow += ", DELETE";
 
             session.send<http::empty_body>(req)
@@ -382,7 +530,11 @@ namespace Roar::Detail
                 .commit();
         }
 
-        void upload(Session& session, EmptyBodyRequest const& req, FileAndStatus const& fileAndStatus) const
+        void upload(
+            Session& session,
+            EmptyBodyRequest const& req,
+            FileAndStatus const& fileAndStatus,
+            ServeOptions<RequestListenerT> const& serveOptions) const
         {
             namespace http = boost::beast::http;
             if (!req.expectsContinue())
@@ -402,8 +554,7 @@ namespace Roar::Detail
                     break;
                 case (std::filesystem::file_type::regular):
                 {
-                    if (unwrapFlexibleProvider<RequestListenerT, bool>(
-                            *this->listener_, this->serveInfo_.serveOptions.allowOverwrite))
+                    if (unwrapFlexibleProvider<RequestListenerT, bool>(*this->listener_, serveOptions.allowOverwrite))
                         break;
                 }
                 default:
@@ -416,9 +567,16 @@ namespace Roar::Detail
             if (!contentLength)
                 return session.sendStandardResponse(http::status::bad_request, "Require Content-Length.");
 
+            // Lookups during the upload may cache the partial file, so the cache is cleared once it is written.
+            auto invalidateCache = [fileCache = fileCache_]() {
+                if (fileCache)
+                    fileCache->clear();
+            };
+
             auto body = std::make_shared<http::file_body::value_type>();
             boost::beast::error_code ec;
             body->open(fileAndStatus.file.string().c_str(), boost::beast::file_mode::write, ec);
+            invalidateCache();
             if (ec)
                 return session.sendStandardResponse(
                     http::status::internal_server_error, "Cannot open file for writing.");
@@ -430,30 +588,44 @@ namespace Roar::Detail
                        req,
                        body = std::move(body),
                        contentLength,
-                       onError = onError_](bool closed) {
+                       onError = onError_,
+                       invalidateCache](bool closed) {
                     if (closed)
-                        return;
+                        return invalidateCache();
 
                     session->read<http::file_body>(req, std::move(*body))
                         ->bodyLimit(*contentLength)
                         .commit()
-                        .then([](auto& session, auto const&) {
+                        .then([invalidateCache](auto& session, auto const&) {
+                            invalidateCache();
                             session.sendStandardResponse(http::status::ok);
                         })
-                        .fail([session, onError](Error const& e) {
+                        .fail([session, onError, invalidateCache](Error const& e) {
+                            invalidateCache();
                             onError(e.toString());
                             session->sendStandardResponse(http::status::internal_server_error, e.toString());
                         });
                 });
         }
 
-        void download(Session& session, EmptyBodyRequest const& req, FileAndStatus const& fileAndStatus) const
+        void download(
+            Session& session,
+            EmptyBodyRequest const& req,
+            std::shared_ptr<CachedFile const> const& requested,
+            ServeOptions<RequestListenerT> const& serveOptions) const
         {
             namespace http = boost::beast::http;
-            if (fileAndStatus.status.type() != std::filesystem::file_type::regular &&
-                fileAndStatus.status.type() != std::filesystem::file_type::symlink)
+            if (requested->fileAndStatus.status.type() != std::filesystem::file_type::regular &&
+                requested->fileAndStatus.status.type() != std::filesystem::file_type::symlink)
                 return session.sendStandardResponse(http::status::not_found);
 
+            const auto representation = selectRepresentation(req, requested, serveOptions);
+            auto const& fileAndStatus = representation.file->fileAndStatus;
+
+            // Answered without opening the file.
+            if (isNotModified(req, *representation.file))
+                return sendNotModified(session, req, representation);
+
             const auto ranges = req.ranges();
             if (!ranges)
             {
@@ -464,11 +636,12 @@ namespace Roar::Detail
                     return session.sendStandardResponse(
                         http::status::internal_server_error, "Cannot open file for reading.");
 
-                auto contentType = extensionToMime(fileAndStatus.file.extension().string());
                 auto intermediate = session.send<http::file_body>(req, std::move(body));
                 intermediate->preparePayload();
                 intermediate->enableCors(req, this->serveInfo_.routeOptions.cors);
-                intermediate->contentType(contentType ? contentType.value() : "application/octet-stream");
+                intermediate->contentType(
+                    representation.contentType ? representation.contentType.value() : "application/octet-stream");
+                setRepresentationHeaders(*intermediate, representation);
                 intermediate->commit()
                     .then([session = session.shared_from_this(), req, onFileServeComplete = onFileServeComplete_](
                               bool wasClosed) {
@@ -490,8 +663,9 @@ namespace Roar::Detail
                 {
                     body.setReadRanges(*ranges, "plain/text");
 
-                    session.send<RangeFileBody>(req, std::move(body))
-                        ->useFixedTimeout(std::chrono::seconds{10})
+                    auto intermediate = session.send<RangeFileBody>(req, std::move(body));
+                    setRepresentationHeaders(*intermediate, representation);
+                    intermediate->useFixedTimeout(std::chrono::seconds{10})
                         .commit()
                         .then([session = session.shared_from_this(), req, onFileServeComplete = onFileServeComplete_](
                                   bool wasClosed) {
@@ -513,5 +687,12 @@ namespace Roar::Detail
         std::string basePath_;
         std::function<void(std::string const&)> onError_;
         std::function<void(bool)> onFileServeComplete_;
+        std::shared_ptr<FileCache> fileCache_;
+
+        constexpr static std::array<std::pair<std::string_view, std::string_view>, 3> precompressedExtensions{{
+            {"br", ".br"},
+            {"zstd", ".zst"},
+            {"gzip", ".gz"},
+        }};
     };
 }
\ No newline at end of file
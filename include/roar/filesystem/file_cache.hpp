@@ -0,0 +1,97 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace Roar
+{
+    struct FileAndStatus
+    {
+        std::filesystem::path file{};
+        std::filesystem::path relative{};
+        std::filesystem::file_status status{};
+    };
+
+    /**
+     * @brief Everything a directory server needs to know about a file before opening it.
+     */
+    struct CachedFile
+    {
+        FileAndStatus fileAndStatus{};
+
+        /// Size of regular files, 0 otherwise.
+        std::uint64_t size = 0;
+
+        std::filesystem::file_time_type lastWriteTime{};
+
+        /// The mime type derived from the extension.
+        std::optional<std::string> contentType = std::nullopt;
+
+        /// Strong validator derived from inode, modification time and size. Empty for anything but regular files.
+        std::string etag{};
+    };
+
+    /**
+     * @brief Looks up the status, size, modification time, mime type and etag of a file.
+     *
+     * @param file The absolute path of the file.
+     * @param relative The path relative to the served directory.
+     * @return CachedFile The status type is file_type::none if the file does not exist.
+     */
+    CachedFile describeFile(std::filesystem::path file, std::filesystem::path relative);
+
+    struct FileCacheOptions
+    {
+        /// Maximum number of cached files. The least recently used entry is evicted first.
+        std::size_t capacity = 1024;
+
+        /// Entries are looked up again after this time, so changes to the directory become visible after at most this
+        /// long. Uploads and deletes through the directory server invalidate immediately.
+        std::chrono::milliseconds timeToLive = std::chrono::seconds{2};
+    };
+
+    /**
+     * @brief A thread safe LRU cache of file lookups, shared by all requests to a served directory.
+     */
+    class FileCache
+    {
+      public:
+        FileCache(FileCacheOptions options = {});
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(FileCache);
+
+        /**
+         * @brief Returns the cached entry for the key or creates it with lookup. Lookups run without holding the lock.
+         * If the cache is invalidated or cleared during the lookup, the result is returned but not cached.
+         *
+         * @param key The request path relative to the served directory.
+         * @param lookup Called on a miss or when the entry expired.
+         */
+        std::shared_ptr<CachedFile const> get(std::string const& key, std::function<CachedFile()> const& lookup);
+
+        /**
+         * @brief Removes a single entry.
+         */
+        void invalidate(std::string const& key);
+
+        /**
+         * @brief Removes all entries.
+         */
+        void clear();
+
+        /**
+         * @brief Returns the amount of cached entries.
+         */
+        std::size_t size() const;
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
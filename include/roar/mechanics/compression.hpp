@@ -0,0 +1,140 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Roar
+{
+    /**
+     * @brief Content codings that can be produced on the fly.
+     */
+    enum class ContentCoding
+    {
+        Identity,
+        Gzip,
+        Deflate,
+        Brotli
+    };
+
+    /**
+     * @brief Returns the token of the coding as used in Content-Encoding headers.
+     */
+    std::string_view contentCodingName(ContentCoding coding);
+
+    /**
+     * @brief Parses the value of a Content-Encoding header.
+     *
+     * @return std::optional<ContentCoding> Nothing for unknown codings and for more than one coding.
+     */
+    std::optional<ContentCoding> parseContentCoding(std::string_view contentEncoding);
+
+    /**
+     * @brief Returns the codings that can be produced, in order of preference.
+     */
+    std::vector<ContentCoding> const& supportedContentCodings();
+
+    /**
+     * @brief Route options for compressing responses on the fly.
+     */
+    struct CompressionOptions
+    {
+        /// Responses with a known size below this amount of bytes are not compressed.
+        std::size_t minimumSize = 1024;
+
+        /// Only responses whose content type starts with one of these are compressed. Parameters are ignored.
+        std::vector<std::string> contentTypes = {
+            "text/",
+            "application/json",
+            "application/javascript",
+            "application/xml",
+            "image/svg+xml",
+        };
+
+        /// The compression level, -1 selects a default for each coding. Is clamped to the range of the coding.
+        int level = -1;
+    };
+
+    /**
+     * @brief Decides whether and how a response is compressed.
+     *
+     * @param options The compression options of the route.
+     * @param acceptEncoding The Accept-Encoding header of the request.
+     * @param contentType The Content-Type of the response.
+     * @param size The size of the response body, if known.
+     * @return ContentCoding Identity if the response should be sent as is.
+     */
+    ContentCoding selectCompression(
+        CompressionOptions const& options,
+        std::string_view acceptEncoding,
+        std::string_view contentType,
+        std::optional<std::uint64_t> size);
+
+    /**
+     * @brief Compresses a stream piece by piece, holding only the state of the coding.
+     */
+    class StreamCompressor
+    {
+      public:
+        /**
+         * @brief Creates a compressor. Throws if the coding cannot be initialized.
+         *
+         * @param coding Gzip, Deflate or Brotli.
+         * @param level See CompressionOptions::level.
+         */
+        StreamCompressor(ContentCoding coding, int level = -1);
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(StreamCompressor);
+
+        /**
+         * @brief Compresses input and appends whatever the coding emits to output.
+         *
+         * @param input The next piece of the stream.
+         * @param finish Set on the last call to flush the coding and end the stream.
+         * @param output Compressed bytes are appended here.
+         * @return false on an error of the coding.
+         */
+        bool compress(std::string_view input, bool finish, std::string& output);
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+
+    /**
+     * @brief Decompresses a stream piece by piece, with a bound on the output of each step.
+     */
+    class StreamDecompressor
+    {
+      public:
+        /**
+         * @brief Creates a decompressor. Throws if the coding cannot be initialized.
+         *
+         * @param coding Gzip, Deflate or Brotli.
+         */
+        StreamDecompressor(ContentCoding coding);
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(StreamDecompressor);
+
+        /**
+         * @brief Decompresses from the front of input until input is used up or maxOutput bytes were appended to
+         * output. Consumed bytes are removed from input.
+         *
+         * @return false if the data is corrupt or continues after the end of the stream.
+         */
+        bool decompress(std::string_view& input, std::string& output, std::size_t maxOutput);
+
+        /**
+         * @brief Whether the end of the compressed stream was reached.
+         */
+        bool finished() const;
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
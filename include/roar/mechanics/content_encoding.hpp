@@ -0,0 +1,19 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Roar
+{
+    /**
+     * @brief Selects a content coding from an Accept-Encoding header (RFC 9110 Section 12.5.3).
+     *
+     * @param acceptEncoding The value of the Accept-Encoding header.
+     * @param offered The codings the server can produce, in order of server preference. Used to break ties
+     * between equal q-values.
+     * @return std::optional<std::string_view> One of offered, or nothing if the client accepts none of them.
+     */
+    std::optional<std::string_view>
+    negotiateContentEncoding(std::string_view acceptEncoding, std::vector<std::string_view> const& offered);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+namespace Roar
+{
+    /**
+     * @brief Compares an entity tag against a list of entity tags, as sent in If-None-Match headers. Uses the weak
+     * comparison of RFC 9110 Section 8.8.3.2, so W/"x" and "x" match. "*" matches any entity tag.
+     *
+     * @param entityTagList A comma separated list of entity tags, or "*".
+     * @param entityTag The entity tag of the current representation, including quotes.
+     */
+    bool entityTagListMatches(std::string_view entityTagList, std::string_view entityTag);
+}
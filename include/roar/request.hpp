@@ -7,6 +7,9 @@
 #include <roar/authorization/authorization.hpp>
 #include <roar/mechanics/ranges.hpp>
 #include <roar/utility/base64.hpp>
+#include <roar/routing/path_template.hpp>
+#include <roar/url/encode.hpp>
+#include <roar/url/query.hpp>
 
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/empty_body.hpp>
@@ -21,8 +24,11 @@
 #    include <nlohmann/json.hpp>
 #endif
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <deque>
@@ -31,11 +37,23 @@ namespace Roar
 {
     namespace Detail
     {
+        /**
+         * @brief Positions (offset, length) of regex captures within the request target.
+         */
+        using PathMatchRanges = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+        /**
+         * @brief State of a request that is not part of the beast message. Path, query and matches are not copied
+         * out of the target, they are views or positions into it, so this costs no allocation for routed requests.
+         */
         struct RequestExtensions
         {
-            std::optional<std::vector<std::string>> regexMatches_{std::nullopt};
-            std::string path_{};
-            std::unordered_map<std::string, std::string> query_{};
+            std::optional<PathMatchRanges> regexMatches_{std::nullopt};
+            // Owning copies of the matches, only made when pathMatches() is called.
+            mutable std::optional<std::vector<std::string>> regexMatchStrings_{std::nullopt};
+            // Owning copy of the query, only made when query() is called.
+            mutable std::optional<std::unordered_map<std::string, std::string>> query_{std::nullopt};
+            PathCaptures pathCaptures_{};
             std::string host_{};
             std::string port_{};
         };
@@ -68,9 +86,7 @@ namespace Roar
         explicit Request(beast_request req)
             : boost::beast::http::request<BodyT>{std::move(req)}
             , Detail::RequestExtensions{}
-        {
-            parseTarget();
-        }
+        {}
 
         /**
          * @brief Construct a new Request object from a beast request and takes extensions of a previous request object.
@@ -80,24 +96,46 @@ namespace Roar
         explicit Request(beast_request req, Detail::RequestExtensions&& extensions)
             : boost::beast::http::request<BodyT>{std::move(req)}
             , Detail::RequestExtensions{std::move(extensions)}
+        {}
+
+        /**
+         * @brief Returns only the path of the url. The path is not percent decoded.
+         *
+         * @return std::string A copy of the path. See pathView for a view without a copy.
+         */
+        std::string path() const
         {
-            parseTarget();
+            return std::string{pathView()};
         }
 
         /**
-         * @brief Returns only the path of the url.
+         * @brief Returns only the path of the url. The path is not percent decoded.
          *
-         * @return auto const& The path.
+         * @return std::string_view The path, pointing into the request target.
          */
-        std::string path() const
+        std::string_view pathView() const
         {
-            return path_;
+            const auto target = this->target();
+            return target.substr(0, target.find('?'));
+        }
+
+        /**
+         * @brief Returns the percent decoded path. Only paths that contain escapes are decoded.
+         *
+         * @return std::string The decoded path.
+         */
+        std::string decodedPath() const
+        {
+            const auto path = pathView();
+            if (path.find('%') == std::string_view::npos)
+                return std::string{path};
+            return urlDecode(path);
         }
 
         void target(std::string_view target)
         {
             static_cast<beast_request*>(this)->target(boost::string_view{target.data(), target.size()});
-            parseTarget();
+            query_.reset();
         }
         std::string_view target() const
         {
@@ -129,7 +167,7 @@ namespace Roar
             this->set(boost::beast::http::field::host, host_);
             return *this;
         }
-        std::string host() const
+        std::string const& host() const
         {
             return host_;
         }
@@ -159,7 +197,7 @@ namespace Roar
             port_ = std::string{port};
             return *this;
         }
-        std::string port() const
+        std::string const& port() const
         {
             return port_;
         }
@@ -171,33 +209,145 @@ namespace Roar
         }
 
         /**
-         * @brief Returns the query part of the url as an unordered_map<string, string>.
+         * @brief Returns the query part of the url without the leading '?'. Is not percent decoded.
+         *
+         * @return std::string_view The query, pointing into the request target.
+         */
+        std::string_view queryString() const
+        {
+            const auto target = this->target();
+            const auto queryPos = target.find('?');
+            if (queryPos == std::string_view::npos)
+                return {};
+            return target.substr(queryPos + 1);
+        }
+
+        /**
+         * @brief Returns the query part of the url as a map. Keys and values are not percent decoded, if a key is
+         * repeated the last value wins. The map is built on the first call. See queryView for decoding, repeated
+         * keys and no copies.
          *
-         * @return auto const& The query part.
+         * @return std::unordered_map<std::string, std::string> const& The query part.
          */
-        auto const& query() const
+        std::unordered_map<std::string, std::string> const& query() const
         {
-            return query_;
+            if (!query_)
+            {
+                auto& query = query_.emplace();
+                for (auto const& parameter : queryView())
+                    query[std::string{parameter.key}] = std::string{parameter.value};
+            }
+            return *query_;
         }
 
         /**
-         * @brief Retrieves regex matches for this request with the registered route.
+         * @brief Splits the query part of the url into parameters. The query is only parsed when this is called,
+         * values are percent decoded when they are retrieved: req.queryView().get<int>("page").
          *
-         * @return auto const& matches[0] = full match, matches[1] = first capture group, ...
+         * @return QueryView A view pointing into the request target.
          */
-        auto const& pathMatches() const
+        QueryView queryView() const
         {
-            return regexMatches_;
+            return QueryView{queryString()};
+        }
+
+        /**
+         * @brief Retrieves regex matches for this request with the registered route. The matches are copied out of
+         * the target on the first call, pathMatchAt returns a single match without a copy.
+         *
+         * @return std::optional<std::vector<std::string>> const& matches[0] = first capture group, ...
+         */
+        std::optional<std::vector<std::string>> const& pathMatches() const
+        {
+            if (regexMatches_ && !regexMatchStrings_)
+            {
+                auto& matches = regexMatchStrings_.emplace();
+                matches.reserve(regexMatches_->size());
+                for (std::size_t i = 0; i != regexMatches_->size(); ++i)
+                    matches.emplace_back(pathMatchAt(i));
+            }
+            return regexMatchStrings_;
+        }
+
+        /**
+         * @brief Retrieves a single regex match without building a list.
+         *
+         * @param index The index of the capture group, must be less than pathMatchCount().
+         * @return std::string_view The match pointing into the request target.
+         */
+        std::string_view pathMatchAt(std::size_t index) const
+        {
+            const auto [offset, length] = (*regexMatches_)[index];
+            return target().substr(offset, length);
+        }
+
+        /**
+         * @brief Returns the amount of regex matches.
+         */
+        std::size_t pathMatchCount() const
+        {
+            return regexMatches_ ? regexMatches_->size() : 0;
         }
 
         /**
          * @brief Sets regex matches for this request with the registered route.
          *
-         * @param matches matches[0] = full match, matches[1] = first capture group, ...
+         * @param matches Positions of the capture groups within the request target.
          */
-        Request<BodyT>& pathMatches(std::vector<std::string>&& matches)
+        Request<BodyT>& pathMatches(Detail::PathMatchRanges&& matches)
         {
             regexMatches_ = std::move(matches);
+            regexMatchStrings_.reset();
+            return *this;
+        }
+
+        /**
+         * @brief Retrieves a parameter of a path template route like "/users/{id:uint}".
+         * The value is not percent decoded.
+         *
+         * @tparam T std::string_view (default, points into the request target), std::string, an integral type or Uuid.
+         * @param name The parameter name as given in the route path.
+         * @return std::optional<T> The value or nullopt if there is no such parameter or it cannot be converted.
+         */
+        template <typename T = std::string_view>
+        std::optional<T> pathParameter(std::string_view name) const
+        {
+            if (!pathCaptures_.pathTemplate)
+                return std::nullopt;
+            const auto index = pathCaptures_.pathTemplate->parameterIndex(name);
+            if (!index || *index >= pathCaptures_.size)
+                return std::nullopt;
+            return Detail::convertPathParameter<T>(pathParameterAt(*index));
+        }
+
+        /**
+         * @brief Retrieves a path template parameter by its position within the path.
+         *
+         * @param index The index of the parameter, must be less than pathParameterCount().
+         * @return std::string_view The value pointing into the request target.
+         */
+        std::string_view pathParameterAt(std::size_t index) const
+        {
+            const auto [offset, length] = pathCaptures_.ranges[index];
+            return target().substr(offset, length);
+        }
+
+        /**
+         * @brief Returns the amount of path template parameters.
+         */
+        std::size_t pathParameterCount() const
+        {
+            return pathCaptures_.size;
+        }
+
+        /**
+         * @brief Sets the path template parameters for this request with the registered route.
+         *
+         * @param captures Parameter positions within the request target.
+         */
+        Request<BodyT>& pathParameters(Detail::PathCaptures&& captures)
+        {
+            pathCaptures_ = std::move(captures);
             return *this;
         }
 
@@ -265,8 +415,9 @@ namespace Roar
         {
             return {
                 .regexMatches_ = std::move(regexMatches_),
-                .path_ = std::move(path_),
+                .regexMatchStrings_ = std::move(regexMatchStrings_),
                 .query_ = std::move(query_),
+                .pathCaptures_ = std::move(pathCaptures_),
                 .host_ = std::move(host_),
                 .port_ = std::move(port_)};
         }
@@ -434,47 +585,6 @@ namespace Roar
                 cookies.merge(Cookie::parseCookies(begin->value()));
             return cookies;
         }
-
-      private:
-        /**
-         * @brief Extracts path and query from boost::beast::http::request::target()
-         */
-        void parseTarget()
-        {
-            auto path = std::string{this->target()};
-            auto queryPos = path.find_last_of('?');
-            if (queryPos != std::string::npos)
-            {
-                query_ = parseQuery(std::string_view(path).substr(queryPos + 1, path.size() - queryPos - 1));
-                path.erase(queryPos);
-            }
-            using std::swap;
-            swap(path, path_);
-        }
-
-        /**
-         * @brief Transforms the query part from string to map.
-         *
-         * @param queryString The query as a complete string.
-         * @return std::unordered_map<std::string, std::string> A map containing the query key/value pairs.
-         */
-        std::unordered_map<std::string, std::string> parseQuery(std::string_view queryString) const
-        {
-            std::vector<std::string> splitBySeperator;
-            boost::algorithm::split(
-                splitBySeperator, queryString, boost::algorithm::is_any_of("&;"), boost::algorithm::token_compress_off);
-
-            std::unordered_map<std::string, std::string> query;
-            for (auto const& pair : splitBySeperator)
-            {
-                auto pos = pair.find('=');
-                if (pos == std::string::npos)
-                    query[pair] = "";
-                else
-                    query[pair.substr(0, pos)] = pair.substr(pos + 1, pair.length() - pos - 1);
-            }
-            return query;
-        }
     };
 
     using EmptyBodyRequest = Request<boost::beast::http::empty_body>;
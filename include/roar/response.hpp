@@ -7,6 +7,7 @@
 #include <roar/error.hpp>
 #include <roar/detail/template_utility/first_type.hpp>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/string_body.hpp>
 #include <boost/beast/http/empty_body.hpp>
@@ -19,6 +20,7 @@
 #include <type_traits>
 #include <numeric>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <iterator>
 
@@ -290,6 +292,41 @@ namespace Roar
             return *this;
         }
 
+        /**
+         * @brief Adds a field name to the Vary header, keeping the names that are already listed.
+         * Does nothing if the name is already listed or the response varies on everything ("*").
+         *
+         * @return Response& Returned for chaining.
+         */
+        Response& addVary(std::string_view fieldName)
+        {
+            const auto [begin, end] = response_.equal_range(boost::beast::http::field::vary);
+            for (auto it = begin; it != end; ++it)
+            {
+                std::string_view listed{it->value().data(), it->value().size()};
+                while (!listed.empty())
+                {
+                    const auto comma = listed.find(',');
+                    auto token = listed.substr(0, comma);
+                    listed = comma == std::string_view::npos ? std::string_view{} : listed.substr(comma + 1);
+                    const auto first = token.find_first_not_of(" \t");
+                    if (first == std::string_view::npos)
+                        continue;
+                    token = token.substr(first, token.find_last_not_of(" \t") - first + 1);
+                    if (token == "*" || boost::algorithm::iequals(token, fieldName))
+                        return *this;
+                }
+            }
+
+            // Vary may be split over several header lines, set() folds them into one.
+            std::string merged;
+            for (auto it = begin; it != end; ++it)
+                merged.append(it->value().data(), it->value().size()).append(", ");
+            merged.append(fieldName);
+            response_.set(boost::beast::http::field::vary, merged);
+            return *this;
+        }
+
         /**
          * @brief Sets header values that are implicit by the body (like Content-Lenght).
          *
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Roar
+{
+    /// A UUID as it can be extracted from a "{name:uuid}" path parameter.
+    using Uuid = std::array<std::uint8_t, 16>;
+
+    /// Path parameters per route are limited, so that captures fit into the request without allocation.
+    constexpr std::size_t maxPathParameters = 8;
+
+    enum class PathParameterType
+    {
+        /// Any non empty segment: "{name}" or "{name:string}"
+        String,
+
+        /// An optionally signed decimal integer: "{name:int}"
+        Int,
+
+        /// An unsigned decimal integer: "{name:uint}"
+        Uint,
+
+        /// A UUID in its 8-4-4-4-12 hex form: "{name:uuid}"
+        Uuid
+    };
+
+    /**
+     * @brief A route path with typed parameters, like "/users/{id:uint}/files/{name}".
+     * Parameters always span a whole path segment.
+     */
+    class PathTemplate
+    {
+      public:
+        struct Segment
+        {
+            /// The literal segment text, or the parameter name.
+            std::string text;
+
+            /// Set if this segment is a parameter.
+            std::optional<PathParameterType> parameterType;
+        };
+
+        /**
+         * @brief Parses a path template.
+         *
+         * @param path A path starting with '/'.
+         * @throws std::runtime_error if the template is malformed.
+         */
+        explicit PathTemplate(std::string_view path);
+
+        /**
+         * @brief Returns true if a segment of the path is a parameter ("{name}" or "{name:type}") and the path should
+         * be parsed as a template. Other braces, like in "/{}" or "/a{b}", do not make a path a template.
+         */
+        static bool isTemplate(std::string_view path);
+
+        /**
+         * @brief Returns true if the segment is valid for a parameter of the given type.
+         */
+        static bool segmentMatches(PathParameterType type, std::string_view segment);
+
+        /**
+         * @brief Does the path match this template?
+         */
+        bool matches(std::string_view path) const;
+
+        /**
+         * @brief Returns the position of the parameter in the captures, if there is one by that name.
+         */
+        std::optional<std::size_t> parameterIndex(std::string_view name) const;
+
+        std::vector<Segment> const& segments() const
+        {
+            return segments_;
+        }
+
+        std::size_t parameterCount() const
+        {
+            return parameterCount_;
+        }
+
+      private:
+        std::vector<Segment> segments_;
+        std::size_t parameterCount_;
+    };
+
+    namespace Detail
+    {
+        /**
+         * @brief The parameters of a matched path template, stored as offsets into the request target.
+         */
+        struct PathCaptures
+        {
+            std::shared_ptr<const PathTemplate> pathTemplate{};
+            std::array<std::pair<std::uint32_t, std::uint32_t>, maxPathParameters> ranges{};
+            std::size_t size = 0;
+        };
+
+        /**
+         * @brief Converts a path parameter to the requested type.
+         * Supports std::string_view, std::string, integral types and Uuid.
+         */
+        template <typename T>
+        std::optional<T> convertPathParameter(std::string_view segment)
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+                return segment;
+            else if constexpr (std::is_same_v<T, std::string>)
+                return std::string{segment};
+            else if constexpr (std::is_same_v<T, Uuid>)
+            {
+                if (!PathTemplate::segmentMatches(PathParameterType::Uuid, segment))
+                    return std::nullopt;
+                Uuid uuid{};
+                std::size_t byte = 0;
+                for (std::size_t i = 0; i < segment.size(); i += 2)
+                {
+                    if (segment[i] == '-')
+                        ++i;
+                    std::from_chars(segment.data() + i, segment.data() + i + 2, uuid[byte++], 16);
+                }
+                return uuid;
+            }
+            else
+            {
+                static_assert(std::is_integral_v<T>, "Unsupported path parameter type.");
+                T value{};
+                const auto* end = segment.data() + segment.size();
+                const auto [ptr, ec] = std::from_chars(segment.data(), end, value);
+                if (ec != std::errc{} || ptr != end)
+                    return std::nullopt;
+                return value;
+            }
+        }
+    }
+}
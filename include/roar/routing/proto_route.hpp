@@ -2,7 +2,9 @@
 
 #include <boost/beast/http/empty_body.hpp>
 #include <roar/cors.hpp>
+#include <roar/mechanics/compression.hpp>
 #include <roar/literals/regex.hpp>
+#include <roar/routing/path_template.hpp>
 
 #include <string>
 #include <functional>
@@ -24,6 +26,9 @@ namespace Roar
 
         /// Set this to provide automatically generated cors headers and preflight requests.
         std::optional<CorsSettings> cors = std::nullopt;
+
+        /// Set this to compress responses sent with CompressedBody, if the client accepts it.
+        std::optional<CompressionOptions> compression = std::nullopt;
     };
 
     namespace Detail
@@ -32,6 +37,17 @@ namespace Roar
         {
             std::string basePath;
         };
+
+        struct RegexPath
+        {
+            std::string pattern;
+            std::regex regex;
+        };
+
+        struct TemplatePath
+        {
+            std::shared_ptr<const PathTemplate> pathTemplate;
+        };
     }
 
     class Session;
@@ -43,9 +59,8 @@ namespace Roar
      */
     struct ProtoRoute
     {
-        std::variant<std::string, std::regex, Detail::ServedPath> path;
+        std::variant<std::string, Detail::RegexPath, Detail::ServedPath, Detail::TemplatePath> path;
         std::function<void(Session& session, Request<boost::beast::http::empty_body>&& req)> callRoute;
-        std::function<bool(std::string const&, std::vector<std::string>&)> matches;
         RouteOptions routeOptions;
     };
 }
\ No newline at end of file
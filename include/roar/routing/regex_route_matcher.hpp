@@ -0,0 +1,65 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <boost/beast/http/verb.hpp>
+
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Roar
+{
+    class Route;
+
+    /**
+     * @brief Matches request paths against all regex routes of a verb.
+     *
+     * Every pattern is compiled once. The literal prefix of each pattern (everything before the first regex
+     * operator) is put into a prefix tree, so a lookup only runs the regexes that can possibly match the path.
+     * Candidates are tried in insertion order, so the first added route that matches wins.
+     */
+    class RegexRouteMatcher
+    {
+      public:
+        RegexRouteMatcher();
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(RegexRouteMatcher);
+
+        /**
+         * @brief Adds a regex route.
+         *
+         * @param method The http verb of the route.
+         * @param pattern The ECMAScript source of the regex, used to find the literal prefix.
+         * @param regex The compiled regex.
+         * @param route The route to add.
+         */
+        void insert(boost::beast::http::verb method, std::string_view pattern, std::regex regex, Route&& route);
+
+        /**
+         * @brief Finds the first route that fully matches the path.
+         *
+         * @param method The http verb of the request.
+         * @param path The request path.
+         * @return The route and the captures of the regex pointing into path, if any route matched.
+         */
+        std::optional<std::pair<Route const&, std::vector<std::string_view>>>
+        find(boost::beast::http::verb method, std::string_view path) const;
+
+        /**
+         * @brief Returns the part of a pattern that every matching string has to start with.
+         * Patterns with top level alternatives have no literal prefix.
+         *
+         * @param pattern An ECMAScript regex.
+         * @return std::string The literal prefix, may be empty.
+         */
+        static std::string literalPrefix(std::string_view pattern);
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
@@ -8,6 +8,7 @@
 #include <roar/session/session.hpp>
 #include <roar/routing/flexible_provider.hpp>
 #include <roar/request.hpp>
+#include <roar/filesystem/file_cache.hpp>
 
 #include <boost/beast/http/verb.hpp>
 #include <boost/beast/http/empty_body.hpp>
@@ -43,7 +44,8 @@ namespace Roar
     {
         Unspecified,
 
-        /// Take precedence over any other path
+        /// Take precedence over any other path. Paths with parameters like "/users/{id:uint}" are path templates,
+        /// which take precedence over regex paths.
         RegularString,
 
         /// Take precedence over serve paths
@@ -86,14 +88,14 @@ namespace Roar
 
         /// Called when errors occur on serve file complete. bool parameter = was the connection closed?
         FlexibleProvider<RequestListenerT, std::function<void(bool)>> onFileServeComplete = std::function<void(bool)>{};
-    };
 
-    struct FileAndStatus
-    {
-        std::filesystem::path file{};
-        std::filesystem::path relative{};
-        std::filesystem::file_status status{};
+        /// Serve file.br, file.zst or file.gz in place of file when it exists and the client accepts the encoding.
+        FlexibleProvider<RequestListenerT, bool> servePrecompressed = false;
+
+        /// When set, path resolution, file status and mime types are cached across requests to this route.
+        std::optional<FileCacheOptions> fileCache = std::nullopt;
     };
+
     template <typename RequestListenerT>
     using ServeHandlerType = ServeDecision (RequestListenerT::*)(
         Session&,
@@ -107,6 +109,7 @@ namespace Roar
         .allowUnsecure = false, \
         .expectUpgrade = false, \
         .cors = std::nullopt, \
+        .compression = std::nullopt, \
     };
 
     /**
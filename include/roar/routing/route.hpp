@@ -35,17 +35,6 @@ namespace Roar
             Request<boost::beast::http::empty_body> req,
             StandardResponseProvider const& standardResponseProvider) const;
 
-        /**
-         * @brief Does this route match the given path?
-
-         * @param path A path to match.
-         * @param matches Will be filled with regex matches, if the route path is a regex.
-         *
-         * @return true Does match!
-         * @return false Does not match!
-         */
-        bool matches(std::string const& path, std::vector<std::string>& matches) const;
-
       private:
         struct Implementation;
         std::unique_ptr<Implementation> impl_;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <boost/beast/http/verb.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Roar
+{
+    class Route;
+
+    /**
+     * @brief A compressed prefix tree over request paths that resolves exact routes and served directory
+     * routes in a single descent. Every node carries a route slot per http verb.
+     */
+    class RouteTree
+    {
+      public:
+        /**
+         * @brief The result of a lookup. Both can be set at the same time, the caller decides on precedence.
+         */
+        struct Match
+        {
+            /// A route whose path is equal to the looked up path.
+            Route const* exact = nullptr;
+
+            /// The route with the longest served base path that is a prefix of the looked up path.
+            Route const* served = nullptr;
+        };
+
+        RouteTree();
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(RouteTree);
+
+        /**
+         * @brief Adds a route to the tree. If a route for the same verb and path already exists, the first one is
+         * kept.
+         *
+         * @param method The http verb of the route.
+         * @param path The path or served base path.
+         * @param route The route to add.
+         * @param isPrefix If true, the route matches all paths that start with the given path.
+         */
+        void insert(boost::beast::http::verb method, std::string_view path, Route&& route, bool isPrefix);
+
+        /**
+         * @brief Finds the routes for the given verb and path.
+         *
+         * @param method The http verb of the request.
+         * @param path The request path.
+         * @return Match The exact and served routes, if any.
+         */
+        Match find(boost::beast::http::verb method, std::string_view path) const;
+
+        /**
+         * @brief Returns true if no routes were added.
+         */
+        bool empty() const;
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
@@ -14,6 +14,7 @@
 namespace Roar
 {
     class Session;
+    class StaticRoutes;
     template <typename>
     class Request;
 
@@ -27,11 +28,30 @@ namespace Roar
         ROAR_PIMPL_SPECIAL_FUNCTIONS(Router);
 
         /**
-         * @brief Add new routes to this router.
+         * @brief Add new routes to this router. Requests that are currently being routed are not affected.
          *
          * @param routes A map of verbs->routes.
+         * @return std::size_t An id for the added routes that can be passed to removeRoutes.
          */
-        void addRoutes(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes);
+        std::size_t addRoutes(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes);
+
+        /**
+         * @brief Add the static route table of a request listener. These take precedence like string routes: if
+         * several listeners have a route for the same verb and path, the one that was added first wins.
+         *
+         * @param routes A table of string routes.
+         * @return std::size_t An id for the added routes that can be passed to removeRoutes.
+         */
+        std::size_t addStaticRoutes(std::shared_ptr<const StaticRoutes> routes);
+
+        /**
+         * @brief Removes routes that were added together with addRoutes.
+         *
+         * @param routeGroupId The id returned by addRoutes.
+         * @return true The routes were removed.
+         * @return false There are no routes with this id.
+         */
+        bool removeRoutes(std::size_t routeGroupId);
 
         /**
          * @brief Find a follow route. Automatically responds with 404 when now route can be found.
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <roar/detail/perfect_hash.hpp>
+#include <roar/routing/path_template.hpp>
+#include <roar/routing/request_listener.hpp>
+#include <roar/standard_response_provider.hpp>
+
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/describe/members.hpp>
+#include <boost/describe/modifiers.hpp>
+#include <boost/mp11/algorithm.hpp>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Roar
+{
+    class Session;
+    template <typename>
+    class Request;
+
+    /**
+     * @brief Type erased interface of a StaticRouteTable, so the router can hold tables of any request listener.
+     */
+    class StaticRoutes
+    {
+      public:
+        virtual ~StaticRoutes() = default;
+
+        /**
+         * @brief Finds the route for the verb and path.
+         *
+         * @return std::optional<std::size_t> An index to pass to invoke.
+         */
+        virtual std::optional<std::size_t> find(boost::beast::http::verb method, std::string_view path) const = 0;
+
+        /**
+         * @brief Returns the verb and path of every route, at the index that find returns for them.
+         */
+        virtual std::vector<std::pair<boost::beast::http::verb, std::string_view>> routes() const = 0;
+
+        /**
+         * @brief Calls the handler of the route found with find.
+         */
+        virtual void invoke(
+            std::size_t index,
+            Session& session,
+            Request<boost::beast::http::empty_body>&& req,
+            StandardResponseProvider const& standardResponseProvider) const = 0;
+
+      protected:
+        /**
+         * @brief Applies the route options to the session and rejects requests that violate them.
+         *
+         * @return true The handler shall be called.
+         * @return false A response was already sent.
+         */
+        static bool prepareSession(
+            Session& session,
+            Request<boost::beast::http::empty_body> const& req,
+            RouteOptions const& routeOptions,
+            bool serverIsSecure,
+            StandardResponseProvider const& standardResponseProvider);
+    };
+
+    /**
+     * @brief A perfect hash table of all routes of a request listener, that dispatches directly to the member
+     * functions. Only used for listeners whose routes are all plain string paths.
+     *
+     * @tparam RequestListenerT The request listener class.
+     */
+    template <typename RequestListenerT>
+    class StaticRouteTable : public StaticRoutes
+    {
+      public:
+        struct StaticRoute
+        {
+            boost::beast::http::verb method;
+            std::string_view path;
+            HandlerType<RequestListenerT> handler;
+            RouteOptions routeOptions;
+        };
+
+        /**
+         * @brief Creates the table, if all routes of the listener qualify.
+         *
+         * @param listener The listener instance.
+         * @param serverIsSecure Is the server an https server?
+         * @return std::shared_ptr<StaticRouteTable> nullptr if any route is not a plain string route.
+         */
+        static std::shared_ptr<StaticRouteTable>
+        tryMake(std::shared_ptr<RequestListenerT> listener, bool serverIsSecure)
+        {
+            using routes = boost::describe::
+                describe_members<RequestListenerT, boost::describe::mod_any_access | boost::describe::mod_static>;
+
+            constexpr bool allRegularRoutes = []<typename... Ds>(boost::mp11::mp_list<Ds...>) {
+                return (std::is_same_v<std::decay_t<decltype(*Ds::pointer)>, RouteInfo<RequestListenerT>> && ...);
+            }(routes{});
+            if constexpr (!allRegularRoutes)
+                return nullptr;
+            else
+            {
+                bool qualifies = true;
+                std::vector<typename Detail::PerfectHashTable<std::size_t>::Entry> entries;
+                std::vector<StaticRoute> staticRoutes;
+                boost::mp11::mp_for_each<routes>([&]<typename T>(T route) {
+                    auto const& info = *route.pointer;
+                    if (!qualifies || info.pathType != RoutePathType::RegularString || !info.verb ||
+                        PathTemplate::isTemplate(info.path) ||
+                        (info.routeOptions.cors && info.routeOptions.cors->generatePreflightOptionsRoute))
+                    {
+                        qualifies = false;
+                        return;
+                    }
+                    entries.push_back({.method = *info.verb, .path = info.path, .value = staticRoutes.size()});
+                    staticRoutes.push_back(StaticRoute{
+                        .method = *info.verb,
+                        .path = info.path,
+                        .handler = info.handler,
+                        .routeOptions = info.routeOptions,
+                    });
+                });
+                if (!qualifies)
+                    return nullptr;
+
+                return std::shared_ptr<StaticRouteTable>(new StaticRouteTable{
+                    std::move(listener),
+                    serverIsSecure,
+                    Detail::PerfectHashTable<std::size_t>{std::move(entries)},
+                    std::move(staticRoutes)});
+            }
+        }
+
+        std::optional<std::size_t> find(boost::beast::http::verb method, std::string_view path) const override
+        {
+            if (auto const* index = table_.find(method, path); index)
+                return *index;
+            return std::nullopt;
+        }
+
+        std::vector<std::pair<boost::beast::http::verb, std::string_view>> routes() const override
+        {
+            std::vector<std::pair<boost::beast::http::verb, std::string_view>> result;
+            result.reserve(routes_.size());
+            for (auto const& route : routes_)
+                result.emplace_back(route.method, route.path);
+            return result;
+        }
+
+        void invoke(
+            std::size_t index,
+            Session& session,
+            Request<boost::beast::http::empty_body>&& req,
+            StandardResponseProvider const& standardResponseProvider) const override
+        {
+            auto const& route = routes_[index];
+            if (!prepareSession(session, req, route.routeOptions, serverIsSecure_, standardResponseProvider))
+                return;
+            std::invoke(route.handler, *listener_, session, std::move(req));
+        }
+
+      private:
+        StaticRouteTable(
+            std::shared_ptr<RequestListenerT> listener,
+            bool serverIsSecure,
+            Detail::PerfectHashTable<std::size_t> table,
+            std::vector<StaticRoute> routes)
+            : listener_{std::move(listener)}
+            , serverIsSecure_{serverIsSecure}
+            , table_{std::move(table)}
+            , routes_{std::move(routes)}
+        {}
+
+      private:
+        std::shared_ptr<RequestListenerT> listener_;
+        bool serverIsSecure_;
+        Detail::PerfectHashTable<std::size_t> table_;
+        std::vector<StaticRoute> routes_;
+    };
+}
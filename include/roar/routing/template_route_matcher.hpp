@@ -0,0 +1,55 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+#include <roar/routing/path_template.hpp>
+
+#include <boost/beast/http/verb.hpp>
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace Roar
+{
+    class Route;
+
+    /**
+     * @brief Matches request paths against path template routes like "/users/{id:uint}".
+     * All templates of a verb share one tree of path segments. Literal segments take precedence over parameters,
+     * parameters are tried in insertion order.
+     */
+    class TemplateRouteMatcher
+    {
+      public:
+        struct Match
+        {
+            Route const* route;
+            Detail::PathCaptures captures;
+        };
+
+        TemplateRouteMatcher();
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(TemplateRouteMatcher);
+
+        /**
+         * @brief Adds a template route. If a template with the same shape already exists, the first one is kept.
+         *
+         * @param method The http verb of the route.
+         * @param pathTemplate The parsed template.
+         * @param route The route to add.
+         */
+        void insert(boost::beast::http::verb method, std::shared_ptr<const PathTemplate> pathTemplate, Route&& route);
+
+        /**
+         * @brief Finds the route matching the path.
+         *
+         * @param method The http verb of the request.
+         * @param path The request path without query.
+         * @return The route and the parameter positions within the path.
+         */
+        std::optional<Match> find(boost::beast::http::verb method, std::string_view path) const;
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
@@ -4,11 +4,15 @@
 #include <roar/routing/proto_route.hpp>
 #include <roar/error.hpp>
 #include <roar/session/session.hpp>
+#include <roar/session/admission_control.hpp>
+#include <roar/session/connection_mode.hpp>
 #include <roar/request.hpp>
 #include <roar/routing/request_listener.hpp>
+#include <roar/routing/static_route_table.hpp>
 #include <roar/standard_response_provider.hpp>
 #include <roar/standard_text_response_provider.hpp>
 #include <roar/ssl/make_ssl_context.hpp>
+#include <roar/utility/io_context_pool.hpp>
 #include <roar/filesystem/jail.hpp>
 
 #include <boost/describe/modifiers.hpp>
@@ -19,12 +23,14 @@
 #include <boost/beast/http/verb.hpp>
 
 #include <memory>
+#include <chrono>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <functional>
 #include <iterator>
 #include <variant>
+#include <vector>
 
 namespace Roar
 {
@@ -34,7 +40,7 @@ namespace Roar
       public:
         struct ConstructionArguments
         {
-            /// Required io executor for boost::asio.
+            /// Required io executor for boost::asio, unless threadPerCore is set.
             boost::asio::any_io_executor executor;
 
             /// Supply for SSL support.
@@ -50,6 +56,44 @@ namespace Roar
             /// provides responses for errors like 404 or 500.
             std::unique_ptr<StandardResponseProvider> standardResponseProvider =
                 std::make_unique<StandardTextResponseProvider>();
+
+            /// Maximum amount of requests that are served on a single keep-alive connection before it is closed.
+            /// 0 means unlimited.
+            std::size_t maxRequestsPerConnection = 0;
+
+            /// How long a kept alive connection may idle while waiting for the next request before it is closed.
+            std::chrono::milliseconds idleTimeout = std::chrono::seconds{10};
+
+            /// Number of acceptors listening on the same endpoint. With more than one, every acceptor socket is
+            /// opened with SO_REUSEPORT so that the kernel distributes incoming connections across them.
+            std::size_t acceptorCount = 1;
+
+            /// Executors for the acceptors. Acceptor i runs on a strand of acceptorExecutors[i % size] and so do the
+            /// sessions it accepts. When empty, every acceptor gets its own strand on the executor above.
+            std::vector<boost::asio::any_io_executor> acceptorExecutors = {};
+
+            /// When set, the server owns a pool of single threaded io_contexts and runs one SO_REUSEPORT acceptor on
+            /// each. A connection stays on the context that accepted it for its whole lifetime, so sessions run
+            /// without strands. executor, acceptorCount and acceptorExecutors are ignored in this mode. Sessions must
+            /// not outlive the server.
+            std::optional<IoContextPool::ConstructionArguments> threadPerCore = std::nullopt;
+
+            /// Number of accept operations that are kept outstanding on every acceptor.
+            std::size_t pendingAccepts = 1;
+
+            /// Maximum number of connections taken from the listen backlog when an acceptor wakes up. All but the
+            /// first are accepted without waiting, until the backlog is empty.
+            std::size_t acceptBatchSize = 1;
+
+            /// Size of the listen backlog of every acceptor.
+            int listenBacklog = boost::asio::socket_base::max_listen_connections;
+
+            /// Limits on connections and in flight requests, and load shedding by queueing delay.
+            AdmissionLimits admissionLimits = {};
+
+            /// Number of threads in a pool for blocking file reads. When not 0, file bodies that cannot be sent with
+            /// sendfile (tls, rate limits) are read on this pool ahead of the writes, instead of on the io threads.
+            std::size_t fileIoThreads = 0;
         };
 
         /**
@@ -70,15 +114,34 @@ namespace Roar
          *
          * @param host An ip / hostname to identify the network interface to listen on.
          * @param port A port to bind on.
+         * @param connectionMode Whether connections are plain http, TLS or detected per connection.
          */
-        boost::leaf::result<void> start(unsigned short port = 0, std::string const& host = "::");
+        boost::leaf::result<void> start(
+            unsigned short port = 0,
+            std::string const& host = "::",
+            ConnectionMode connectionMode = ConnectionMode::AutoDetect);
 
         /**
          * @brief Starts the server given the already resolved bind endpoint.
          *
          * @param bindEndpoint An endpoint to bind on.
+         * @param connectionMode Whether connections are plain http, TLS or detected per connection.
+         */
+        boost::leaf::result<void> start(
+            boost::asio::ip::basic_endpoint<boost::asio::ip::tcp> const& bindEndpoint,
+            ConnectionMode connectionMode = ConnectionMode::AutoDetect);
+
+        /**
+         * @brief Listens on a further endpoint in addition to the one given to start, for instance a plain http
+         * port next to a TLS port. Stopped together with all other endpoints by stop.
+         *
+         * @param bindEndpoint An endpoint to bind on.
+         * @param connectionMode Whether connections are plain http, TLS or detected per connection.
+         * @return The endpoint that was bound to.
          */
-        boost::leaf::result<void> start(boost::asio::ip::basic_endpoint<boost::asio::ip::tcp> const& bindEndpoint);
+        boost::leaf::result<boost::asio::ip::basic_endpoint<boost::asio::ip::tcp>> listen(
+            boost::asio::ip::basic_endpoint<boost::asio::ip::tcp> const& bindEndpoint,
+            ConnectionMode connectionMode);
 
         /**
          * @brief Get the local endpoint that this server bound to.
@@ -101,16 +164,38 @@ namespace Roar
         std::shared_ptr<RequestListenerT> installRequestListener(ConstructionArgsT&&... args)
         {
             auto listener = std::make_shared<RequestListenerT>(std::forward<ConstructionArgsT>(args)...);
+
+            // Listeners with only plain string routes get a perfect hash table with direct handler calls.
+            if (auto staticRoutes = StaticRouteTable<RequestListenerT>::tryMake(listener, isSecure()); staticRoutes)
+            {
+                addStaticRoutesToRouter(listener.get(), std::move(staticRoutes));
+                return listener;
+            }
+
             using routes = boost::describe::
                 describe_members<RequestListenerT, boost::describe::mod_any_access | boost::describe::mod_static>;
             std::unordered_multimap<boost::beast::http::verb, ProtoRoute> extractedRoutes;
             boost::mp11::mp_for_each<routes>([&extractedRoutes, &listener, this]<typename T>(T route) {
                 this->addRoute(listener, extractedRoutes, *route.pointer);
             });
-            addRequestListenerToRouter(std::move(extractedRoutes));
+            addRequestListenerToRouter(listener.get(), std::move(extractedRoutes));
             return listener;
         }
 
+        /**
+         * @brief Removes all routes of a request listener that was installed with installRequestListener.
+         * Requests that are already being handled are not affected.
+         *
+         * @param listener The listener returned by installRequestListener.
+         * @return true The routes were removed.
+         * @return false The listener is not installed on this server.
+         */
+        template <typename RequestListenerT>
+        bool removeRequestListener(std::shared_ptr<RequestListenerT> const& listener)
+        {
+            return removeRequestListenerFromRouter(listener.get());
+        }
+
         /**
          * @brief Returns whether this server has a certificate and key and is therefore a HTTPS server.
          *
@@ -119,6 +204,12 @@ namespace Roar
          */
         bool isSecure() const;
 
+        /**
+         * @brief Returns the session resumption counters, if the server has an SslServerContext with session
+         * resumption enabled.
+         */
+        std::optional<SslSessionStatistics> sslSessionStatistics() const;
+
         /**
          * @brief Get the Executor object
          *
@@ -138,25 +229,19 @@ namespace Roar
             {
                 case (RoutePathType::RegularString):
                 {
+                    if (PathTemplate::isTemplate(info.path))
+                    {
+                        protoRoute.path = Detail::TemplatePath{
+                            .pathTemplate = std::make_shared<const PathTemplate>(info.path)};
+                        break;
+                    }
                     protoRoute.path = std::string{info.path};
-                    protoRoute.matches = [p = info.path](std::string const& path, std::vector<std::string>&) {
-                        return path == p;
-                    };
                     break;
                 }
                 case (RoutePathType::Regex):
                 {
-                    protoRoute.path = std::regex{info.path};
-                    protoRoute.matches =
-                        [p = info.path](std::string const& path, std::vector<std::string>& regexMatches) {
-                            std::smatch smatch;
-                            auto result = std::regex_match(path, smatch, std::regex{p});
-                            regexMatches.reserve(smatch.size());
-                            for (auto submatch = std::next(std::begin(smatch)), end = std::end(smatch); submatch < end;
-                                 ++submatch)
-                                regexMatches.push_back(submatch->str());
-                            return result;
-                        };
+                    protoRoute.path =
+                        Detail::RegexPath{.pattern = std::string{info.path}, .regex = std::regex{info.path}};
                     break;
                 }
                 default:
@@ -199,16 +284,13 @@ namespace Roar
             ProtoRoute protoRoute{};
             protoRoute.path = Detail::ServedPath{std::string{info.path}};
             protoRoute.routeOptions = info.routeOptions;
-            protoRoute.callRoute = [dserver = Detail::DirectoryServer<RequestListenerT>{{
-                                        .serverIsSecure_ = isSecure(),
-                                        .serveInfo_ = info,
-                                        .listener_ = listener,
-                                    }}](Session& session, Request<http::empty_body> const& req) {
-                auto dserverCpy = dserver;
-                dserverCpy(session, req);
-            };
-            protoRoute.matches = [p = info.path](std::string const& path, std::vector<std::string>&) {
-                return path.starts_with(p);
+            protoRoute.callRoute = [dserver = std::make_shared<Detail::DirectoryServer<RequestListenerT> const>(
+                                        Detail::DirectoryServerConstructionArgs<RequestListenerT>{
+                                            .serverIsSecure_ = isSecure(),
+                                            .serveInfo_ = info,
+                                            .listener_ = listener,
+                                        })](Session& session, Request<http::empty_body> const& req) {
+                (*dserver)(session, req);
             };
             // Add the all regardeless of allowed or not, to give a proper response.
             extractedRoutes.emplace(http::verb::options, protoRoute);
@@ -218,7 +300,11 @@ namespace Roar
             extractedRoutes.emplace(http::verb::delete_, protoRoute);
         }
 
-        void addRequestListenerToRouter(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes);
+        void addRequestListenerToRouter(
+            void const* listener,
+            std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes);
+        void addStaticRoutesToRouter(void const* listener, std::shared_ptr<const StaticRoutes> routes);
+        bool removeRequestListenerFromRouter(void const* listener);
 
       private:
         struct Implementation;
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Roar
+{
+    /**
+     * @brief Limits that protect a server from overload.
+     */
+    struct AdmissionLimits
+    {
+        /// Maximum number of open connections. Accepting pauses while the limit is reached. 0 means unlimited.
+        std::size_t maxConnections = 0;
+
+        /// Maximum number of requests that are handled at the same time. Requests beyond it are answered with
+        /// 503 Service Unavailable. 0 means unlimited.
+        std::size_t maxInFlightRequests = 0;
+
+        /// When set, requests are dispatched to their handlers through the executor and answered with 503 Service
+        /// Unavailable if the time from parsed header to handler start exceeds this delay.
+        std::optional<std::chrono::milliseconds> maxQueueingDelay = std::nullopt;
+    };
+
+    class AdmissionControl;
+
+    /**
+     * @brief Holds one admitted connection or request and releases it on destruction.
+     */
+    class AdmissionTicket
+    {
+      public:
+        enum class Kind
+        {
+            Connection,
+            Request
+        };
+
+        AdmissionTicket() = default;
+        AdmissionTicket(std::shared_ptr<AdmissionControl> admissionControl, Kind kind);
+        ~AdmissionTicket();
+        AdmissionTicket(AdmissionTicket const&) = delete;
+        AdmissionTicket(AdmissionTicket&&) noexcept;
+        AdmissionTicket& operator=(AdmissionTicket const&) = delete;
+        AdmissionTicket& operator=(AdmissionTicket&&) noexcept;
+
+        /**
+         * @brief Returns true if this ticket holds an admission.
+         */
+        explicit operator bool() const;
+
+        /**
+         * @brief Gives the admission back early.
+         */
+        void release();
+
+      private:
+        std::shared_ptr<AdmissionControl> admissionControl_{};
+        Kind kind_{Kind::Connection};
+    };
+
+    /**
+     * @brief Counts open connections and in flight requests of a server and decides about their admission.
+     */
+    class AdmissionControl : public std::enable_shared_from_this<AdmissionControl>
+    {
+      public:
+        AdmissionControl(AdmissionLimits limits);
+
+        /**
+         * @brief Admits a connection if the connection limit permits it.
+         *
+         * @return AdmissionTicket An empty ticket if the limit is reached.
+         */
+        AdmissionTicket tryAdmitConnection();
+
+        /**
+         * @brief Calls resume once a connection is released. Calls it immediately if one already was.
+         *
+         * @param resume Called without any lock held, possibly from another thread.
+         */
+        void onConnectionAvailable(std::function<void()> resume);
+
+        /**
+         * @brief Admits a request if the in flight request limit permits it.
+         *
+         * @return AdmissionTicket An empty ticket if the limit is reached.
+         */
+        AdmissionTicket tryAdmitRequest();
+
+        /**
+         * @brief Returns true if requests are dispatched through the executor to measure their queueing delay.
+         */
+        bool measuresQueueingDelay() const;
+
+        /**
+         * @brief Returns true if a request that waited this long before its handler started should be rejected.
+         */
+        bool shouldShed(std::chrono::steady_clock::duration queueingDelay) const;
+
+        std::size_t connectionCount() const;
+        std::size_t inFlightRequestCount() const;
+
+      private:
+        friend class AdmissionTicket;
+
+        void release(AdmissionTicket::Kind kind);
+
+      private:
+        AdmissionLimits limits_;
+        std::atomic<std::size_t> connections_;
+        std::atomic<std::size_t> inFlightRequests_;
+        std::mutex waitingMutex_;
+        std::vector<std::function<void()>> waitingForConnection_;
+    };
+}
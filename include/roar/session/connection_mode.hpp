@@ -0,0 +1,19 @@
+#pragma once
+
+namespace Roar
+{
+    /**
+     * @brief How the connections accepted on a listening endpoint are set up.
+     */
+    enum class ConnectionMode
+    {
+        /// Sniffs the first bytes of every connection to decide between plain http and TLS.
+        AutoDetect,
+
+        /// Only plain http. Sessions are created right away, without waiting for the first bytes.
+        Plain,
+
+        /// Only TLS. Sessions are created right away and start with the handshake. Requires an SSL context.
+        Tls
+    };
+}
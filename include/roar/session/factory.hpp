@@ -4,6 +4,9 @@
 #include <roar/ssl/make_ssl_context.hpp>
 #include <roar/standard_response_provider.hpp>
 #include <roar/error.hpp>
+#include <roar/session/admission_control.hpp>
+
+#include <boost/asio/thread_pool.hpp>
 
 #include <memory>
 #include <optional>
@@ -26,7 +29,11 @@ namespace Roar
       public:
         Factory(
             std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext,
-            std::function<void(Error&&)> onError);
+            std::function<void(Error&&)> onError,
+            std::size_t maxRequestsPerConnection = 0,
+            std::chrono::milliseconds idleTimeout = std::chrono::seconds{10},
+            std::shared_ptr<AdmissionControl> admissionControl = {},
+            std::shared_ptr<boost::asio::thread_pool> fileIoPool = {});
         ROAR_PIMPL_SPECIAL_FUNCTIONS(Factory);
 
         /**
@@ -35,11 +42,30 @@ namespace Roar
          * @param socket A socket for this session
          * @param router A weak reference to the router.
          * @param standardResponseProvider A standard response provider.
+         * @param connectionTicket The admission of this connection, released when the session ends.
+         */
+        void makeSession(
+            boost::asio::basic_stream_socket<boost::asio::ip::tcp>&& socket,
+            std::weak_ptr<Router> router,
+            std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+            AdmissionTicket connectionTicket = {});
+
+        /**
+         * @brief Creates a new http session for a connection whose kind is known in advance. The first bytes are
+         * not inspected.
+         *
+         * @param socket A socket for this session
+         * @param isSecure Whether the session starts with a TLS handshake.
+         * @param router A weak reference to the router.
+         * @param standardResponseProvider A standard response provider.
+         * @param connectionTicket The admission of this connection, released when the session ends.
          */
         void makeSession(
             boost::asio::basic_stream_socket<boost::asio::ip::tcp>&& socket,
+            bool isSecure,
             std::weak_ptr<Router> router,
-            std::shared_ptr<const StandardResponseProvider> standardResponseProvider);
+            std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+            AdmissionTicket connectionTicket = {});
 
       private:
         struct ProtoSession;
@@ -12,15 +12,22 @@
 #include <roar/detail/promise_compat.hpp>
 #include <roar/body/void_body.hpp>
 #include <roar/detail/stream_type.hpp>
+#include <roar/detail/send_file.hpp>
+#include <roar/detail/prefetched_file_write.hpp>
 #include <roar/body/range_file_body.hpp>
+#include <roar/body/compressed_body.hpp>
+#include <roar/detail/decoding_body.hpp>
+#include <roar/session/admission_control.hpp>
 
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/file_body.hpp>
 #include <boost/beast/http/parser.hpp>
 #include <boost/beast/http/write.hpp>
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <roar/ssl/make_ssl_context.hpp>
 #include <promise-cpp/promise.hpp>
 
@@ -30,6 +37,7 @@
 #include <variant>
 #include <stdexcept>
 #include <sstream>
+#include <string_view>
 
 namespace Roar
 {
@@ -40,6 +48,7 @@ namespace Roar
     {
       public:
         friend class Route;
+        friend class StaticRoutes;
         friend class Factory;
 
         constexpr static uint64_t defaultHeaderLimit{8_MiB};
@@ -53,7 +62,12 @@ namespace Roar
             bool isSecure,
             std::function<void(Error&&)> onError,
             std::weak_ptr<Router> router,
-            std::shared_ptr<const StandardResponseProvider> standardResponseProvider);
+            std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+            std::size_t maxRequestsPerConnection = 0,
+            std::chrono::milliseconds idleTimeout = sessionTimeout,
+            std::shared_ptr<AdmissionControl> admissionControl = {},
+            AdmissionTicket connectionTicket = {},
+            std::shared_ptr<boost::asio::thread_pool> fileIoPool = {});
         ROAR_PIMPL_SPECIAL_FUNCTIONS(Session);
 
         /**
@@ -223,15 +237,14 @@ namespace Roar
                 CommitReturnType>
             commit()
             {
-                if (overallTimeout_)
-                {
-                    session_->withStreamDo([this](auto& stream) {
-                        boost::beast::get_lowest_layer(stream).expires_after(*overallTimeout_);
-                    });
-                }
                 promise_ = std::make_unique<promise::Promise>(promise::newPromise());
+                captureRequestState();
+                if constexpr (Detail::IsCompressedBody<BodyT>::value)
+                    prepareCompression();
+                prepareKeepAlive();
+                completesResponse_ = !isInterimResponse();
                 serializer_ = std::make_unique<boost::beast::http::serializer<false, BodyT>>(response_.response());
-                writeChunk();
+                enqueueWrite();
                 return {*promise_};
             }
 
@@ -241,15 +254,12 @@ namespace Roar
             template <typename T = BodyT>
             std::enable_if_t<std::is_same_v<T, boost::beast::http::empty_body>, CommitReturnType> commit()
             {
-                if (overallTimeout_)
-                {
-                    session_->withStreamDo([this](auto& stream) {
-                        boost::beast::get_lowest_layer(stream).expires_after(*overallTimeout_);
-                    });
-                }
                 promise_ = std::make_unique<promise::Promise>(promise::newPromise());
+                captureRequestState();
+                prepareKeepAlive();
+                completesResponse_ = headerCompletesResponse();
                 serializer_ = std::make_unique<boost::beast::http::serializer<false, BodyT>>(response_.response());
-                writeHeader();
+                enqueueWrite();
                 return {*promise_};
             }
 
@@ -328,6 +338,257 @@ namespace Roar
             }
 
           private:
+            /**
+             * @brief Copies the state of the request this response answers. The session reads the next (pipelined)
+             * request right after the final commit, which overwrites the session state before this response may
+             * have been written.
+             */
+            void captureRequestState()
+            {
+                headRequest_ = session_->isHeadRequest();
+                zeroCopyFileWritesAllowed_ = session_->zeroCopyFileWritesAllowed();
+            }
+
+            /**
+             * @brief Interim responses (1xx) do not end the exchange, so they do not count for keep alive.
+             */
+            bool isInterimResponse()
+            {
+                return boost::beast::http::to_status_class(response_.result()) ==
+                    boost::beast::http::status_class::informational;
+            }
+
+            /**
+             * @brief Tells the client that the connection will be closed, if the session cannot keep it alive.
+             */
+            void prepareKeepAlive()
+            {
+                if (!isInterimResponse() && !session_->keepAliveAllowed())
+                    response_.keepAlive(false);
+            }
+
+            /**
+             * @brief Picks the content coding of a compressed body from the route options and the Accept-Encoding of
+             * the request and sets the framing headers to match.
+             */
+            void prepareCompression()
+            {
+                using namespace boost::beast::http;
+                auto& res = response_.response();
+                auto& body = res.body();
+                auto const& options = session_->routeOptions().compression;
+                const auto size = BodyT::uncompressedSize(body);
+
+                body.contentCoding = ContentCoding::Identity;
+                if (options && !isInterimResponse() && res.result() != status::no_content &&
+                    res.result() != status::not_modified && res.find(field::content_encoding) == std::end(res))
+                {
+                    const auto contentType = res[field::content_type];
+                    body.contentCoding = selectCompression(
+                        *options,
+                        session_->acceptEncoding(),
+                        {contentType.data(), contentType.size()},
+                        size);
+                    body.compressionLevel = options->level;
+                    response_.addVary("Accept-Encoding");
+                }
+
+                if (body.contentCoding == ContentCoding::Identity && size)
+                {
+                    res.content_length(*size);
+                    return;
+                }
+                if (body.contentCoding != ContentCoding::Identity)
+                    res.set(field::content_encoding, std::string{contentCodingName(body.contentCoding)});
+                res.chunked(true);
+            }
+
+            /**
+             * @brief Returns true if a header only response is complete without any data following it.
+             * Otherwise the library user is going to send the body manually (for instance server sent events).
+             */
+            bool headerCompletesResponse()
+            {
+                using namespace boost::beast::http;
+                if (isInterimResponse())
+                    return false;
+                if (headRequest_ || response_.result() == status::no_content ||
+                    response_.result() == status::not_modified)
+                    return true;
+                if (response_.response().chunked())
+                    return false;
+                const auto contentLength = response_.find(field::content_length);
+                return contentLength != std::end(response_) && contentLength->value() == "0";
+            }
+
+            /**
+             * @brief Queues the response behind responses to earlier requests on this connection.
+             * Once the final response is committed and the connection stays open, the next (possibly pipelined)
+             * request is read while this response is still being written.
+             */
+            void enqueueWrite()
+            {
+                session_->enqueueResponse([self = this->shared_from_this()]() {
+                    self->startWrite();
+                });
+
+                if (completesResponse_ && !response_.response().need_eof())
+                    session_->readHeader();
+            }
+
+            void startWrite()
+            {
+                if (overallTimeout_)
+                {
+                    session_->withStreamDo([this](auto& stream) {
+                        boost::beast::get_lowest_layer(stream).expires_after(*overallTimeout_);
+                    });
+                }
+
+                if constexpr (std::is_same_v<BodyT, boost::beast::http::empty_body>)
+                    writeHeader();
+                else
+                {
+                    // Responses to HEAD requests never have a body, whatever the body type is.
+                    if (headRequest_)
+                        writeHeader();
+                    else if constexpr (isFileBody)
+                    {
+                        if (useZeroCopyFileWrite())
+                            writeFileZeroCopy();
+                        else if (usePrefetchedFileWrite())
+                            writeFilePrefetched();
+                        else
+                            writeChunk();
+                    }
+                    else
+                        writeChunk();
+                }
+            }
+
+            /**
+             * @brief File bodies on plain connections are moved by the kernel (sendfile) instead of being read into a
+             * buffer and written back out.
+             */
+            bool useZeroCopyFileWrite()
+            {
+                return Detail::sendFileSupported && !onChunk_ && !response_.response().chunked() &&
+                    zeroCopyFileWritesAllowed_;
+            }
+
+            /**
+             * @brief Otherwise file bodies are read on the file io pool of the server, if there is one, so that disk
+             * reads do not block the io threads.
+             */
+            bool usePrefetchedFileWrite()
+            {
+                return !onChunk_ && !response_.response().chunked() && session_->fileIoExecutor();
+            }
+
+            void writeFileZeroCopy()
+            {
+                auto& stream = std::get<Detail::StreamType>(session_->stream());
+                if (!overallTimeout_)
+                    stream.expires_after(std::chrono::seconds(sessionTimeout));
+
+                boost::beast::http::async_write_header(
+                    stream,
+                    *serializer_,
+                    [self = this->shared_from_this()](boost::beast::error_code ec, std::size_t bytesTransferred) {
+                        if (ec)
+                            return self->failWrite(ec);
+                        self->writeFileBodyZeroCopy(bytesTransferred);
+                    });
+            }
+
+            void writeFileBodyZeroCopy(std::size_t headerBytes)
+            {
+                auto onComplete = fileBodyWritten(headerBytes);
+                boost::beast::error_code ec;
+                auto segments = fileBodySegments(ec);
+                if (ec)
+                    return onComplete(ec, 0);
+
+                Detail::asyncSendFile(
+                    std::get<Detail::StreamType>(session_->stream()),
+                    response_.body().file().native_handle(),
+                    std::move(segments),
+                    fileBodyIdleTimeout(),
+                    std::move(onComplete));
+            }
+
+            void writeFilePrefetched()
+            {
+                session_->withStreamDo([this](auto& stream) {
+                    if (!overallTimeout_)
+                        boost::beast::get_lowest_layer(stream).expires_after(std::chrono::seconds(sessionTimeout));
+
+                    boost::beast::http::async_write_header(
+                        stream,
+                        *serializer_,
+                        [self = this->shared_from_this()](boost::beast::error_code ec, std::size_t bytesTransferred) {
+                            if (ec)
+                                return self->failWrite(ec);
+                            self->writeFileBodyPrefetched(bytesTransferred);
+                        });
+                });
+            }
+
+            void writeFileBodyPrefetched(std::size_t headerBytes)
+            {
+                auto onComplete = fileBodyWritten(headerBytes);
+                boost::beast::error_code ec;
+                auto segments = fileBodySegments(ec);
+                if (ec)
+                    return onComplete(ec, 0);
+
+                std::size_t chunkSize = Detail::RangeFileBodyImpl::defaultBufferSize;
+                if constexpr (std::is_same_v<BodyT, RangeFileBody>)
+                    chunkSize = response_.body().bufferSize();
+
+                session_->withStreamDo([&, this](auto& stream) {
+                    Detail::asyncWritePrefetched(
+                        stream,
+                        *session_->fileIoExecutor(),
+                        response_.body().file(),
+                        segments,
+                        chunkSize,
+                        fileBodyIdleTimeout(),
+                        std::move(onComplete));
+                });
+            }
+
+            /**
+             * @brief The not yet written part of the file body.
+             */
+            std::vector<Detail::SendFileSegment> fileBodySegments(boost::beast::error_code& ec)
+            {
+                if constexpr (std::is_same_v<BodyT, RangeFileBody>)
+                    return response_.body().segments();
+                else
+                {
+                    const auto offset = response_.body().file().pos(ec);
+                    if (ec)
+                        return {};
+                    return {{.prefix = {}, .offset = offset, .length = response_.body().size() - offset}};
+                }
+            }
+
+            std::chrono::milliseconds fileBodyIdleTimeout() const
+            {
+                return overallTimeout_.value_or(std::chrono::duration_cast<std::chrono::milliseconds>(sessionTimeout));
+            }
+
+            auto fileBodyWritten(std::size_t headerBytes)
+            {
+                return [self = this->shared_from_this(), headerBytes](
+                           boost::system::error_code ec, std::uint64_t bytesTransferred) {
+                    if (ec)
+                        return self->failWrite(ec);
+                    self->finishWrite(ec, headerBytes + static_cast<std::size_t>(bytesTransferred));
+                };
+            }
+
             void writeHeader()
             {
                 session_->withStreamDo([this](auto& stream) {
@@ -337,11 +598,11 @@ namespace Roar
                     boost::beast::http::async_write_header(
                         stream,
                         *serializer_,
-                        [self = this->shared_from_this()](boost::beast::error_code ec, std::size_t) {
+                        [self = this->shared_from_this()](boost::beast::error_code ec, std::size_t bytesTransferred) {
                             if (ec)
-                                self->promise_->fail(ec);
-                            else
-                                self->promise_->resolve(false);
+                                return self->failWrite(ec);
+
+                            self->finishWrite(ec, bytesTransferred);
                         });
                 });
             }
@@ -360,36 +621,65 @@ namespace Roar
                                 return self->writeChunk();
 
                             if (ec)
-                            {
-                                self->session_->close();
-                                self->promise_->reject(Error{.error = ec, .additionalInfo = "Failed to send response"});
-                                return;
-                            }
+                                return self->failWrite(ec);
 
                             if (self->onChunk_ && !self->onChunk_(bytesTransferred))
-                                return;
-
-                            try
                             {
-                                self->promise_->resolve(self->session_->onWriteComplete(
-                                    self->serializer_->get().need_eof(), ec, bytesTransferred));
-                            }
-                            catch (std::exception const& exc)
-                            {
-                                self->promise_->fail(
-                                    Error{.error = exc.what(), .additionalInfo = "Failed to send response"});
+                                self->session_->onResponseWritten(self->completesResponse_);
+                                return;
                             }
+
+                            self->finishWrite(ec, bytesTransferred);
                         });
                 });
             }
 
+            /**
+             * @brief A failed write leaves the connection in an unknown state, so it is closed.
+             */
+            void failWrite(boost::beast::error_code ec)
+            {
+                session_->close();
+                session_->onResponseWritten(completesResponse_);
+                promise_->reject(Error{.error = ec, .additionalInfo = "Failed to send response"});
+            }
+
+            void finishWrite(boost::beast::error_code ec, std::size_t bytesTransferred)
+            {
+                // Interim responses are followed by the final one, the connection stays as it is.
+                if (!completesResponse_)
+                {
+                    session_->onResponseWritten(completesResponse_);
+                    promise_->resolve(false);
+                    return;
+                }
+
+                try
+                {
+                    const bool closed = session_->onWriteComplete(serializer_->get().need_eof(), ec, bytesTransferred);
+                    session_->onResponseWritten(completesResponse_);
+                    promise_->resolve(closed);
+                }
+                catch (std::exception const& exc)
+                {
+                    session_->onResponseWritten(completesResponse_);
+                    promise_->fail(Error{.error = exc.what(), .additionalInfo = "Failed to send response"});
+                }
+            }
+
           private:
+            constexpr static bool isFileBody =
+                std::is_same_v<BodyT, boost::beast::http::file_body> || std::is_same_v<BodyT, RangeFileBody>;
+
             std::shared_ptr<Session> session_;
             Response<BodyT> response_;
             std::function<bool(std::size_t)> onChunk_;
             std::unique_ptr<promise::Promise> promise_;
             std::optional<std::chrono::milliseconds> overallTimeout_;
             std::unique_ptr<boost::beast::http::serializer<false, BodyT>> serializer_;
+            bool completesResponse_{false};
+            bool headRequest_{false};
+            bool zeroCopyFileWritesAllowed_{false};
         };
 
         template <typename BodyT, typename OriginalBodyT, typename... Forwards>
@@ -430,10 +720,15 @@ namespace Roar
          * @brief Utility class to build up read operations.
          *
          * @tparam BodyT The body type of this read.
+         * @tparam DecodeContent Decode bodies with a Content-Encoding while reading, see Session::readDecoded.
          */
-        template <typename BodyT>
-        class ReadIntermediate : public std::enable_shared_from_this<ReadIntermediate<BodyT>>
+        template <typename BodyT, bool DecodeContent = false>
+        class ReadIntermediate : public std::enable_shared_from_this<ReadIntermediate<BodyT, DecodeContent>>
         {
+          public:
+            using parser_type = boost::beast::http::request_parser<
+                std::conditional_t<DecodeContent, Detail::DecodingBody<BodyT>, BodyT>>;
+
           private:
             friend Session;
 
@@ -445,8 +740,7 @@ namespace Roar
                         throw std::runtime_error("Attempting to read with empty_body type.");
                     else
                     {
-                        return boost::beast::http::request_parser<BodyT>{
-                            std::move(*session.parser()), std::forward<Forwards>(forwardArgs)...};
+                        return decltype(req_){std::move(*session.parser()), std::forward<Forwards>(forwardArgs)...};
                     }
                 }()}
                 , originalExtensions_{std::move(req).ejectExtensions()}
@@ -454,7 +748,7 @@ namespace Roar
                 , promise_{}
                 , overallTimeout_{std::nullopt}
             {
-                req_.body_limit(defaultBodyLimit);
+                setBodyLimit(defaultBodyLimit);
             }
 
           public:
@@ -469,7 +763,7 @@ namespace Roar
              */
             ReadIntermediate& bodyLimit(std::size_t limit)
             {
-                req_.body_limit(limit);
+                setBodyLimit(limit);
                 return *this;
             }
 
@@ -481,7 +775,7 @@ namespace Roar
              */
             ReadIntermediate& bodyLimit(boost::beast::string_view limit)
             {
-                req_.body_limit(std::stoull(std::string{limit}));
+                setBodyLimit(std::stoull(std::string{limit}));
                 return *this;
             }
 
@@ -492,7 +786,7 @@ namespace Roar
              */
             ReadIntermediate& noBodyLimit()
             {
-                req_.body_limit(boost::none);
+                setBodyLimit(boost::none);
                 return *this;
             }
 
@@ -541,8 +835,8 @@ namespace Roar
             Detail::PromiseTypeBind<
                 Detail::PromiseTypeBindThen<
                     Detail::PromiseReferenceWrap<Session>,
-                    Detail::PromiseReferenceWrap<boost::beast::http::request_parser<BodyT> const>,
-                    std::shared_ptr<ReadIntermediate<BodyT>>>,
+                    Detail::PromiseReferenceWrap<parser_type const>,
+                    std::shared_ptr<ReadIntermediate<BodyT, DecodeContent>>>,
                 Detail::PromiseTypeBindFail<Error const&>>
             commitHeaderOnly()
             {
@@ -570,6 +864,36 @@ namespace Roar
             }
 
           private:
+            void setBodyLimit(boost::optional<std::uint64_t> limit)
+            {
+                req_.body_limit(limit);
+                // The parser limits the encoded body, the decoding body the decoded one.
+                if constexpr (DecodeContent)
+                    req_.get().body().decodedBodyLimit = limit;
+            }
+
+            /**
+             * @brief Moves the read request out of the parser.
+             */
+            boost::beast::http::request<BodyT> releaseRequest()
+            {
+                if constexpr (DecodeContent)
+                {
+                    auto request = req_.release();
+                    // The framing headers described the encoded body, make them describe the decoded one.
+                    if (const auto decodedSize = request.body().decodedSize)
+                    {
+                        request.erase(boost::beast::http::field::content_encoding);
+                        request.content_length(*decodedSize);
+                    }
+                    return boost::beast::http::request<BodyT>{
+                        std::move(request.base()),
+                        std::move(static_cast<typename BodyT::value_type&>(request.body()))};
+                }
+                else
+                    return req_.release();
+            }
+
             /**
              * @brief Reads some bytes off of the stream.
              */
@@ -591,11 +915,13 @@ namespace Roar
                                 self->session_->close();
                                 self->promise_->reject(Error{.error = ec});
                             }
+                            else
+                                self->session_->onReadComplete();
 
                             if (self->onChunk_ && !self->onChunk_(self->session_->buffer(), bytesReceived))
                                 return;
 
-                            auto request = Request<BodyT>(self->req_.release(), std::move(self->originalExtensions_));
+                            auto request = Request<BodyT>(self->releaseRequest(), std::move(self->originalExtensions_));
                             try
                             {
                                 self->promise_->resolve(Detail::ref(*self->session_), Detail::cref(request));
@@ -655,7 +981,7 @@ namespace Roar
 
           private:
             std::shared_ptr<Session> session_;
-            boost::beast::http::request_parser<BodyT> req_;
+            parser_type req_;
             Detail::RequestExtensions originalExtensions_;
             std::function<bool(boost::beast::flat_buffer&, std::size_t)> onChunk_;
             std::unique_ptr<promise::Promise> promise_;
@@ -703,6 +1029,29 @@ namespace Roar
                 new ReadIntermediate<BodyT>{*this, std::move(req), std::forward<Forwards>(forwardArgs)...});
         }
 
+        /**
+         * @brief Like read, but bodies that were sent with a Content-Encoding (gzip, deflate, br if enabled) are
+         * decoded while they are read, so that BodyT receives the decoded bytes. The decoded size counts against the
+         * body limit. Bodies with a coding that cannot be decoded fail the read. After decoding, the request has no
+         * Content-Encoding anymore and its Content-Length is the decoded size.
+         * BodyT::value_type has to be a class that can be derived from.
+         *
+         * @tparam BodyT What body type to read?
+         * @tparam OriginalBodyT Body of the request that came before the this read.
+         * @tparam Forwards
+         * @param req A request that was received
+         * @param forwardArgs
+         * @return std::shared_ptr<ReadIntermediate<BodyT, true>> A class that can be used to start the reading
+         * process and set options.
+         */
+        template <typename BodyT, typename OriginalBodyT, typename... Forwards>
+        [[nodiscard]] std::shared_ptr<ReadIntermediate<BodyT, true>>
+        readDecoded(Request<OriginalBodyT> req, Forwards&&... forwardArgs)
+        {
+            return std::shared_ptr<ReadIntermediate<BodyT, true>>(
+                new ReadIntermediate<BodyT, true>{*this, std::move(req), std::forward<Forwards>(forwardArgs)...});
+        }
+
         /**
          * @brief Prepares a response with some header values already set.
          *
@@ -811,6 +1160,16 @@ namespace Roar
         void readHeader();
         void performSslHandshake();
         bool onWriteComplete(bool expectsClose, boost::beast::error_code ec, std::size_t);
+        void onReadComplete();
+        void enqueueResponse(std::function<void()> write);
+        void onResponseWritten(bool completesRequest);
+        void dispatchRequest();
+        void routeRequest();
+        bool keepAliveAllowed() const;
+        bool isHeadRequest() const;
+        std::string_view acceptEncoding() const;
+        bool zeroCopyFileWritesAllowed() const;
+        std::optional<boost::asio::any_io_executor> fileIoExecutor() const;
         std::variant<Detail::StreamType, boost::beast::ssl_stream<Detail::StreamType>>& stream();
         std::shared_ptr<boost::beast::http::request_parser<boost::beast::http::empty_body>>& parser();
         boost::beast::flat_buffer& buffer();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <string>
+
+namespace Roar
+{
+    /**
+     * @brief Allows sessions using this context to move the TLS record layer into the kernel (kTLS) after the
+     * handshake. Encryption of responses then happens in the kernel, so file bodies can be sent with sendfile.
+     * Connections fall back to OpenSSL if the kernel lacks the tls module or the negotiated cipher is not AES-GCM.
+     * Installs a keylog and message callback on the context.
+     *
+     * @param ctx A server context.
+     */
+    void enableKernelTls(boost::asio::ssl::context& ctx);
+
+    namespace Detail
+    {
+        /**
+         * @brief Returns true if the context of this connection was prepared with enableKernelTls.
+         */
+        bool kernelTlsRequested(SSL* ssl);
+
+        struct KernelTlsOffload
+        {
+            /// If true, the socket is to be used as a plain socket and the SSL object must not be used anymore.
+            bool offloaded;
+
+            /// Plaintext OpenSSL had already decrypted. Precedes anything read afterwards.
+            std::string plaintext;
+        };
+
+        /**
+         * @brief Hands the record layer of an established connection to the kernel. Stays in userspace if the kernel
+         * or the cipher does not support it, or a partial record is buffered in OpenSSL.
+         *
+         * @param ssl The connection, after a completed handshake.
+         * @param socket The native socket handle of the connection.
+         * @throws std::system_error if the kernel only took over the sending side. The connection is unusable then.
+         */
+        KernelTlsOffload offloadTlsToKernel(SSL* ssl, int socket);
+    }
+}
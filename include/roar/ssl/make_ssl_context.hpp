@@ -1,9 +1,14 @@
 #pragma once
 
+#include <roar/ssl/kernel_tls.hpp>
+#include <roar/ssl/session_resumption.hpp>
+
 #include <boost/asio/ssl/context.hpp>
 
 #include <string>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <variant>
 
 namespace Roar
@@ -15,6 +20,15 @@ namespace Roar
         std::variant<std::string, std::filesystem::path> privateKey;
         std::string diffieHellmanParameters = "";
         std::string password = "";
+
+        /// Enables the sharded session cache and rotating session tickets. std::nullopt keeps the OpenSSL defaults.
+        std::optional<SslSessionResumptionOptions> sessionResumption = std::nullopt;
+
+        /// Created by initializeServerSslContext if sessionResumption is set. Provides the resumption counters.
+        std::shared_ptr<SslSessionResumption> sessionResumptionState = {};
+
+        /// Hands encryption to the kernel after the handshake where supported (AES-GCM on Linux). See enableKernelTls.
+        bool kernelTls = false;
     };
 
     /**
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Roar
+{
+    struct SslSessionResumptionOptions
+    {
+        /// Maximum number of sessions in the in-process session cache. 0 disables the cache.
+        std::size_t cacheSize = 20480;
+
+        /// The cache is split into this many independently locked shards to reduce contention.
+        std::size_t cacheShards = 16;
+
+        /// How long cached sessions and session tickets can be resumed.
+        std::chrono::seconds sessionLifetime = std::chrono::minutes{5};
+
+        /// Issue stateless session tickets, encrypted with keys only known to this process.
+        bool sessionTickets = true;
+
+        /// Interval after which a new ticket key is generated. Tickets of the previous key are still accepted once
+        /// and then replaced by a ticket of the current key.
+        std::chrono::seconds ticketKeyRotationInterval = std::chrono::hours{1};
+    };
+
+    struct SslSessionStatistics
+    {
+        std::uint64_t fullHandshakes = 0;
+        std::uint64_t resumedHandshakes = 0;
+        std::uint64_t cacheHits = 0;
+        std::uint64_t cacheMisses = 0;
+        std::uint64_t cachedSessions = 0;
+        std::uint64_t ticketKeyRotations = 0;
+
+        /**
+         * @brief Share of completed handshakes that resumed a session, between 0 and 1.
+         */
+        double resumptionRate() const
+        {
+            const auto total = fullHandshakes + resumedHandshakes;
+            return total == 0 ? 0. : static_cast<double>(resumedHandshakes) / static_cast<double>(total);
+        }
+    };
+
+    /**
+     * @brief Owns the session cache and the session ticket keys of an ssl context and counts resumptions.
+     */
+    class SslSessionResumption
+    {
+      public:
+        /**
+         * @brief Installs the session cache and ticket callbacks on the given context.
+         * The returned object must outlive all sessions using the context.
+         *
+         * @param ctx A server context.
+         * @param options Cache and ticket settings.
+         */
+        static std::shared_ptr<SslSessionResumption>
+        install(boost::asio::ssl::context& ctx, SslSessionResumptionOptions options);
+
+        ROAR_PIMPL_SPECIAL_FUNCTIONS_NO_MOVE(SslSessionResumption);
+
+        /**
+         * @brief Returns a snapshot of the counters.
+         */
+        SslSessionStatistics statistics() const;
+
+        /**
+         * @brief Replaces the current ticket key with a fresh one. Done automatically after the rotation interval.
+         */
+        void rotateTicketKey();
+
+      private:
+        struct Implementation;
+        SslSessionResumption(SslSessionResumptionOptions options);
+
+      private:
+        std::unique_ptr<Implementation> impl_;
+    };
+}
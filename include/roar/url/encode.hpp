@@ -1,9 +1,25 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 namespace Roar
 {
-    std::string urlEncode(const std::string& source);
-    std::string urlDecode(const std::string& source);
+    /**
+     * @brief Percent encodes every character except the unreserved ones (A-Z a-z 0-9 - . _ ~).
+     *
+     * @param source The string to encode.
+     * @param output The encoded string is appended to this.
+     */
+    void urlEncode(std::string_view source, std::string& output);
+    std::string urlEncode(std::string_view source);
+
+    /**
+     * @brief Replaces %XX escapes by their byte. '+' is left as is, malformed escapes are kept.
+     *
+     * @param source The string to decode.
+     * @param output The decoded string is appended to this.
+     */
+    void urlDecode(std::string_view source, std::string& output);
+    std::string urlDecode(std::string_view source);
 } // namespace Roar
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace Roar
+{
+    /**
+     * @brief Decodes a component of an application/x-www-form-urlencoded query. '+' becomes a space and %XX
+     * escapes are replaced by their byte. Malformed escapes are kept as they are.
+     *
+     * @param encoded The encoded key or value.
+     * @param output The decoded string is appended to this.
+     */
+    void decodeQueryComponent(std::string_view encoded, std::string& output);
+
+    /**
+     * @brief Decodes a component of an application/x-www-form-urlencoded query.
+     *
+     * @param encoded The encoded key or value.
+     * @return std::string The decoded string.
+     */
+    std::string decodeQueryComponent(std::string_view encoded);
+
+    namespace Detail
+    {
+        /**
+         * @brief Converts a decoded query value to the requested type.
+         * Supports std::string, bool ("true", "1", "false", "0"), integral and floating point types.
+         */
+        template <typename T>
+        std::optional<T> convertQueryValue(std::string_view value)
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+                return std::string{value};
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                if (value == "true" || value == "1")
+                    return true;
+                if (value == "false" || value == "0")
+                    return false;
+                return std::nullopt;
+            }
+            else
+            {
+                static_assert(
+                    std::is_integral_v<T> || std::is_floating_point_v<T>, "Unsupported query parameter type.");
+                T converted{};
+                const auto* end = value.data() + value.size();
+                const auto [ptr, ec] = std::from_chars(value.data(), end, converted);
+                if (ec != std::errc{} || ptr != end)
+                    return std::nullopt;
+                return converted;
+            }
+        }
+    }
+
+    /**
+     * @brief A parsed view of the query part of a url ("a=1&b=2;c").
+     *
+     * Splitting only records where keys and values are, nothing is copied or decoded. Decoding happens when a value
+     * is retrieved and is skipped for keys and values that contain neither '%' nor '+'.
+     * The view points into the query string, which has to outlive it.
+     */
+    class QueryView
+    {
+      public:
+        struct Parameter
+        {
+            // Both are not decoded.
+            std::string_view key;
+            std::string_view value;
+            bool keyIsEncoded;
+            bool valueIsEncoded;
+
+            std::string decodedKey() const;
+            std::string decodedValue() const;
+        };
+        using container_type = boost::container::small_vector<Parameter, 16>;
+        using const_iterator = container_type::const_iterator;
+
+        QueryView() = default;
+
+        /**
+         * @brief Splits the query into parameters. Separators are '&' and ';', empty parameters are skipped.
+         *
+         * @param query The query without the leading '?'.
+         */
+        explicit QueryView(std::string_view query);
+
+        /**
+         * @brief Returns the query string this view was created from.
+         */
+        std::string_view string() const
+        {
+            return query_;
+        }
+
+        /**
+         * @brief Returns the amount of parameters, repeated keys are counted each time.
+         */
+        std::size_t size() const
+        {
+            return parameters_.size();
+        }
+
+        bool empty() const
+        {
+            return parameters_.empty();
+        }
+
+        const_iterator begin() const
+        {
+            return parameters_.begin();
+        }
+
+        const_iterator end() const
+        {
+            return parameters_.end();
+        }
+
+        /**
+         * @brief Returns true if there is a parameter with the given (decoded) key.
+         */
+        bool contains(std::string_view key) const
+        {
+            return find(key) != nullptr;
+        }
+
+        /**
+         * @brief Finds the last parameter with the given decoded key.
+         *
+         * @return Parameter const* The parameter or nullptr.
+         */
+        Parameter const* find(std::string_view key) const;
+
+        /**
+         * @brief Retrieves the value of a parameter. If the key is repeated, the last value wins.
+         *
+         * @tparam T std::string (default, decoded), std::string_view (not decoded), bool, integral or floating point.
+         * @param key The decoded key.
+         * @return std::optional<T> The value or nullopt if there is no such parameter or it cannot be converted.
+         */
+        template <typename T = std::string>
+        std::optional<T> get(std::string_view key) const
+        {
+            auto const* parameter = find(key);
+            if (parameter == nullptr)
+                return std::nullopt;
+            return convert<T>(*parameter);
+        }
+
+        /**
+         * @brief Retrieves all values of a repeated parameter in order of appearance ("id=1&id=2").
+         *
+         * @tparam T See get. Values that cannot be converted are left out.
+         * @param key The decoded key.
+         * @return std::vector<T> The values, empty if there is no such parameter.
+         */
+        template <typename T = std::string>
+        std::vector<T> getAll(std::string_view key) const
+        {
+            std::vector<T> values;
+            for (auto const& parameter : parameters_)
+            {
+                if (!keyEquals(parameter, key))
+                    continue;
+                if (auto value = convert<T>(parameter); value)
+                    values.push_back(std::move(*value));
+            }
+            return values;
+        }
+
+      private:
+        static bool keyEquals(Parameter const& parameter, std::string_view key);
+
+        template <typename T>
+        static std::optional<T> convert(Parameter const& parameter)
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+                return parameter.value;
+            else if constexpr (std::is_same_v<T, std::string>)
+                return parameter.decodedValue();
+            else
+            {
+                if (!parameter.valueIsEncoded)
+                    return Detail::convertQueryValue<T>(parameter.value);
+                return Detail::convertQueryValue<T>(parameter.decodedValue());
+            }
+        }
+
+      private:
+        std::string_view query_{};
+        container_type parameters_{};
+    };
+}
@@ -4,6 +4,7 @@
 
 #include <string>
 #include <chrono>
+#include <optional>
 
 namespace Roar
 {
@@ -23,6 +24,12 @@ namespace Roar
          */
         date();
 
+        /**
+         *  Parses a date in the format specified in RFC 2616 Section 3.3.1 (rfc1123-date), as in "Last-Modified" or
+         *  "If-Modified-Since" headers.
+         */
+        static std::optional<date> fromGmtString(std::string const& str);
+
         /**
          *  Returns a reference to the contained time point.
          *  Meant to be modified using STL means and ways. No need to reimplement the stuff here.
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <roar/detail/pimpl_special_functions.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace Roar
+{
+    /**
+     * @brief A set of single threaded io_contexts, each run by a dedicated thread.
+     * Handlers posted to one of the executors always run on the same thread, so no strands are needed for them.
+     */
+    class IoContextPool
+    {
+      public:
+        struct ConstructionArguments
+        {
+            /// Amount of io_contexts and threads. 0 means one per hardware thread.
+            std::size_t threadCount = 0;
+
+            /// Pin thread i to cpu i (modulo the cpu count). Only supported on linux, ignored elsewhere.
+            bool pinThreads = false;
+        };
+
+        /**
+         * @brief Creates the io_contexts and starts running them.
+         *
+         * @param constructionArgs Options for the pool.
+         */
+        IoContextPool(ConstructionArguments constructionArgs);
+        ROAR_PIMPL_SPECIAL_FUNCTIONS(IoContextPool);
+
+        /**
+         * @brief Returns the amount of io_contexts in this pool.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Returns the executor of the io_context at the given index.
+         *
+         * @param index An index smaller than size().
+         */
+        boost::asio::any_io_executor executor(std::size_t index) const;
+
+        /**
+         * @brief Stops all io_contexts and joins their threads. Handlers that did not run yet are destroyed with
+         * the pool. When called from a pool thread, that thread is detached instead and keeps its io_context until
+         * the current handler returns, so the pool may be destroyed from within one of its handlers.
+         */
+        void stop();
+
+      private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+}
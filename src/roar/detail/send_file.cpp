@@ -0,0 +1,188 @@
+#include <roar/detail/send_file.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/error.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#ifdef __linux__
+#    include <cerrno>
+#    include <sys/sendfile.h>
+#endif
+
+namespace Roar::Detail
+{
+    namespace
+    {
+        /// Upper bound of bytes sent before yielding to other handlers on the same executor.
+        constexpr std::uint64_t maxBytesPerTurn = 16 * 1024 * 1024;
+
+        class SendFileOperation : public std::enable_shared_from_this<SendFileOperation>
+        {
+          public:
+            SendFileOperation(
+                StreamType& stream,
+                int fileDescriptor,
+                std::vector<SendFileSegment> segments,
+                std::chrono::milliseconds idleTimeout,
+                std::function<void(boost::system::error_code, std::uint64_t)> onComplete)
+                : stream_{stream}
+                , fileDescriptor_{fileDescriptor}
+                , segments_{std::move(segments)}
+                , current_{0}
+                , bytesSent_{0}
+                , idleTimeout_{idleTimeout}
+                , timer_{stream.get_executor()}
+                , waitId_{0}
+                , timedOut_{false}
+                , onComplete_{std::move(onComplete)}
+            {}
+            ~SendFileOperation() = default;
+            SendFileOperation(SendFileOperation const&) = delete;
+            SendFileOperation(SendFileOperation&&) = delete;
+            SendFileOperation& operator=(SendFileOperation const&) = delete;
+            SendFileOperation& operator=(SendFileOperation&&) = delete;
+
+            void nextSegment()
+            {
+                if (current_ == segments_.size())
+                    return complete({});
+
+                auto& segment = segments_[current_];
+                if (!segment.prefix.empty())
+                {
+                    stream_.expires_after(idleTimeout_);
+                    boost::asio::async_write(
+                        stream_,
+                        boost::asio::buffer(segment.prefix),
+                        [self = shared_from_this()](boost::system::error_code ec, std::size_t bytesTransferred) {
+                            self->bytesSent_ += bytesTransferred;
+                            if (ec)
+                                return self->complete(ec);
+                            self->segments_[self->current_].prefix.clear();
+                            self->nextSegment();
+                        });
+                    return;
+                }
+                sendSome();
+            }
+
+          private:
+            void sendSome()
+            {
+#ifdef __linux__
+                auto& segment = segments_[current_];
+                auto& socket = stream_.socket();
+                boost::system::error_code ec;
+                socket.native_non_blocking(true, ec);
+                if (ec)
+                    return complete(ec);
+
+                std::uint64_t sentThisTurn = 0;
+                while (segment.length > 0)
+                {
+                    if (sentThisTurn >= maxBytesPerTurn)
+                    {
+                        boost::asio::post(stream_.get_executor(), [self = shared_from_this()]() {
+                            self->sendSome();
+                        });
+                        return;
+                    }
+
+                    auto offset = static_cast<off_t>(segment.offset);
+                    const auto result = ::sendfile(
+                        socket.native_handle(),
+                        fileDescriptor_,
+                        &offset,
+                        static_cast<std::size_t>(std::min(segment.length, maxBytesPerTurn)));
+                    if (result > 0)
+                    {
+                        const auto sent = static_cast<std::uint64_t>(result);
+                        segment.offset += sent;
+                        segment.length -= sent;
+                        bytesSent_ += sent;
+                        sentThisTurn += sent;
+                        continue;
+                    }
+                    if (result == 0)
+                        return complete(boost::beast::http::error::short_read);
+                    if (errno == EINTR)
+                        continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK)
+                        return awaitWritable();
+                    return complete({errno, boost::system::system_category()});
+                }
+
+                ++current_;
+                nextSegment();
+#else
+                complete(boost::asio::error::operation_not_supported);
+#endif
+            }
+
+            void awaitWritable()
+            {
+                // Cancelling the timer does not stop a handler that already expired and is queued, so each wait
+                // gets an id that the timer handler has to match before it may cancel the socket.
+                const auto waitId = ++waitId_;
+                timedOut_ = false;
+                timer_.expires_after(idleTimeout_);
+                timer_.async_wait([weak = weak_from_this(), waitId](boost::system::error_code ec) {
+                    auto self = weak.lock();
+                    if (ec || !self || self->waitId_ != waitId)
+                        return;
+                    self->timedOut_ = true;
+                    boost::system::error_code ignored;
+                    self->stream_.socket().cancel(ignored);
+                });
+                stream_.socket().async_wait(
+                    boost::asio::ip::tcp::socket::wait_write,
+                    [self = shared_from_this()](boost::system::error_code ec) {
+                        ++self->waitId_;
+                        self->timer_.cancel();
+                        if (self->timedOut_)
+                            return self->complete(boost::beast::error::timeout);
+                        if (ec)
+                            return self->complete(ec);
+                        self->sendSome();
+                    });
+            }
+
+            void complete(boost::system::error_code ec)
+            {
+                if (onComplete_)
+                    std::exchange(onComplete_, {})(ec, bytesSent_);
+            }
+
+          private:
+            StreamType& stream_;
+            int fileDescriptor_;
+            std::vector<SendFileSegment> segments_;
+            std::size_t current_;
+            std::uint64_t bytesSent_;
+            std::chrono::milliseconds idleTimeout_;
+            boost::asio::steady_timer timer_;
+            std::uint64_t waitId_;
+            bool timedOut_;
+            std::function<void(boost::system::error_code, std::uint64_t)> onComplete_;
+        };
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void asyncSendFile(
+        StreamType& stream,
+        int fileDescriptor,
+        std::vector<SendFileSegment> segments,
+        std::chrono::milliseconds idleTimeout,
+        std::function<void(boost::system::error_code, std::uint64_t)> onComplete)
+    {
+        auto operation = std::make_shared<SendFileOperation>(
+            stream, fileDescriptor, std::move(segments), idleTimeout, std::move(onComplete));
+        operation->nextSegment();
+    }
+}
@@ -0,0 +1,149 @@
+#include <roar/filesystem/file_cache.hpp>
+#include <roar/mime_type.hpp>
+
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#ifndef _WIN32
+#    include <sys/stat.h>
+#endif
+
+namespace Roar
+{
+    namespace
+    {
+        std::string makeEtag(
+            [[maybe_unused]] std::filesystem::path const& file,
+            std::filesystem::file_time_type lastWriteTime,
+            std::uint64_t size)
+        {
+            std::stringstream etag;
+            etag << std::hex << '"';
+#ifndef _WIN32
+            struct stat fileStat
+            {};
+            if (::stat(file.c_str(), &fileStat) == 0)
+                etag << fileStat.st_ino << '-';
+#endif
+            etag << lastWriteTime.time_since_epoch().count() << '-' << size << '"';
+            return etag.str();
+        }
+    }
+    // ##################################################################################################################
+    CachedFile describeFile(std::filesystem::path file, std::filesystem::path relative)
+    {
+        std::error_code ec;
+        auto status = std::filesystem::status(file, ec);
+        if (ec || !std::filesystem::exists(status))
+            status = std::filesystem::file_status{};
+
+        CachedFile cached{};
+        if (status.type() == std::filesystem::file_type::regular)
+        {
+            cached.size = std::filesystem::file_size(file, ec);
+            cached.lastWriteTime = std::filesystem::last_write_time(file, ec);
+            cached.contentType = extensionToMime(file.extension().string());
+            cached.etag = makeEtag(file, cached.lastWriteTime, cached.size);
+        }
+        cached.fileAndStatus = {.file = std::move(file), .relative = std::move(relative), .status = status};
+        return cached;
+    }
+    // ##################################################################################################################
+    struct FileCache::Implementation
+    {
+        struct Entry
+        {
+            std::string key;
+            std::shared_ptr<CachedFile const> file;
+            std::chrono::steady_clock::time_point cachedAt;
+        };
+
+        FileCacheOptions options;
+        mutable std::mutex guard;
+        // Most recently used first.
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        // Bumped by invalidate and clear, so that lookups that started before do not cache stale results.
+        std::uint64_t generation;
+
+        Implementation(FileCacheOptions options)
+            : options{std::move(options)}
+            , guard{}
+            , entries{}
+            , index{}
+            , generation{0}
+        {}
+
+        void erase(std::unordered_map<std::string, std::list<Entry>::iterator>::iterator iter)
+        {
+            entries.erase(iter->second);
+            index.erase(iter);
+        }
+    };
+    // ##################################################################################################################
+    FileCache::FileCache(FileCacheOptions options)
+        : impl_{std::make_unique<Implementation>(std::move(options))}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(FileCache);
+    //------------------------------------------------------------------------------------------------------------------
+    std::shared_ptr<CachedFile const> FileCache::get(std::string const& key, std::function<CachedFile()> const& lookup)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::uint64_t generation = 0;
+        {
+            std::scoped_lock lock{impl_->guard};
+            generation = impl_->generation;
+            if (auto iter = impl_->index.find(key); iter != std::end(impl_->index))
+            {
+                if (now - iter->second->cachedAt < impl_->options.timeToLive)
+                {
+                    impl_->entries.splice(std::begin(impl_->entries), impl_->entries, iter->second);
+                    return iter->second->file;
+                }
+                impl_->erase(iter);
+            }
+        }
+
+        auto file = std::make_shared<CachedFile const>(lookup());
+        if (impl_->options.capacity == 0)
+            return file;
+
+        std::scoped_lock lock{impl_->guard};
+        if (impl_->generation != generation)
+            return file;
+        if (auto iter = impl_->index.find(key); iter != std::end(impl_->index))
+            impl_->erase(iter);
+        impl_->entries.push_front({.key = key, .file = file, .cachedAt = now});
+        impl_->index.emplace(key, std::begin(impl_->entries));
+        while (impl_->entries.size() > impl_->options.capacity)
+            impl_->erase(impl_->index.find(impl_->entries.back().key));
+        return file;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void FileCache::invalidate(std::string const& key)
+    {
+        std::scoped_lock lock{impl_->guard};
+        ++impl_->generation;
+        if (auto iter = impl_->index.find(key); iter != std::end(impl_->index))
+            impl_->erase(iter);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void FileCache::clear()
+    {
+        std::scoped_lock lock{impl_->guard};
+        ++impl_->generation;
+        impl_->index.clear();
+        impl_->entries.clear();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::size_t FileCache::size() const
+    {
+        std::scoped_lock lock{impl_->guard};
+        return impl_->entries.size();
+    }
+    // ##################################################################################################################
+}
@@ -0,0 +1,393 @@
+#include <roar/mechanics/compression.hpp>
+#include <roar/mechanics/content_encoding.hpp>
+
+#include <zlib.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#ifdef ROAR_ENABLE_BROTLI
+#    include <brotli/decode.h>
+#    include <brotli/encode.h>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Roar
+{
+    namespace
+    {
+        constexpr std::size_t outputStep = 16 * 1024;
+
+        class Coder
+        {
+          public:
+            virtual ~Coder() = default;
+            virtual bool compress(std::string_view input, bool finish, std::string& output) = 0;
+        };
+
+        class ZlibCoder : public Coder
+        {
+          public:
+            ZlibCoder(ContentCoding coding, int level)
+                : stream_{}
+            {
+                // 15 + 16 makes zlib write a gzip header and trailer instead of the zlib ones.
+                const int windowBits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+                if (deflateInit2(
+                        &stream_,
+                        level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, 9),
+                        Z_DEFLATED,
+                        windowBits,
+                        8,
+                        Z_DEFAULT_STRATEGY) != Z_OK)
+                {
+                    throw std::runtime_error("Cannot initialize zlib compression.");
+                }
+            }
+            ~ZlibCoder() override
+            {
+                deflateEnd(&stream_);
+            }
+            ZlibCoder(ZlibCoder const&) = delete;
+            ZlibCoder& operator=(ZlibCoder const&) = delete;
+
+            bool compress(std::string_view input, bool finish, std::string& output) override
+            {
+                // zlib does not write through next_in.
+                stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream_.avail_in = static_cast<uInt>(input.size());
+                while (true)
+                {
+                    const auto previousSize = output.size();
+                    output.resize(previousSize + outputStep);
+                    stream_.next_out = reinterpret_cast<Bytef*>(output.data() + previousSize);
+                    stream_.avail_out = static_cast<uInt>(outputStep);
+                    const auto result = deflate(&stream_, finish ? Z_FINISH : Z_NO_FLUSH);
+                    output.resize(previousSize + outputStep - stream_.avail_out);
+
+                    if (result == Z_STREAM_ERROR)
+                        return false;
+                    if (finish ? result == Z_STREAM_END : stream_.avail_out != 0)
+                        return true;
+                }
+            }
+
+          private:
+            z_stream stream_;
+        };
+
+#ifdef ROAR_ENABLE_BROTLI
+        class BrotliCoder : public Coder
+        {
+          public:
+            BrotliCoder(int level)
+                : state_{BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)}
+            {
+                if (!state_)
+                    throw std::runtime_error("Cannot initialize brotli compression.");
+                // The brotli default of 11 is meant for static content, not for compressing on the fly.
+                BrotliEncoderSetParameter(
+                    state_,
+                    BROTLI_PARAM_QUALITY,
+                    static_cast<std::uint32_t>(level < 0 ? 5 : std::min(level, BROTLI_MAX_QUALITY)));
+            }
+            ~BrotliCoder() override
+            {
+                BrotliEncoderDestroyInstance(state_);
+            }
+            BrotliCoder(BrotliCoder const&) = delete;
+            BrotliCoder& operator=(BrotliCoder const&) = delete;
+
+            bool compress(std::string_view input, bool finish, std::string& output) override
+            {
+                auto availableIn = input.size();
+                auto const* nextIn = reinterpret_cast<std::uint8_t const*>(input.data());
+                while (true)
+                {
+                    const auto previousSize = output.size();
+                    output.resize(previousSize + outputStep);
+                    std::size_t availableOut = outputStep;
+                    auto* nextOut = reinterpret_cast<std::uint8_t*>(output.data() + previousSize);
+                    const auto result = BrotliEncoderCompressStream(
+                        state_,
+                        finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_PROCESS,
+                        &availableIn,
+                        &nextIn,
+                        &availableOut,
+                        &nextOut,
+                        nullptr);
+                    output.resize(previousSize + outputStep - availableOut);
+
+                    if (!result)
+                        return false;
+                    if (availableIn == 0 && !BrotliEncoderHasMoreOutput(state_) &&
+                        (!finish || BrotliEncoderIsFinished(state_)))
+                        return true;
+                }
+            }
+
+          private:
+            BrotliEncoderState* state_;
+        };
+#endif
+
+        class Decoder
+        {
+          public:
+            virtual ~Decoder() = default;
+            virtual bool decompress(std::string_view& input, std::string& output, std::size_t maxOutput) = 0;
+            virtual bool finished() const = 0;
+        };
+
+        class ZlibDecoder : public Decoder
+        {
+          public:
+            ZlibDecoder(ContentCoding coding)
+                : stream_{}
+                , finished_{false}
+            {
+                // 15 + 16 expects a gzip header. Deflate in HTTP is the zlib format, not raw deflate.
+                if (inflateInit2(&stream_, coding == ContentCoding::Gzip ? 15 + 16 : 15) != Z_OK)
+                    throw std::runtime_error("Cannot initialize zlib decompression.");
+            }
+            ~ZlibDecoder() override
+            {
+                inflateEnd(&stream_);
+            }
+            ZlibDecoder(ZlibDecoder const&) = delete;
+            ZlibDecoder& operator=(ZlibDecoder const&) = delete;
+
+            bool decompress(std::string_view& input, std::string& output, std::size_t maxOutput) override
+            {
+                if (finished_)
+                    return input.empty();
+
+                const auto previousSize = output.size();
+                output.resize(previousSize + maxOutput);
+                stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream_.avail_in = static_cast<uInt>(input.size());
+                stream_.next_out = reinterpret_cast<Bytef*>(output.data() + previousSize);
+                stream_.avail_out = static_cast<uInt>(maxOutput);
+                const auto result = inflate(&stream_, Z_NO_FLUSH);
+                input.remove_prefix(input.size() - stream_.avail_in);
+                output.resize(previousSize + maxOutput - stream_.avail_out);
+
+                if (result == Z_STREAM_END)
+                {
+                    finished_ = true;
+                    return input.empty();
+                }
+                return result == Z_OK || result == Z_BUF_ERROR;
+            }
+
+            bool finished() const override
+            {
+                return finished_;
+            }
+
+          private:
+            z_stream stream_;
+            bool finished_;
+        };
+
+#ifdef ROAR_ENABLE_BROTLI
+        class BrotliDecoder : public Decoder
+        {
+          public:
+            BrotliDecoder()
+                : state_{BrotliDecoderCreateInstance(nullptr, nullptr, nullptr)}
+                , finished_{false}
+            {
+                if (!state_)
+                    throw std::runtime_error("Cannot initialize brotli decompression.");
+            }
+            ~BrotliDecoder() override
+            {
+                BrotliDecoderDestroyInstance(state_);
+            }
+            BrotliDecoder(BrotliDecoder const&) = delete;
+            BrotliDecoder& operator=(BrotliDecoder const&) = delete;
+
+            bool decompress(std::string_view& input, std::string& output, std::size_t maxOutput) override
+            {
+                if (finished_)
+                    return input.empty();
+
+                const auto previousSize = output.size();
+                output.resize(previousSize + maxOutput);
+                auto availableIn = input.size();
+                auto const* nextIn = reinterpret_cast<std::uint8_t const*>(input.data());
+                std::size_t availableOut = maxOutput;
+                auto* nextOut = reinterpret_cast<std::uint8_t*>(output.data() + previousSize);
+                const auto result = BrotliDecoderDecompressStream(
+                    state_, &availableIn, &nextIn, &availableOut, &nextOut, nullptr);
+                input.remove_prefix(input.size() - availableIn);
+                output.resize(previousSize + maxOutput - availableOut);
+
+                if (result == BROTLI_DECODER_RESULT_SUCCESS)
+                {
+                    finished_ = true;
+                    return input.empty();
+                }
+                return result != BROTLI_DECODER_RESULT_ERROR;
+            }
+
+            bool finished() const override
+            {
+                return finished_;
+            }
+
+          private:
+            BrotliDecoderState* state_;
+            bool finished_;
+        };
+#endif
+    }
+    // ##################################################################################################################
+    std::string_view contentCodingName(ContentCoding coding)
+    {
+        switch (coding)
+        {
+            case ContentCoding::Gzip:
+                return "gzip";
+            case ContentCoding::Deflate:
+                return "deflate";
+            case ContentCoding::Brotli:
+                return "br";
+            default:
+                return "identity";
+        }
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::optional<ContentCoding> parseContentCoding(std::string_view contentEncoding)
+    {
+        const auto first = contentEncoding.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+            return ContentCoding::Identity;
+        contentEncoding = contentEncoding.substr(first, contentEncoding.find_last_not_of(" \t") - first + 1);
+
+        if (boost::algorithm::iequals(contentEncoding, "identity"))
+            return ContentCoding::Identity;
+        if (boost::algorithm::iequals(contentEncoding, "gzip") || boost::algorithm::iequals(contentEncoding, "x-gzip"))
+            return ContentCoding::Gzip;
+        if (boost::algorithm::iequals(contentEncoding, "deflate"))
+            return ContentCoding::Deflate;
+        if (boost::algorithm::iequals(contentEncoding, "br"))
+            return ContentCoding::Brotli;
+        return std::nullopt;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::vector<ContentCoding> const& supportedContentCodings()
+    {
+        static const std::vector<ContentCoding> codings = {
+#ifdef ROAR_ENABLE_BROTLI
+            ContentCoding::Brotli,
+#endif
+            ContentCoding::Gzip,
+            ContentCoding::Deflate,
+        };
+        return codings;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    ContentCoding selectCompression(
+        CompressionOptions const& options,
+        std::string_view acceptEncoding,
+        std::string_view contentType,
+        std::optional<std::uint64_t> size)
+    {
+        if (size && *size < options.minimumSize)
+            return ContentCoding::Identity;
+
+        contentType = contentType.substr(0, contentType.find(';'));
+        const bool compressible = std::any_of(
+            std::begin(options.contentTypes), std::end(options.contentTypes), [contentType](auto const& type) {
+                return contentType.starts_with(type);
+            });
+        if (!compressible)
+            return ContentCoding::Identity;
+
+        auto const& codings = supportedContentCodings();
+        std::vector<std::string_view> offered;
+        offered.reserve(codings.size());
+        for (auto coding : codings)
+            offered.push_back(contentCodingName(coding));
+
+        const auto chosen = negotiateContentEncoding(acceptEncoding, offered);
+        if (!chosen)
+            return ContentCoding::Identity;
+        return codings[static_cast<std::size_t>(
+            std::find(std::begin(offered), std::end(offered), *chosen) - std::begin(offered))];
+    }
+    // ##################################################################################################################
+    struct StreamCompressor::Implementation
+    {
+        std::unique_ptr<Coder> coder;
+
+        Implementation(ContentCoding coding, int level)
+            : coder{[coding, level]() -> std::unique_ptr<Coder> {
+                switch (coding)
+                {
+                    case ContentCoding::Gzip:
+                    case ContentCoding::Deflate:
+                        return std::make_unique<ZlibCoder>(coding, level);
+#ifdef ROAR_ENABLE_BROTLI
+                    case ContentCoding::Brotli:
+                        return std::make_unique<BrotliCoder>(level);
+#endif
+                    default:
+                        throw std::invalid_argument("Content coding is not supported for compression.");
+                }
+            }()}
+        {}
+    };
+    // ##################################################################################################################
+    StreamCompressor::StreamCompressor(ContentCoding coding, int level)
+        : impl_{std::make_unique<Implementation>(coding, level)}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(StreamCompressor);
+    //------------------------------------------------------------------------------------------------------------------
+    bool StreamCompressor::compress(std::string_view input, bool finish, std::string& output)
+    {
+        return impl_->coder->compress(input, finish, output);
+    }
+    // ##################################################################################################################
+    struct StreamDecompressor::Implementation
+    {
+        std::unique_ptr<Decoder> decoder;
+
+        Implementation(ContentCoding coding)
+            : decoder{[coding]() -> std::unique_ptr<Decoder> {
+                switch (coding)
+                {
+                    case ContentCoding::Gzip:
+                    case ContentCoding::Deflate:
+                        return std::make_unique<ZlibDecoder>(coding);
+#ifdef ROAR_ENABLE_BROTLI
+                    case ContentCoding::Brotli:
+                        return std::make_unique<BrotliDecoder>();
+#endif
+                    default:
+                        throw std::invalid_argument("Content coding is not supported for decompression.");
+                }
+            }()}
+        {}
+    };
+    // ##################################################################################################################
+    StreamDecompressor::StreamDecompressor(ContentCoding coding)
+        : impl_{std::make_unique<Implementation>(coding)}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(StreamDecompressor);
+    //------------------------------------------------------------------------------------------------------------------
+    bool StreamDecompressor::decompress(std::string_view& input, std::string& output, std::size_t maxOutput)
+    {
+        return impl_->decoder->decompress(input, output, maxOutput);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool StreamDecompressor::finished() const
+    {
+        return impl_->decoder->finished();
+    }
+}
@@ -0,0 +1,89 @@
+#include <roar/mechanics/content_encoding.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+namespace Roar
+{
+    namespace
+    {
+        std::string_view trim(std::string_view view)
+        {
+            const auto first = view.find_first_not_of(" \t");
+            if (first == std::string_view::npos)
+                return {};
+            const auto last = view.find_last_not_of(" \t");
+            return view.substr(first, last - first + 1);
+        }
+
+        /**
+         * @brief Returns the weight of the q parameter in per mille, 1000 if there is none.
+         */
+        int parseQuality(std::string_view parameters)
+        {
+            while (!parameters.empty())
+            {
+                const auto semicolon = parameters.find(';');
+                const auto parameter = trim(parameters.substr(0, semicolon));
+                if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=')
+                {
+                    double quality = 0.;
+                    const auto value = parameter.substr(2);
+                    const auto result = std::from_chars(value.data(), value.data() + value.size(), quality);
+                    if (result.ec != std::errc{})
+                        return 0;
+                    return static_cast<int>(std::clamp(quality, 0., 1.) * 1000. + 0.5);
+                }
+                if (semicolon == std::string_view::npos)
+                    break;
+                parameters.remove_prefix(semicolon + 1);
+            }
+            return 1000;
+        }
+    }
+    // ##################################################################################################################
+    std::optional<std::string_view>
+    negotiateContentEncoding(std::string_view acceptEncoding, std::vector<std::string_view> const& offered)
+    {
+        // -1 = not mentioned.
+        std::vector<int> qualities(offered.size(), -1);
+        int wildcardQuality = -1;
+
+        while (!acceptEncoding.empty())
+        {
+            const auto comma = acceptEncoding.find(',');
+            const auto element = acceptEncoding.substr(0, comma);
+            const auto semicolon = element.find(';');
+            const auto coding = trim(element.substr(0, semicolon));
+            const auto quality =
+                semicolon == std::string_view::npos ? 1000 : parseQuality(element.substr(semicolon + 1));
+
+            if (coding == "*")
+                wildcardQuality = quality;
+            for (std::size_t i = 0; i != offered.size(); ++i)
+            {
+                if (boost::algorithm::iequals(coding, offered[i]))
+                    qualities[i] = quality;
+            }
+
+            if (comma == std::string_view::npos)
+                break;
+            acceptEncoding.remove_prefix(comma + 1);
+        }
+
+        std::optional<std::string_view> best = std::nullopt;
+        int bestQuality = 0;
+        for (std::size_t i = 0; i != offered.size(); ++i)
+        {
+            const auto quality = qualities[i] == -1 ? wildcardQuality : qualities[i];
+            if (quality > bestQuality)
+            {
+                best = offered[i];
+                bestQuality = quality;
+            }
+        }
+        return best;
+    }
+}
@@ -0,0 +1,43 @@
+#include <roar/mechanics/entity_tag.hpp>
+
+namespace Roar
+{
+    namespace
+    {
+        std::string_view trim(std::string_view view)
+        {
+            const auto first = view.find_first_not_of(" \t");
+            if (first == std::string_view::npos)
+                return {};
+            const auto last = view.find_last_not_of(" \t");
+            return view.substr(first, last - first + 1);
+        }
+
+        std::string_view opaqueTag(std::string_view entityTag)
+        {
+            if (entityTag.starts_with("W/"))
+                entityTag.remove_prefix(2);
+            return entityTag;
+        }
+    }
+    // ##################################################################################################################
+    bool entityTagListMatches(std::string_view entityTagList, std::string_view entityTag)
+    {
+        if (entityTag.empty())
+            return false;
+        if (trim(entityTagList) == "*")
+            return true;
+
+        const auto tag = opaqueTag(entityTag);
+        while (!entityTagList.empty())
+        {
+            const auto comma = entityTagList.find(',');
+            if (opaqueTag(trim(entityTagList.substr(0, comma))) == tag)
+                return true;
+            if (comma == std::string_view::npos)
+                break;
+            entityTagList.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+}
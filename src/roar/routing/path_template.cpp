@@ -0,0 +1,174 @@
+#include <roar/routing/path_template.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace Roar
+{
+    namespace
+    {
+        PathParameterType parseParameterType(std::string_view type)
+        {
+            if (type.empty() || type == "string")
+                return PathParameterType::String;
+            if (type == "int")
+                return PathParameterType::Int;
+            if (type == "uint")
+                return PathParameterType::Uint;
+            if (type == "uuid")
+                return PathParameterType::Uuid;
+            throw std::runtime_error{"Unknown path parameter type: " + std::string{type}};
+        }
+
+        bool allDigits(std::string_view segment)
+        {
+            return !segment.empty() && std::all_of(std::begin(segment), std::end(segment), [](char c) {
+                return c >= '0' && c <= '9';
+            });
+        }
+
+        bool isUuid(std::string_view segment)
+        {
+            if (segment.size() != 36)
+                return false;
+            for (std::size_t i = 0; i != segment.size(); ++i)
+            {
+                if (i == 8 || i == 13 || i == 18 || i == 23)
+                {
+                    if (segment[i] != '-')
+                        return false;
+                }
+                else if (!std::isxdigit(static_cast<unsigned char>(segment[i])))
+                    return false;
+            }
+            return true;
+        }
+
+        template <typename FunctionT>
+        bool forEachSegment(std::string_view path, FunctionT&& func)
+        {
+            if (!path.starts_with('/'))
+                return false;
+            path.remove_prefix(1);
+            while (true)
+            {
+                const auto slash = path.find('/');
+                if (!func(path.substr(0, slash)))
+                    return false;
+                if (slash == std::string_view::npos)
+                    return true;
+                path.remove_prefix(slash + 1);
+            }
+        }
+
+        bool isIdentifier(std::string_view text)
+        {
+            return !text.empty() && std::all_of(std::begin(text), std::end(text), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+            });
+        }
+
+        bool isParameterSegment(std::string_view segment)
+        {
+            if (segment.size() < 3 || !segment.starts_with('{') || !segment.ends_with('}'))
+                return false;
+            segment = segment.substr(1, segment.size() - 2);
+            const auto colon = segment.find(':');
+            if (!isIdentifier(segment.substr(0, colon)))
+                return false;
+            return colon == std::string_view::npos || isIdentifier(segment.substr(colon + 1));
+        }
+    }
+    //##################################################################################################################
+    PathTemplate::PathTemplate(std::string_view path)
+        : segments_{}
+        , parameterCount_{0}
+    {
+        const auto valid = forEachSegment(path, [this](std::string_view segment) {
+            if (!segment.starts_with('{'))
+            {
+                if (segment.find_first_of("{}") != std::string_view::npos)
+                    throw std::runtime_error{"Path parameters must span a whole segment."};
+                segments_.push_back(Segment{.text = std::string{segment}, .parameterType = std::nullopt});
+                return true;
+            }
+
+            if (!segment.ends_with('}'))
+                throw std::runtime_error{"Path parameters must span a whole segment."};
+            segment = segment.substr(1, segment.size() - 2);
+            const auto colon = segment.find(':');
+            const auto name = segment.substr(0, colon);
+            if (name.empty())
+                throw std::runtime_error{"Path parameters must have a name."};
+            if (parameterIndex(name))
+                throw std::runtime_error{"Duplicate path parameter: " + std::string{name}};
+            if (++parameterCount_ > maxPathParameters)
+                throw std::runtime_error{"Too many path parameters."};
+
+            segments_.push_back(Segment{
+                .text = std::string{name},
+                .parameterType = parseParameterType(
+                    colon == std::string_view::npos ? std::string_view{} : segment.substr(colon + 1)),
+            });
+            return true;
+        });
+        if (!valid)
+            throw std::runtime_error{"Path templates must start with '/'."};
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool PathTemplate::isTemplate(std::string_view path)
+    {
+        bool hasParameter = false;
+        forEachSegment(path, [&hasParameter](std::string_view segment) {
+            hasParameter = isParameterSegment(segment);
+            return !hasParameter;
+        });
+        return hasParameter;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool PathTemplate::segmentMatches(PathParameterType type, std::string_view segment)
+    {
+        switch (type)
+        {
+            case (PathParameterType::String):
+                return !segment.empty();
+            case (PathParameterType::Int):
+                return allDigits(segment.starts_with('-') ? segment.substr(1) : segment);
+            case (PathParameterType::Uint):
+                return allDigits(segment);
+            case (PathParameterType::Uuid):
+                return isUuid(segment);
+        }
+        return false;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool PathTemplate::matches(std::string_view path) const
+    {
+        std::size_t index = 0;
+        const auto allMatched = forEachSegment(path, [this, &index](std::string_view segment) {
+            if (index == segments_.size())
+                return false;
+            auto const& expected = segments_[index++];
+            if (expected.parameterType)
+                return segmentMatches(*expected.parameterType, segment);
+            return expected.text == segment;
+        });
+        return allMatched && index == segments_.size();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::optional<std::size_t> PathTemplate::parameterIndex(std::string_view name) const
+    {
+        std::size_t index = 0;
+        for (auto const& segment : segments_)
+        {
+            if (!segment.parameterType)
+                continue;
+            if (segment.text == name)
+                return index;
+            ++index;
+        }
+        return std::nullopt;
+    }
+    //##################################################################################################################
+}
@@ -0,0 +1,192 @@
+#include <roar/routing/regex_route_matcher.hpp>
+#include <roar/routing/route.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <unordered_map>
+
+namespace Roar
+{
+    namespace
+    {
+        constexpr std::string_view regexOperators = "^$.|?*+()[]{}";
+        constexpr std::string_view quantifiers = "?*+{";
+
+        struct PrefixNode
+        {
+            // Sorted by character.
+            std::vector<std::pair<char, std::unique_ptr<PrefixNode>>> children{};
+            // Indices of the routes whose literal prefix ends at this node.
+            std::vector<std::size_t> routes{};
+
+            template <typename ChildrenT>
+            static auto findChild(ChildrenT& children, char c)
+            {
+                return std::lower_bound(std::begin(children), std::end(children), c, [](auto const& entry, char value) {
+                    return entry.first < value;
+                });
+            }
+
+            PrefixNode& child(char c)
+            {
+                auto iter = findChild(children, c);
+                if (iter == std::end(children) || iter->first != c)
+                    iter = children.emplace(iter, c, std::make_unique<PrefixNode>());
+                return *iter->second;
+            }
+
+            PrefixNode const* child(char c) const
+            {
+                const auto iter = findChild(children, c);
+                if (iter == std::end(children) || iter->first != c)
+                    return nullptr;
+                return iter->second.get();
+            }
+
+        };
+
+        struct RegexRoute
+        {
+            std::regex regex;
+            Route route;
+        };
+
+        struct VerbTable
+        {
+            PrefixNode root{};
+            // Routes are referenced by the returned matches, a deque keeps their addresses stable.
+            std::deque<RegexRoute> routes{};
+        };
+
+        bool hasTopLevelAlternative(std::string_view pattern)
+        {
+            int depth = 0;
+            bool inClass = false;
+            for (std::size_t i = 0; i < pattern.size(); ++i)
+            {
+                switch (pattern[i])
+                {
+                    case ('\\'):
+                        ++i;
+                        break;
+                    case ('['):
+                        inClass = true;
+                        break;
+                    case (']'):
+                        inClass = false;
+                        break;
+                    case ('('):
+                        depth += inClass ? 0 : 1;
+                        break;
+                    case (')'):
+                        depth -= inClass ? 0 : 1;
+                        break;
+                    case ('|'):
+                        if (!inClass && depth == 0)
+                            return true;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return false;
+        }
+    }
+    //##################################################################################################################
+    struct RegexRouteMatcher::Implementation
+    {
+        std::unordered_map<boost::beast::http::verb, VerbTable> tables;
+
+        Implementation()
+            : tables{}
+        {}
+    };
+    //##################################################################################################################
+    RegexRouteMatcher::RegexRouteMatcher()
+        : impl_{std::make_unique<Implementation>()}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(RegexRouteMatcher);
+    //------------------------------------------------------------------------------------------------------------------
+    std::string RegexRouteMatcher::literalPrefix(std::string_view pattern)
+    {
+        if (hasTopLevelAlternative(pattern))
+            return {};
+
+        std::string prefix;
+        std::size_t i = pattern.starts_with('^') ? 1 : 0;
+        while (i < pattern.size())
+        {
+            char literal = pattern[i];
+            std::size_t next = i + 1;
+            if (literal == '\\')
+            {
+                // Escaped letters and digits are character classes, assertions or back references.
+                if (next == pattern.size() || std::isalnum(static_cast<unsigned char>(pattern[next])))
+                    break;
+                literal = pattern[next];
+                ++next;
+            }
+            else if (regexOperators.find(literal) != std::string_view::npos)
+                break;
+
+            // A quantified character is not guaranteed to be there exactly once.
+            if (next < pattern.size() && quantifiers.find(pattern[next]) != std::string_view::npos)
+                break;
+
+            prefix.push_back(literal);
+            i = next;
+        }
+        return prefix;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void RegexRouteMatcher::insert(
+        boost::beast::http::verb method,
+        std::string_view pattern,
+        std::regex regex,
+        Route&& route)
+    {
+        auto& table = impl_->tables[method];
+        PrefixNode* node = &table.root;
+        for (auto c : literalPrefix(pattern))
+            node = &node->child(c);
+        node->routes.push_back(table.routes.size());
+        table.routes.push_back(RegexRoute{.regex = std::move(regex), .route = std::move(route)});
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::optional<std::pair<Route const&, std::vector<std::string_view>>>
+    RegexRouteMatcher::find(boost::beast::http::verb method, std::string_view path) const
+    {
+        const auto table = impl_->tables.find(method);
+        if (table == std::end(impl_->tables))
+            return std::nullopt;
+
+        std::vector<std::size_t> candidates;
+        PrefixNode const* node = &table->second.root;
+        for (std::size_t i = 0; node != nullptr; ++i)
+        {
+            candidates.insert(std::end(candidates), std::begin(node->routes), std::end(node->routes));
+            if (i == path.size())
+                break;
+            node = node->child(path[i]);
+        }
+        std::sort(std::begin(candidates), std::end(candidates));
+
+        std::match_results<std::string_view::const_iterator> match;
+        for (auto const index : candidates)
+        {
+            auto const& regexRoute = table->second.routes[index];
+            if (!std::regex_match(std::begin(path), std::end(path), match, regexRoute.regex))
+                continue;
+
+            std::vector<std::string_view> captures;
+            captures.reserve(match.size());
+            for (auto submatch = std::next(std::begin(match)), end = std::end(match); submatch < end; ++submatch)
+                captures.push_back(path.substr(submatch->first - std::begin(path), submatch->length()));
+            return std::pair<Route const&, std::vector<std::string_view>>(regexRoute.route, std::move(captures));
+        }
+        return std::nullopt;
+    }
+    //##################################################################################################################
+}
@@ -37,10 +37,5 @@ namespace Roar
         }
         impl_->callRoute(session, std::move(req));
     }
-    //------------------------------------------------------------------------------------------------------------------
-    bool Route::matches(std::string const& path, std::vector<std::string>& regexMatches) const
-    {
-        return impl_->matches(path, regexMatches);
-    }
     //##################################################################################################################
 }
\ No newline at end of file
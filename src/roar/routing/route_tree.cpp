@@ -0,0 +1,139 @@
+#include <roar/routing/route_tree.hpp>
+#include <roar/routing/route.hpp>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <vector>
+
+namespace Roar
+{
+    namespace
+    {
+        constexpr std::size_t verbCount = static_cast<std::size_t>(boost::beast::http::verb::unlink) + 1;
+
+        struct Node
+        {
+            std::string label{};
+            // Sorted by the first character of the label. No two children share a first character.
+            std::vector<std::unique_ptr<Node>> children{};
+            std::array<Route const*, verbCount> exact{};
+            std::array<Route const*, verbCount> served{};
+
+            std::vector<std::unique_ptr<Node>>::iterator findChild(char first)
+            {
+                return std::lower_bound(
+                    std::begin(children), std::end(children), first, [](auto const& child, char c) {
+                        return child->label.front() < c;
+                    });
+            }
+
+            Node const* childStartingWith(char first) const
+            {
+                const auto iter = std::lower_bound(
+                    std::begin(children), std::end(children), first, [](auto const& child, char c) {
+                        return child->label.front() < c;
+                    });
+                if (iter == std::end(children) || (*iter)->label.front() != first)
+                    return nullptr;
+                return iter->get();
+            }
+        };
+    }
+    //##################################################################################################################
+    struct RouteTree::Implementation
+    {
+        Node root;
+        // Routes are referenced by the nodes, a deque keeps their addresses stable.
+        std::deque<Route> routes;
+
+        Implementation()
+            : root{}
+            , routes{}
+        {}
+
+        Node& makePath(std::string_view path)
+        {
+            Node* node = &root;
+            while (!path.empty())
+            {
+                auto iter = node->findChild(path.front());
+                if (iter == std::end(node->children) || (*iter)->label.front() != path.front())
+                {
+                    auto leaf = std::make_unique<Node>();
+                    leaf->label = std::string{path};
+                    return **node->children.insert(iter, std::move(leaf));
+                }
+
+                auto& child = **iter;
+                const auto common = static_cast<std::size_t>(
+                    std::mismatch(std::begin(child.label), std::end(child.label), std::begin(path), std::end(path))
+                        .first -
+                    std::begin(child.label));
+
+                if (common < child.label.size())
+                {
+                    // Split the edge, the new node takes the shared part of the label.
+                    auto split = std::make_unique<Node>();
+                    split->label = child.label.substr(0, common);
+                    child.label.erase(0, common);
+                    split->children.push_back(std::move(*iter));
+                    *iter = std::move(split);
+                }
+                node = iter->get();
+                path.remove_prefix(common);
+            }
+            return *node;
+        }
+    };
+    //##################################################################################################################
+    RouteTree::RouteTree()
+        : impl_{std::make_unique<Implementation>()}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(RouteTree);
+    //------------------------------------------------------------------------------------------------------------------
+    void RouteTree::insert(boost::beast::http::verb method, std::string_view path, Route&& route, bool isPrefix)
+    {
+        auto& node = impl_->makePath(path);
+        const auto verbIndex = static_cast<std::size_t>(method);
+        auto& slot = isPrefix ? node.served[verbIndex] : node.exact[verbIndex];
+        if (slot != nullptr)
+            return;
+        impl_->routes.push_back(std::move(route));
+        slot = &impl_->routes.back();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    RouteTree::Match RouteTree::find(boost::beast::http::verb method, std::string_view path) const
+    {
+        const auto verbIndex = static_cast<std::size_t>(method);
+        if (verbIndex >= verbCount)
+            return {};
+
+        Match match{};
+        Node const* node = &impl_->root;
+        while (true)
+        {
+            // Deeper served paths are longer, so they override shallower ones.
+            if (node->served[verbIndex] != nullptr)
+                match.served = node->served[verbIndex];
+
+            if (path.empty())
+            {
+                match.exact = node->exact[verbIndex];
+                return match;
+            }
+
+            node = node->childStartingWith(path.front());
+            if (node == nullptr || !path.starts_with(node->label))
+                return match;
+            path.remove_prefix(node->label.size());
+        }
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool RouteTree::empty() const
+    {
+        return impl_->routes.empty();
+    }
+    //##################################################################################################################
+}
@@ -1,60 +1,169 @@
 #include <roar/routing/router.hpp>
 #include <roar/routing/route.hpp>
+#include <roar/routing/route_tree.hpp>
+#include <roar/routing/regex_route_matcher.hpp>
+#include <roar/routing/template_route_matcher.hpp>
+#include <roar/routing/static_route_table.hpp>
 #include <roar/session/session.hpp>
 #include <roar/request.hpp>
+#include <roar/detail/atomic_shared_ptr.hpp>
 
+#include <algorithm>
 #include <utility>
 #include <mutex>
+#include <vector>
 
 namespace Roar
 {
+    //##################################################################################################################
+    namespace
+    {
+        struct RouteMatch
+        {
+            Route const* route = nullptr;
+            // Set instead of route for routes of listeners with a static route table.
+            StaticRoutes const* staticRoutes = nullptr;
+            std::size_t staticIndex = 0;
+            Detail::PathMatchRanges regexMatches{};
+            Detail::PathCaptures pathCaptures{};
+        };
+
+        struct StaticRouteGroup
+        {
+            std::shared_ptr<const StaticRoutes> routes;
+            // Routes of the table for which a string route was installed before, indexed like the table.
+            std::vector<bool> shadowed;
+        };
+
+        /**
+         * @brief An immutable snapshot of all routes. Requests are routed with the snapshot that was current when
+         * they arrived, so adding or removing routes never blocks routing.
+         */
+        struct RouteTable
+        {
+            // String routes of whole listeners, dispatched without type erased routes.
+            std::vector<StaticRouteGroup> staticRoutes{};
+            // String routes and served paths, resolved in a single descent.
+            RouteTree routeTree{};
+            TemplateRouteMatcher templateRoutes{};
+            RegexRouteMatcher regexRoutes{};
+
+            /**
+             * @brief Adds the static routes of a listener. Must be called in install order, interleaved with add,
+             * so that string routes that were installed before can be found in the route tree.
+             */
+            void addStatic(std::shared_ptr<const StaticRoutes> statics)
+            {
+                std::vector<bool> shadowed;
+                for (auto const& [method, path] : statics->routes())
+                    shadowed.push_back(routeTree.find(method, path).exact != nullptr);
+                staticRoutes.push_back(StaticRouteGroup{.routes = std::move(statics), .shadowed = std::move(shadowed)});
+            }
+
+            void add(boost::beast::http::verb method, ProtoRoute proto)
+            {
+                if (std::holds_alternative<std::string>(proto.path))
+                {
+                    const auto path = std::get<std::string>(proto.path);
+                    routeTree.insert(method, path, Route{std::move(proto)}, false);
+                }
+                else if (std::holds_alternative<Detail::ServedPath>(proto.path))
+                {
+                    const auto basePath = std::get<Detail::ServedPath>(proto.path).basePath;
+                    routeTree.insert(method, basePath, Route{std::move(proto)}, true);
+                }
+                else if (std::holds_alternative<Detail::TemplatePath>(proto.path))
+                {
+                    auto pathTemplate = std::get<Detail::TemplatePath>(proto.path).pathTemplate;
+                    templateRoutes.insert(method, std::move(pathTemplate), Route{std::move(proto)});
+                }
+                else
+                {
+                    auto regexPath = std::get<Detail::RegexPath>(proto.path);
+                    regexRoutes.insert(method, regexPath.pattern, std::move(regexPath.regex), Route{std::move(proto)});
+                }
+            }
+
+            std::optional<RouteMatch> findRoute(boost::beast::http::verb method, std::string_view path) const;
+        };
+
+        struct RouteGroup
+        {
+            std::size_t id;
+            std::unordered_multimap<boost::beast::http::verb, ProtoRoute> routes;
+            std::shared_ptr<const StaticRoutes> staticRoutes;
+        };
+    }
     //##################################################################################################################
     struct Router::Implementation
     {
-        mutable std::mutex routesMutex;
-        // TODO: improve performance by using a cleverer structure.
-        std::unordered_multimap<boost::beast::http::verb, Route> stringRoutes;
-        std::unordered_multimap<boost::beast::http::verb, Route> regexRoutes;
-        std::unordered_multimap<boost::beast::http::verb, Route> serveRoutes;
+        // Only serializes writers, readers load the current table without locking.
+        std::mutex writeMutex;
+        std::vector<RouteGroup> routeGroups;
+        std::size_t nextRouteGroupId;
+        Detail::AtomicSharedPtr<const RouteTable> routeTable;
         std::shared_ptr<const StandardResponseProvider> standardResponseProvider;
 
         Implementation(std::shared_ptr<const StandardResponseProvider> standardResponseProvider)
-            : routesMutex{}
-            , stringRoutes{}
-            , regexRoutes{}
+            : writeMutex{}
+            , routeGroups{}
+            , nextRouteGroupId{0}
+            , routeTable{std::make_shared<const RouteTable>()}
             , standardResponseProvider{std::move(standardResponseProvider)}
         {}
 
-        std::optional<std::pair<Route const&, std::vector<std::string>>> findRouteImpl(
-            boost::beast::http::verb method,
-            std::string const& path,
-            std::unordered_multimap<boost::beast::http::verb, Route> const& routeContainer) const
+        /**
+         * @brief Builds a new table from all route groups and publishes it. Must be called with writeMutex held.
+         */
+        void publish()
         {
-            std::scoped_lock lock{routesMutex};
-            const auto equalRange = routeContainer.equal_range(method);
-            std::vector<std::string> regexMatches;
-            for (auto iter = equalRange.first; iter != equalRange.second; ++iter)
+            auto table = std::make_shared<RouteTable>();
+            for (auto const& group : routeGroups)
             {
-                if (iter->second.matches(path, regexMatches))
-                    return std::pair<Route const&, std::vector<std::string>>(iter->second, std::move(regexMatches));
+                if (group.staticRoutes)
+                    table->addStatic(group.staticRoutes);
+                for (auto const& [method, proto] : group.routes)
+                    table->add(method, proto);
             }
-
-            return std::nullopt;
+            routeTable.store(std::move(table));
+        }
+    };
+    //##################################################################################################################
+    std::optional<RouteMatch> RouteTable::findRoute(boost::beast::http::verb method, std::string_view path) const
+    {
+        // Precedence: string routes > path templates > regex routes > served paths.
+        // Among string routes for the same verb and path, the first installed one wins. Checking static tables
+        // first already lets them win over string routes installed after them, so only the entries that a string
+        // route installed before them shadows are skipped.
+        for (auto const& statics : staticRoutes)
+        {
+            if (const auto index = statics.routes->find(method, path); index && !statics.shadowed[*index])
+                return RouteMatch{.staticRoutes = statics.routes.get(), .staticIndex = *index};
         }
 
-        std::optional<std::pair<Route const&, std::vector<std::string>>>
-        findRoute(boost::beast::http::verb method, std::string const& path) const
+        const auto treeMatch = routeTree.find(method, path);
+        if (treeMatch.exact)
+            return RouteMatch{.route = treeMatch.exact};
+
+        if (auto templateMatch = templateRoutes.find(method, path); templateMatch)
+            return RouteMatch{.route = templateMatch->route, .pathCaptures = std::move(templateMatch->captures)};
+
+        if (auto regexMatch = regexRoutes.find(method, path); regexMatch)
         {
-            const auto res = findRouteImpl(method, path, stringRoutes);
-            if (res)
-                return res;
-            const auto res2 = findRouteImpl(method, path, regexRoutes);
-            if (res2)
-                return res2;
-            const auto res3 = findRouteImpl(method, path, serveRoutes);
-            return res3;
+            // The path is a prefix of the request target, so positions within the path are positions in the target.
+            RouteMatch match{.route = &regexMatch->first};
+            match.regexMatches.reserve(regexMatch->second.size());
+            for (auto const& capture : regexMatch->second)
+                match.regexMatches.emplace_back(
+                    static_cast<std::uint32_t>(capture.data() - path.data()),
+                    static_cast<std::uint32_t>(capture.size()));
+            return match;
         }
-    };
+
+        if (treeMatch.served)
+            return RouteMatch{.route = treeMatch.served};
+        return std::nullopt;
+    }
     //##################################################################################################################
     Router::Router(std::shared_ptr<const StandardResponseProvider> standardResponseProvider)
         : impl_{std::make_unique<Implementation>(std::move(standardResponseProvider))}
@@ -62,18 +171,36 @@ namespace Roar
     //------------------------------------------------------------------------------------------------------------------
     ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(Router);
     //------------------------------------------------------------------------------------------------------------------
-    void Router::addRoutes(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes)
+    std::size_t Router::addRoutes(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes)
     {
-        std::scoped_lock lock{impl_->routesMutex};
-        for (auto&& [key, proto] : routes)
-        {
-            if (std::holds_alternative<std::string>(proto.path))
-                impl_->stringRoutes.insert(std::make_pair(key, Route{std::move(proto)}));
-            else if (std::holds_alternative<Detail::ServedPath>(proto.path))
-                impl_->serveRoutes.insert(std::make_pair(key, Route{std::move(proto)}));
-            else
-                impl_->regexRoutes.insert(std::make_pair(key, Route{std::move(proto)}));
-        }
+        std::scoped_lock lock{impl_->writeMutex};
+        const auto id = impl_->nextRouteGroupId++;
+        impl_->routeGroups.push_back(RouteGroup{.id = id, .routes = std::move(routes), .staticRoutes = {}});
+        impl_->publish();
+        return id;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::size_t Router::addStaticRoutes(std::shared_ptr<const StaticRoutes> routes)
+    {
+        std::scoped_lock lock{impl_->writeMutex};
+        const auto id = impl_->nextRouteGroupId++;
+        impl_->routeGroups.push_back(RouteGroup{.id = id, .routes = {}, .staticRoutes = std::move(routes)});
+        impl_->publish();
+        return id;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool Router::removeRoutes(std::size_t routeGroupId)
+    {
+        std::scoped_lock lock{impl_->writeMutex};
+        const auto iter =
+            std::find_if(std::begin(impl_->routeGroups), std::end(impl_->routeGroups), [routeGroupId](auto const& group) {
+                return group.id == routeGroupId;
+            });
+        if (iter == std::end(impl_->routeGroups))
+            return false;
+        impl_->routeGroups.erase(iter);
+        impl_->publish();
+        return true;
     }
     //------------------------------------------------------------------------------------------------------------------
     void Router::followRoute(Session& session, Request<boost::beast::http::empty_body> request)
@@ -82,7 +209,9 @@ namespace Roar
         using namespace std::string_literals;
         try
         {
-            auto result = impl_->findRoute(request.method(), request.path());
+            // Keeps the routes alive, even if the table is replaced while the request is handled.
+            const auto routeTable = impl_->routeTable.load();
+            auto result = routeTable->findRoute(request.method(), request.pathView());
             if (!result)
             {
                 session
@@ -91,10 +220,17 @@ namespace Roar
                     ->commit();
                 return;
             }
-            request.pathMatches(std::move(result->second));
+            request.pathMatches(std::move(result->regexMatches));
+            request.pathParameters(std::move(result->pathCaptures));
             try
             {
-                result->first(session, std::move(request), *impl_->standardResponseProvider);
+                if (result->staticRoutes)
+                {
+                    result->staticRoutes->invoke(
+                        result->staticIndex, session, std::move(request), *impl_->standardResponseProvider);
+                }
+                else
+                    (*result->route)(session, std::move(request), *impl_->standardResponseProvider);
             }
             catch (std::exception const& exc)
             {
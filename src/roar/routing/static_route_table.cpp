@@ -0,0 +1,35 @@
+#include <roar/routing/static_route_table.hpp>
+#include <roar/session/session.hpp>
+#include <roar/request.hpp>
+
+namespace Roar
+{
+    //##################################################################################################################
+    bool StaticRoutes::prepareSession(
+        Session& session,
+        Request<boost::beast::http::empty_body> const& req,
+        RouteOptions const& routeOptions,
+        bool serverIsSecure,
+        StandardResponseProvider const& standardResponseProvider)
+    {
+        using namespace boost::beast::http;
+        session.setupRouteOptions(routeOptions);
+        if (routeOptions.expectUpgrade && !req.isWebsocketUpgrade())
+        {
+            session
+                .send<string_body>(standardResponseProvider.makeStandardResponse(
+                    session,
+                    status::upgrade_required,
+                    "A regular request was received for a route that wants to upgrade to a websocket."))
+                ->commit();
+            return false;
+        }
+        if (serverIsSecure && !session.isSecure() && !routeOptions.allowUnsecure)
+        {
+            session.sendStrictTransportSecurityResponse();
+            return false;
+        }
+        return true;
+    }
+    //##################################################################################################################
+}
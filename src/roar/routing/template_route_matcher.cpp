@@ -0,0 +1,130 @@
+#include <roar/routing/template_route_matcher.hpp>
+#include <roar/routing/route.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace Roar
+{
+    namespace
+    {
+        struct SegmentNode
+        {
+            std::vector<std::pair<std::string, std::unique_ptr<SegmentNode>>> literals{};
+            std::vector<std::pair<PathParameterType, std::unique_ptr<SegmentNode>>> parameters{};
+            Route const* route = nullptr;
+            std::shared_ptr<const PathTemplate> pathTemplate{};
+
+            SegmentNode& child(PathTemplate::Segment const& segment)
+            {
+                if (segment.parameterType)
+                    return childIn(parameters, *segment.parameterType);
+                return childIn(literals, segment.text);
+            }
+
+            template <typename ChildrenT, typename KeyT>
+            static SegmentNode& childIn(ChildrenT& children, KeyT const& key)
+            {
+                for (auto& [childKey, node] : children)
+                {
+                    if (childKey == key)
+                        return *node;
+                }
+                children.emplace_back(key, std::make_unique<SegmentNode>());
+                return *children.back().second;
+            }
+        };
+
+        struct VerbTable
+        {
+            SegmentNode root{};
+            // Routes are referenced by the nodes, a deque keeps their addresses stable.
+            std::deque<Route> routes{};
+        };
+
+        /**
+         * @brief Matches the remaining path at position (which points at a '/' or the end) against the node.
+         */
+        SegmentNode const*
+        matchFrom(SegmentNode const& node, std::string_view path, std::size_t position, Detail::PathCaptures& captures)
+        {
+            if (position == path.size())
+                return node.route != nullptr ? &node : nullptr;
+
+            const auto begin = position + 1;
+            const auto end = std::min(path.find('/', begin), path.size());
+            const auto segment = path.substr(begin, end - begin);
+
+            for (auto const& [literal, child] : node.literals)
+            {
+                if (literal != segment)
+                    continue;
+                if (auto const* found = matchFrom(*child, path, end, captures); found)
+                    return found;
+            }
+
+            for (auto const& [type, child] : node.parameters)
+            {
+                if (!PathTemplate::segmentMatches(type, segment))
+                    continue;
+                captures.ranges[captures.size++] = {
+                    static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(segment.size())};
+                if (auto const* found = matchFrom(*child, path, end, captures); found)
+                    return found;
+                --captures.size;
+            }
+            return nullptr;
+        }
+    }
+    //##################################################################################################################
+    struct TemplateRouteMatcher::Implementation
+    {
+        std::unordered_map<boost::beast::http::verb, VerbTable> tables;
+
+        Implementation()
+            : tables{}
+        {}
+    };
+    //##################################################################################################################
+    TemplateRouteMatcher::TemplateRouteMatcher()
+        : impl_{std::make_unique<Implementation>()}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(TemplateRouteMatcher);
+    //------------------------------------------------------------------------------------------------------------------
+    void TemplateRouteMatcher::insert(
+        boost::beast::http::verb method,
+        std::shared_ptr<const PathTemplate> pathTemplate,
+        Route&& route)
+    {
+        auto& table = impl_->tables[method];
+        SegmentNode* node = &table.root;
+        for (auto const& segment : pathTemplate->segments())
+            node = &node->child(segment);
+
+        if (node->route != nullptr)
+            return;
+        table.routes.push_back(std::move(route));
+        node->route = &table.routes.back();
+        node->pathTemplate = std::move(pathTemplate);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::optional<TemplateRouteMatcher::Match>
+    TemplateRouteMatcher::find(boost::beast::http::verb method, std::string_view path) const
+    {
+        const auto table = impl_->tables.find(method);
+        if (table == std::end(impl_->tables) || !path.starts_with('/'))
+            return std::nullopt;
+
+        Match match{.route = nullptr, .captures = {}};
+        auto const* node = matchFrom(table->second.root, path, 0, match.captures);
+        if (node == nullptr)
+            return std::nullopt;
+        match.route = node->route;
+        match.captures.pathTemplate = node->pathTemplate;
+        return match;
+    }
+    //##################################################################################################################
+}
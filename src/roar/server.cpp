@@ -8,36 +8,121 @@
 #include <roar/session/factory.hpp>
 
 #include <boost/asio/ssl/context.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 
+#include <algorithm>
 #include <optional>
+#include <chrono>
+#include <vector>
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 
 namespace Roar
 {
+    namespace
+    {
+#ifdef SO_REUSEPORT
+        using ReusePort = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+        /// The executors of the acceptors that are opened for every listened on endpoint.
+        std::vector<boost::asio::any_io_executor> makeAcceptorExecutors(
+            boost::asio::any_io_executor const& executor,
+            std::size_t acceptorCount,
+            std::vector<boost::asio::any_io_executor> const& acceptorExecutors,
+            IoContextPool const* ioContextPool)
+        {
+            std::vector<boost::asio::any_io_executor> executors;
+            if (ioContextPool)
+            {
+                executors.reserve(ioContextPool->size());
+                for (std::size_t i = 0; i != ioContextPool->size(); ++i)
+                    executors.push_back(ioContextPool->executor(i));
+                return executors;
+            }
+
+            acceptorCount = std::max(acceptorCount, std::size_t{1});
+            executors.reserve(acceptorCount);
+            for (std::size_t i = 0; i != acceptorCount; ++i)
+            {
+                if (acceptorExecutors.empty())
+                    executors.push_back(boost::asio::make_strand(executor));
+                else
+                    executors.push_back(boost::asio::make_strand(acceptorExecutors[i % acceptorExecutors.size()]));
+            }
+            return executors;
+        }
+
+        /// Without any limit every connection and request is admitted, so the bookkeeping is skipped entirely.
+        std::shared_ptr<AdmissionControl> makeAdmissionControl(AdmissionLimits limits)
+        {
+            if (limits.maxConnections == 0 && limits.maxInFlightRequests == 0 && !limits.maxQueueingDelay)
+                return nullptr;
+            return std::make_shared<AdmissionControl>(std::move(limits));
+        }
+
+        struct Acceptor
+        {
+            boost::asio::ip::tcp::acceptor acceptor;
+            ConnectionMode connectionMode;
+        };
+    }
     // ##################################################################################################################
     struct Server::Implementation : public std::enable_shared_from_this<Server::Implementation>
     {
-        boost::asio::ip::tcp::acceptor acceptor;
+        std::unique_ptr<IoContextPool> ioContextPool;
+        std::vector<boost::asio::any_io_executor> acceptorExecutors;
+        std::vector<std::shared_ptr<Acceptor>> acceptors;
         std::optional<std::variant<SslServerContext, boost::asio::ssl::context>> sslContext;
-        boost::asio::ip::tcp::endpoint bindEndpoint;
         boost::asio::ip::tcp::endpoint resolvedEndpoint;
         std::shared_mutex acceptorStopGuard;
         std::function<void(boost::system::error_code)> onAcceptAbort;
         std::shared_ptr<const StandardResponseProvider> standardResponseProvider;
         std::shared_ptr<Router> router;
+        std::mutex listenerRoutesMutex;
+        std::unordered_map<void const*, std::size_t> listenerRoutes;
         std::function<void(Error&&)> onError;
+        // nullptr if no admission limits are set.
+        std::shared_ptr<AdmissionControl> admissionControl;
+        std::shared_ptr<boost::asio::thread_pool> fileIoPool;
         Factory sessionFactory;
+        std::size_t pendingAccepts;
+        std::size_t acceptBatchSize;
+        int listenBacklog;
 
         Implementation(
             boost::asio::any_io_executor& executor,
             std::optional<std::variant<SslServerContext, boost::asio::ssl::context>> sslContext,
             std::function<void(Error&&)> onError,
             std::function<void(boost::system::error_code)> onAcceptAbort,
-            std::unique_ptr<StandardResponseProvider> standardResponseProvider);
+            std::unique_ptr<StandardResponseProvider> standardResponseProvider,
+            std::size_t maxRequestsPerConnection,
+            std::chrono::milliseconds idleTimeout,
+            std::size_t acceptorCount,
+            std::vector<boost::asio::any_io_executor> const& acceptorExecutors,
+            std::optional<IoContextPool::ConstructionArguments> const& threadPerCore,
+            std::size_t pendingAccepts,
+            std::size_t acceptBatchSize,
+            int listenBacklog,
+            AdmissionLimits admissionLimits,
+            std::size_t fileIoThreads);
 
-        void acceptOnce(int failCount);
+        boost::leaf::result<boost::asio::ip::tcp::endpoint>
+        listen(boost::asio::ip::tcp::endpoint bindEndpoint, ConnectionMode connectionMode);
+        boost::leaf::result<void> open(
+            boost::asio::ip::tcp::acceptor& acceptor,
+            boost::asio::ip::tcp::endpoint const& bindEndpoint,
+            bool reusePort);
+        boost::asio::any_io_executor makeSessionExecutor(Acceptor& acceptor);
+        void acceptOnce(std::shared_ptr<Acceptor> const& acceptor, int failCount);
+        void drainBacklog(Acceptor& acceptor);
+        void makeSession(
+            Acceptor const& acceptor,
+            boost::asio::ip::tcp::socket&& socket,
+            AdmissionTicket&& connectionTicket);
     };
     //------------------------------------------------------------------------------------------------------------------
     Server::Implementation::Implementation(
@@ -45,47 +130,237 @@ namespace Roar
         std::optional<std::variant<SslServerContext, boost::asio::ssl::context>> sslContext,
         std::function<void(Error&&)> onError,
         std::function<void(boost::system::error_code)> onAcceptAbort,
-        std::unique_ptr<StandardResponseProvider> standardResponseProvider)
-        : acceptor{boost::asio::make_strand(executor)}
+        std::unique_ptr<StandardResponseProvider> standardResponseProvider,
+        std::size_t maxRequestsPerConnection,
+        std::chrono::milliseconds idleTimeout,
+        std::size_t acceptorCount,
+        std::vector<boost::asio::any_io_executor> const& acceptorExecutors,
+        std::optional<IoContextPool::ConstructionArguments> const& threadPerCore,
+        std::size_t pendingAccepts,
+        std::size_t acceptBatchSize,
+        int listenBacklog,
+        AdmissionLimits admissionLimits,
+        std::size_t fileIoThreads)
+        : ioContextPool{threadPerCore ? std::make_unique<IoContextPool>(*threadPerCore) : nullptr}
+        , acceptorExecutors{makeAcceptorExecutors(executor, acceptorCount, acceptorExecutors, ioContextPool.get())}
+        , acceptors{}
         , sslContext{std::move(sslContext)}
-        , bindEndpoint{}
         , resolvedEndpoint{}
         , acceptorStopGuard{}
         , onAcceptAbort{std::move(onAcceptAbort)}
         , standardResponseProvider{standardResponseProvider.release()}
         , router{std::make_shared<Router>(this->standardResponseProvider)}
+        , listenerRoutesMutex{}
+        , listenerRoutes{}
         , onError{std::move(onError)}
-        , sessionFactory{this->sslContext, this->onError}
+        , admissionControl{makeAdmissionControl(std::move(admissionLimits))}
+        , fileIoPool{fileIoThreads > 0 ? std::make_shared<boost::asio::thread_pool>(fileIoThreads) : nullptr}
+        , sessionFactory{
+              this->sslContext,
+              this->onError,
+              maxRequestsPerConnection,
+              idleTimeout,
+              admissionControl,
+              fileIoPool}
+        , pendingAccepts{std::max(pendingAccepts, std::size_t{1})}
+        , acceptBatchSize{std::max(acceptBatchSize, std::size_t{1})}
+        , listenBacklog{listenBacklog}
     {}
     //------------------------------------------------------------------------------------------------------------------
-    void Server::Implementation::acceptOnce(int failCount)
+    boost::leaf::result<boost::asio::ip::tcp::endpoint>
+    Server::Implementation::listen(boost::asio::ip::tcp::endpoint bindEndpoint, ConnectionMode connectionMode)
+    {
+        if (connectionMode == ConnectionMode::Tls && !sslContext)
+        {
+            return boost::leaf::new_error(
+                "TLS listener requires an SSL context.",
+                boost::asio::error::make_error_code(boost::asio::error::invalid_argument));
+        }
+
+        std::vector<std::shared_ptr<Acceptor>> opened;
+        opened.reserve(acceptorExecutors.size());
+        const bool reusePort = acceptorExecutors.size() > 1;
+        for (auto const& acceptorExecutor : acceptorExecutors)
+        {
+            opened.push_back(std::make_shared<Acceptor>(
+                Acceptor{.acceptor = boost::asio::ip::tcp::acceptor{acceptorExecutor}, .connectionMode = connectionMode}));
+            if (auto result = open(opened.back()->acceptor, bindEndpoint, reusePort); !result)
+            {
+                for (auto& acceptor : opened)
+                {
+                    boost::system::error_code ec;
+                    acceptor->acceptor.close(ec);
+                }
+                return result.error();
+            }
+
+            // When bound to port 0, all further acceptors have to share the port picked for the first one.
+            bindEndpoint = opened.back()->acceptor.local_endpoint();
+        }
+
+        {
+            std::scoped_lock lock{acceptorStopGuard};
+            acceptors.insert(std::end(acceptors), std::begin(opened), std::end(opened));
+        }
+        for (auto const& acceptor : opened)
+        {
+            for (std::size_t pending = 0; pending != pendingAccepts; ++pending)
+                acceptOnce(acceptor, 0);
+        }
+        return bindEndpoint;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    boost::leaf::result<void> Server::Implementation::open(
+        boost::asio::ip::tcp::acceptor& acceptor,
+        boost::asio::ip::tcp::endpoint const& bindEndpoint,
+        bool reusePort)
+    {
+        boost::system::error_code ec;
+        acceptor.open(bindEndpoint.protocol(), ec);
+        if (ec)
+            return boost::leaf::new_error("Could not open http server acceptor.", ec);
+
+        acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+        if (ec)
+            return boost::leaf::new_error("Could not configure socket to reuse address.", ec);
+
+        if (reusePort)
+        {
+#ifdef SO_REUSEPORT
+            acceptor.set_option(ReusePort(true), ec);
+            if (ec)
+                return boost::leaf::new_error("Could not configure socket to reuse port.", ec);
+#else
+            return boost::leaf::new_error(
+                "Multiple acceptors require SO_REUSEPORT, which is not available on this platform.",
+                boost::asio::error::make_error_code(boost::asio::error::operation_not_supported));
+#endif
+        }
+
+        acceptor.bind(bindEndpoint, ec);
+        if (ec)
+            return boost::leaf::new_error("Could not bind socket.", ec);
+
+        acceptor.listen(listenBacklog, ec);
+        if (ec)
+            return boost::leaf::new_error("Could not listen on socket.", ec);
+
+        // Batches are drained with synchronous accepts, which must not block once the backlog is empty.
+        if (acceptBatchSize > 1)
+        {
+            acceptor.non_blocking(true, ec);
+            if (ec)
+                return boost::leaf::new_error("Could not make acceptor non-blocking.", ec);
+        }
+
+        return {};
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    boost::asio::any_io_executor Server::Implementation::makeSessionExecutor(Acceptor& acceptor)
+    {
+        auto executor = acceptor.acceptor.get_executor();
+        // Connections on a single threaded io_context are implicitly serialized, so they do not need a strand.
+        if (ioContextPool)
+            return executor;
+        return boost::asio::make_strand(executor);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Server::Implementation::acceptOnce(std::shared_ptr<Acceptor> const& acceptor, int failCount)
     {
-        acceptor.async_accept(
-            boost::asio::make_strand(acceptor.get_executor()),
-            [self = shared_from_this(), failCount](boost::system::error_code ec, auto socket) mutable {
+        AdmissionTicket connectionTicket{};
+        if (admissionControl)
+        {
+            connectionTicket = admissionControl->tryAdmitConnection();
+            if (!connectionTicket)
+            {
+                // Accepting pauses until a connection closes. Waiting connections stay in the listen backlog.
+                admissionControl->onConnectionAvailable(
+                    [weakSelf = weak_from_this(), weakAcceptor = std::weak_ptr<Acceptor>{acceptor}]() {
+                        auto self = weakSelf.lock();
+                        auto acceptor = weakAcceptor.lock();
+                        if (!self || !acceptor)
+                            return;
+                        std::shared_lock lock{self->acceptorStopGuard};
+                        if (!acceptor->acceptor.is_open())
+                            return;
+                        boost::asio::post(acceptor->acceptor.get_executor(), [self, acceptor]() {
+                            self->acceptOnce(acceptor, 0);
+                        });
+                    });
+                return;
+            }
+        }
+
+        acceptor->acceptor.async_accept(
+            makeSessionExecutor(*acceptor),
+            [self = shared_from_this(), acceptor, failCount, connectionTicket = std::move(connectionTicket)](
+                boost::system::error_code ec, auto socket) mutable {
                 if (ec == boost::asio::error::operation_aborted)
                     return;
 
                 {
                     std::shared_lock lock{self->acceptorStopGuard};
-                    if (!self->acceptor.is_open())
+                    if (!acceptor->acceptor.is_open())
                         return;
                 }
 
                 if (!ec)
                 {
-                    self->sessionFactory.makeSession(std::move(socket), self->router, self->standardResponseProvider);
-                    self->acceptOnce(0);
+                    // Rearm first, so that the next connection is not delayed by the session setup.
+                    self->acceptOnce(acceptor, 0);
+                    self->makeSession(*acceptor, std::move(socket), std::move(connectionTicket));
+                    self->drainBacklog(*acceptor);
                     return;
                 }
                 else
                 {
                     if (failCount >= 5)
                         return self->onAcceptAbort(ec);
-                    self->acceptOnce(failCount + 1);
+                    connectionTicket.release();
+                    self->acceptOnce(acceptor, failCount + 1);
                 }
             });
     }
+    //------------------------------------------------------------------------------------------------------------------
+    void Server::Implementation::drainBacklog(Acceptor& acceptor)
+    {
+        // Runs on the executor of the acceptor, like the completion handlers of its pending accepts.
+        for (std::size_t i = 1; i < acceptBatchSize; ++i)
+        {
+            AdmissionTicket connectionTicket{};
+            if (admissionControl)
+            {
+                connectionTicket = admissionControl->tryAdmitConnection();
+                if (!connectionTicket)
+                    return;
+            }
+
+            boost::system::error_code ec;
+            auto socket = acceptor.acceptor.accept(makeSessionExecutor(acceptor), ec);
+            // would_block means the backlog is empty. Other errors are left to the pending accepts to report.
+            if (ec)
+                return;
+            makeSession(acceptor, std::move(socket), std::move(connectionTicket));
+        }
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Server::Implementation::makeSession(
+        Acceptor const& acceptor,
+        boost::asio::ip::tcp::socket&& socket,
+        AdmissionTicket&& connectionTicket)
+    {
+        if (acceptor.connectionMode == ConnectionMode::AutoDetect)
+        {
+            return sessionFactory.makeSession(
+                std::move(socket), router, standardResponseProvider, std::move(connectionTicket));
+        }
+        sessionFactory.makeSession(
+            std::move(socket),
+            acceptor.connectionMode == ConnectionMode::Tls,
+            router,
+            standardResponseProvider,
+            std::move(connectionTicket));
+    }
     // ##################################################################################################################
     Server::Server(ConstructionArguments constructionArgs)
         // NOLINTNEXTLINE
@@ -94,23 +369,50 @@ namespace Roar
               std::move(constructionArgs.sslContext),
               std::move(constructionArgs.onError),
               std::move(constructionArgs.onAcceptAbort),
-              std::move(constructionArgs.standardResponseProvider))}
+              std::move(constructionArgs.standardResponseProvider),
+              constructionArgs.maxRequestsPerConnection,
+              constructionArgs.idleTimeout,
+              constructionArgs.acceptorCount,
+              constructionArgs.acceptorExecutors,
+              constructionArgs.threadPerCore,
+              constructionArgs.pendingAccepts,
+              constructionArgs.acceptBatchSize,
+              constructionArgs.listenBacklog,
+              std::move(constructionArgs.admissionLimits),
+              constructionArgs.fileIoThreads)}
     {}
     //------------------------------------------------------------------------------------------------------------------
     Server::~Server()
     {
+        if (!impl_)
+            return;
+
         stop();
+        if (impl_->ioContextPool)
+        {
+            // Pending handlers keep the implementation alive and are only destroyed together with the io_contexts.
+            auto ioContextPool = std::move(impl_->ioContextPool);
+            ioContextPool->stop();
+            {
+                std::scoped_lock lock{impl_->acceptorStopGuard};
+                impl_->acceptors.clear();
+                impl_->acceptorExecutors.clear();
+            }
+            impl_.reset();
+        }
     }
     //------------------------------------------------------------------------------------------------------------------
     boost::asio::any_io_executor Server::getExecutor() const
     {
-        return impl_->acceptor.get_executor();
+        return impl_->acceptorExecutors.front();
     }
     //------------------------------------------------------------------------------------------------------------------
-    boost::leaf::result<void> Server::start(unsigned short port, std::string const& host)
+    boost::leaf::result<void> Server::start(unsigned short port, std::string const& host, ConnectionMode connectionMode)
     {
-        return start(Dns::resolveSingle(
-            impl_->acceptor.get_executor(), host, port, false, boost::asio::ip::resolver_base::flags::passive));
+        return start(
+            Dns::resolveSingle(
+                impl_->acceptorExecutors.front(), host, port, false, boost::asio::ip::resolver_base::flags::passive),
+            connectionMode);
     }
     //------------------------------------------------------------------------------------------------------------------
     boost::asio::ip::basic_endpoint<boost::asio::ip::tcp> const& Server::getLocalEndpoint() const
@@ -118,42 +420,57 @@ namespace Roar
         return impl_->resolvedEndpoint;
     }
     //------------------------------------------------------------------------------------------------------------------
-    boost::leaf::result<void> Server::start(boost::asio::ip::tcp::endpoint const& bindEndpoint)
+    boost::leaf::result<void>
+    Server::start(boost::asio::ip::tcp::endpoint const& bindEndpoint, ConnectionMode connectionMode)
     {
         stop();
-        boost::system::error_code ec;
-        impl_->bindEndpoint = bindEndpoint;
-
-        impl_->acceptor.open(impl_->bindEndpoint.protocol(), ec);
-        if (ec)
-            return boost::leaf::new_error("Could not open http server acceptor.", ec);
-
-        impl_->acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
-        if (ec)
-            return boost::leaf::new_error("Could not configure socket to reuse address.", ec);
-
-        impl_->acceptor.bind(impl_->bindEndpoint, ec);
-        if (ec)
-            return boost::leaf::new_error("Could not bind socket.", ec);
-
-        impl_->acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
-        if (ec)
-            return boost::leaf::new_error("Could not listen on socket.", ec);
-
-        impl_->resolvedEndpoint = impl_->acceptor.local_endpoint();
-        impl_->acceptOnce(0);
+        auto resolvedEndpoint = impl_->listen(bindEndpoint, connectionMode);
+        if (!resolvedEndpoint)
+            return resolvedEndpoint.error();
+        impl_->resolvedEndpoint = *resolvedEndpoint;
         return {};
     }
     //------------------------------------------------------------------------------------------------------------------
+    boost::leaf::result<boost::asio::ip::tcp::endpoint>
+    Server::listen(boost::asio::ip::tcp::endpoint const& bindEndpoint, ConnectionMode connectionMode)
+    {
+        return impl_->listen(bindEndpoint, connectionMode);
+    }
+    //------------------------------------------------------------------------------------------------------------------
     void Server::stop()
     {
         std::scoped_lock lock{impl_->acceptorStopGuard};
-        impl_->acceptor.close();
+        for (auto& acceptor : impl_->acceptors)
+        {
+            boost::system::error_code ec;
+            acceptor->acceptor.close(ec);
+        }
+        impl_->acceptors.clear();
     }
     //------------------------------------------------------------------------------------------------------------------
-    void Server::addRequestListenerToRouter(std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes)
+    void Server::addRequestListenerToRouter(
+        void const* listener,
+        std::unordered_multimap<boost::beast::http::verb, ProtoRoute>&& routes)
     {
-        impl_->router->addRoutes(std::move(routes));
+        std::scoped_lock lock{impl_->listenerRoutesMutex};
+        impl_->listenerRoutes[listener] = impl_->router->addRoutes(std::move(routes));
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Server::addStaticRoutesToRouter(void const* listener, std::shared_ptr<const StaticRoutes> routes)
+    {
+        std::scoped_lock lock{impl_->listenerRoutesMutex};
+        impl_->listenerRoutes[listener] = impl_->router->addStaticRoutes(std::move(routes));
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool Server::removeRequestListenerFromRouter(void const* listener)
+    {
+        std::scoped_lock lock{impl_->listenerRoutesMutex};
+        const auto iter = impl_->listenerRoutes.find(listener);
+        if (iter == std::end(impl_->listenerRoutes))
+            return false;
+        const auto removed = impl_->router->removeRoutes(iter->second);
+        impl_->listenerRoutes.erase(iter);
+        return removed;
     }
     //------------------------------------------------------------------------------------------------------------------
     bool Server::isSecure() const
@@ -161,6 +478,16 @@ namespace Roar
         return impl_->sslContext.has_value();
     }
     //------------------------------------------------------------------------------------------------------------------
+    std::optional<SslSessionStatistics> Server::sslSessionStatistics() const
+    {
+        if (!impl_->sslContext)
+            return std::nullopt;
+        auto const* serverContext = std::get_if<SslServerContext>(&*impl_->sslContext);
+        if (!serverContext || !serverContext->sessionResumptionState)
+            return std::nullopt;
+        return serverContext->sessionResumptionState->statistics();
+    }
+    //------------------------------------------------------------------------------------------------------------------
     Server::Server(Server&&) = default;
     //------------------------------------------------------------------------------------------------------------------
     Server& Server::operator=(Server&&) = default;
@@ -0,0 +1,140 @@
+#include <roar/session/admission_control.hpp>
+
+#include <utility>
+
+namespace Roar
+{
+    namespace
+    {
+        bool tryIncrement(std::atomic<std::size_t>& counter, std::size_t limit)
+        {
+            if (limit == 0)
+            {
+                counter.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            auto current = counter.load(std::memory_order_relaxed);
+            do
+            {
+                if (current >= limit)
+                    return false;
+            } while (!counter.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+            return true;
+        }
+    }
+    // ##################################################################################################################
+    AdmissionTicket::AdmissionTicket(std::shared_ptr<AdmissionControl> admissionControl, Kind kind)
+        : admissionControl_{std::move(admissionControl)}
+        , kind_{kind}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket::~AdmissionTicket()
+    {
+        release();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket::AdmissionTicket(AdmissionTicket&& other) noexcept
+        : admissionControl_{std::exchange(other.admissionControl_, nullptr)}
+        , kind_{other.kind_}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            admissionControl_ = std::exchange(other.admissionControl_, nullptr);
+            kind_ = other.kind_;
+        }
+        return *this;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket::operator bool() const
+    {
+        return static_cast<bool>(admissionControl_);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void AdmissionTicket::release()
+    {
+        if (auto admissionControl = std::exchange(admissionControl_, nullptr); admissionControl)
+            admissionControl->release(kind_);
+    }
+    // ##################################################################################################################
+    AdmissionControl::AdmissionControl(AdmissionLimits limits)
+        : limits_{std::move(limits)}
+        , connections_{0}
+        , inFlightRequests_{0}
+        , waitingMutex_{}
+        , waitingForConnection_{}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket AdmissionControl::tryAdmitConnection()
+    {
+        if (!tryIncrement(connections_, limits_.maxConnections))
+            return {};
+        return AdmissionTicket{shared_from_this(), AdmissionTicket::Kind::Connection};
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void AdmissionControl::onConnectionAvailable(std::function<void()> resume)
+    {
+        {
+            // Checked under the lock, so that a release between the failed admission and this call is not missed.
+            std::scoped_lock lock{waitingMutex_};
+            if (connections_.load(std::memory_order_relaxed) >= limits_.maxConnections && limits_.maxConnections != 0)
+            {
+                waitingForConnection_.push_back(std::move(resume));
+                return;
+            }
+        }
+        resume();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    AdmissionTicket AdmissionControl::tryAdmitRequest()
+    {
+        if (!tryIncrement(inFlightRequests_, limits_.maxInFlightRequests))
+            return {};
+        return AdmissionTicket{shared_from_this(), AdmissionTicket::Kind::Request};
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool AdmissionControl::measuresQueueingDelay() const
+    {
+        return limits_.maxQueueingDelay.has_value();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool AdmissionControl::shouldShed(std::chrono::steady_clock::duration queueingDelay) const
+    {
+        return limits_.maxQueueingDelay && queueingDelay > *limits_.maxQueueingDelay;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::size_t AdmissionControl::connectionCount() const
+    {
+        return connections_.load(std::memory_order_relaxed);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::size_t AdmissionControl::inFlightRequestCount() const
+    {
+        return inFlightRequests_.load(std::memory_order_relaxed);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void AdmissionControl::release(AdmissionTicket::Kind kind)
+    {
+        if (kind == AdmissionTicket::Kind::Request)
+        {
+            inFlightRequests_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        connections_.fetch_sub(1, std::memory_order_relaxed);
+        std::function<void()> resume;
+        {
+            std::scoped_lock lock{waitingMutex_};
+            if (waitingForConnection_.empty())
+                return;
+            resume = std::move(waitingForConnection_.back());
+            waitingForConnection_.pop_back();
+        }
+        resume();
+    }
+    // ##################################################################################################################
+}
@@ -19,10 +19,12 @@ namespace Roar
     {
         boost::beast::tcp_stream stream;
         boost::beast::flat_buffer buffer;
+        AdmissionTicket connectionTicket;
 
-        ProtoSession(boost::asio::ip::tcp::socket&& socket)
+        ProtoSession(boost::asio::ip::tcp::socket&& socket, AdmissionTicket&& connectionTicket)
             : stream{std::move(socket)}
             , buffer{}
+            , connectionTicket{std::move(connectionTicket)}
         {}
     };
     // ##################################################################################################################
@@ -30,15 +32,41 @@ namespace Roar
     {
         std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext;
         std::function<void(Error&&)> onError;
+        std::size_t maxRequestsPerConnection;
+        std::chrono::milliseconds idleTimeout;
+        std::shared_ptr<AdmissionControl> admissionControl;
+        std::shared_ptr<boost::asio::thread_pool> fileIoPool;
 
-        Implementation(std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext, std::function<void(Error&&)> onError)
+        Implementation(
+            std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext,
+            std::function<void(Error&&)> onError,
+            std::size_t maxRequestsPerConnection,
+            std::chrono::milliseconds idleTimeout,
+            std::shared_ptr<AdmissionControl> admissionControl,
+            std::shared_ptr<boost::asio::thread_pool> fileIoPool)
             : sslContext{sslContext}
             , onError{std::move(onError)}
+            , maxRequestsPerConnection{maxRequestsPerConnection}
+            , idleTimeout{idleTimeout}
+            , admissionControl{std::move(admissionControl)}
+            , fileIoPool{std::move(fileIoPool)}
         {}
     };
     // ##################################################################################################################
-    Factory::Factory(std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext, std::function<void(Error&&)> onError)
-        : impl_{std::make_unique<Implementation>(sslContext, std::move(onError))}
+    Factory::Factory(
+        std::optional<std::variant<SslServerContext, boost::asio::ssl::context>>& sslContext,
+        std::function<void(Error&&)> onError,
+        std::size_t maxRequestsPerConnection,
+        std::chrono::milliseconds idleTimeout,
+        std::shared_ptr<AdmissionControl> admissionControl,
+        std::shared_ptr<boost::asio::thread_pool> fileIoPool)
+        : impl_{std::make_unique<Implementation>(
+              sslContext,
+              std::move(onError),
+              maxRequestsPerConnection,
+              idleTimeout,
+              std::move(admissionControl),
+              std::move(fileIoPool))}
     {}
     //------------------------------------------------------------------------------------------------------------------
     ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(Factory);
@@ -46,10 +74,11 @@ namespace Roar
     void Factory::makeSession(
         boost::asio::basic_stream_socket<boost::asio::ip::tcp>&& socket,
         std::weak_ptr<Router> router,
-        std::shared_ptr<const StandardResponseProvider> standardResponseProvider)
+        std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+        AdmissionTicket connectionTicket)
     {
         // NOLINTNEXTLINE
-        auto protoSession = std::make_shared<ProtoSession>(std::move(socket));
+        auto protoSession = std::make_shared<ProtoSession>(std::move(socket), std::move(connectionTicket));
         boost::beast::get_lowest_layer(protoSession->stream).expires_after(std::chrono::seconds(sslDetectionTimeout));
         boost::beast::async_detect_ssl(
             protoSession->stream,
@@ -80,7 +109,12 @@ namespace Roar
                         isSecure,
                         impl_->onError,
                         router,
-                        std::move(standardResponseProvider))
+                        std::move(standardResponseProvider),
+                        impl_->maxRequestsPerConnection,
+                        impl_->idleTimeout,
+                        impl_->admissionControl,
+                        std::move(protoSession->connectionTicket),
+                        impl_->fileIoPool)
                         ->startup();
                 }
                 catch (std::exception const& exc)
@@ -89,5 +123,36 @@ namespace Roar
                 }
             });
     }
+    //------------------------------------------------------------------------------------------------------------------
+    void Factory::makeSession(
+        boost::asio::basic_stream_socket<boost::asio::ip::tcp>&& socket,
+        bool isSecure,
+        std::weak_ptr<Router> router,
+        std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+        AdmissionTicket connectionTicket)
+    {
+        try
+        {
+            // Not yet on the executor of the socket, so startup dispatches there.
+            std::make_shared<Session>(
+                std::move(socket),
+                boost::beast::flat_buffer{},
+                impl_->sslContext,
+                isSecure,
+                impl_->onError,
+                std::move(router),
+                std::move(standardResponseProvider),
+                impl_->maxRequestsPerConnection,
+                impl_->idleTimeout,
+                impl_->admissionControl,
+                std::move(connectionTicket),
+                impl_->fileIoPool)
+                ->startup(false);
+        }
+        catch (std::exception const& exc)
+        {
+            return impl_->onError({.error = exc.what(), .additionalInfo = "Exception in session factory."});
+        }
+    }
     // ##################################################################################################################
 }
\ No newline at end of file
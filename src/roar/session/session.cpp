@@ -4,9 +4,11 @@
 #include <roar/request.hpp>
 #include <roar/routing/router.hpp>
 #include <roar/utility/visit_overloaded.hpp>
+#include <roar/ssl/kernel_tls.hpp>
 
 #include <boost/beast/core/flat_buffer.hpp>
 #include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/basic_stream_socket.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
@@ -15,6 +17,9 @@
 #include <boost/beast/http/read.hpp>
 
 #include <chrono>
+#include <deque>
+#include <limits>
+#include <mutex>
 #include <variant>
 
 namespace Roar
@@ -30,6 +35,23 @@ namespace Roar
         std::shared_ptr<boost::beast::http::request_parser<boost::beast::http::empty_body>> headerParser;
         RouteOptions routeOptions;
         std::shared_ptr<const StandardResponseProvider> standardResponseProvider;
+        std::size_t maxRequestsPerConnection;
+        std::chrono::milliseconds idleTimeout;
+        std::size_t requestCount;
+        bool requestKeepAlive;
+        bool requestBodyConsumed;
+        bool headRequest;
+        std::string acceptEncoding;
+        bool writeLimited;
+        std::mutex responseQueueMutex;
+        std::deque<std::function<void()>> responseQueue;
+        bool responseInFlight;
+        bool awaitingHeader;
+        bool closeWhenWritten;
+        std::shared_ptr<AdmissionControl> admissionControl;
+        AdmissionTicket connectionTicket;
+        std::deque<AdmissionTicket> requestTickets;
+        std::shared_ptr<boost::asio::thread_pool> fileIoPool;
 
         Implementation(
             boost::asio::ip::tcp::socket&& socket,
@@ -38,7 +60,12 @@ namespace Roar
             bool isSecure,
             std::function<void(Error&&)> onError,
             std::weak_ptr<Router> router,
-            std::shared_ptr<const StandardResponseProvider> standardResponseProvider)
+            std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+            std::size_t maxRequestsPerConnection,
+            std::chrono::milliseconds idleTimeout,
+            std::shared_ptr<AdmissionControl> admissionControl,
+            AdmissionTicket connectionTicket,
+            std::shared_ptr<boost::asio::thread_pool> fileIoPool)
             : stream{[&socket, &sslContext, isSecure]() mutable -> decltype(stream) {
                 if (isSecure)
                 {
@@ -66,6 +93,23 @@ namespace Roar
             , headerParser{}
             , routeOptions{}
             , standardResponseProvider{std::move(standardResponseProvider)}
+            , maxRequestsPerConnection{maxRequestsPerConnection}
+            , idleTimeout{idleTimeout}
+            , requestCount{0}
+            , requestKeepAlive{false}
+            , requestBodyConsumed{true}
+            , headRequest{false}
+            , acceptEncoding{}
+            , writeLimited{false}
+            , responseQueueMutex{}
+            , responseQueue{}
+            , responseInFlight{false}
+            , awaitingHeader{false}
+            , closeWhenWritten{false}
+            , admissionControl{std::move(admissionControl)}
+            , connectionTicket{std::move(connectionTicket)}
+            , requestTickets{}
+            , fileIoPool{std::move(fileIoPool)}
         {}
 
         template <typename FunctionT>
@@ -73,6 +117,27 @@ namespace Roar
         {
             std::visit(std::forward<FunctionT>(func), stream);
         }
+
+        /**
+         * @brief Moves the TLS record layer into the kernel, if the ssl context was prepared for it. The stream is a
+         * plain stream afterwards, so responses can use the same zero copy paths as unencrypted connections.
+         */
+        void offloadTlsToKernel()
+        {
+            auto& sslStream = std::get<boost::beast::ssl_stream<Detail::StreamType>>(stream);
+            if (!Detail::kernelTlsRequested(sslStream.native_handle()) || buffer.size() != 0)
+                return;
+
+            auto& socket = sslStream.next_layer().socket();
+            const auto offload = Detail::offloadTlsToKernel(sslStream.native_handle(), socket.native_handle());
+            buffer.commit(boost::asio::buffer_copy(
+                buffer.prepare(offload.plaintext.size()), boost::asio::buffer(offload.plaintext)));
+            if (!offload.offloaded)
+                return;
+
+            auto plainSocket = std::move(socket);
+            stream.emplace<Detail::StreamType>(std::move(plainSocket));
+        }
     };
     // ##################################################################################################################
     Session::Session(
@@ -82,7 +147,12 @@ namespace Roar
         bool isSecure,
         std::function<void(Error&&)> onError,
         std::weak_ptr<Router> router,
-        std::shared_ptr<const StandardResponseProvider> standardResponseProvider)
+        std::shared_ptr<const StandardResponseProvider> standardResponseProvider,
+        std::size_t maxRequestsPerConnection,
+        std::chrono::milliseconds idleTimeout,
+        std::shared_ptr<AdmissionControl> admissionControl,
+        AdmissionTicket connectionTicket,
+        std::shared_ptr<boost::asio::thread_pool> fileIoPool)
         // NOLINTNEXTLINE
         : impl_{std::make_unique<Implementation>(
               std::move(socket),
@@ -91,7 +161,12 @@ namespace Roar
               isSecure,
               std::move(onError),
               std::move(router),
-              std::move(standardResponseProvider))}
+              std::move(standardResponseProvider),
+              maxRequestsPerConnection,
+              idleTimeout,
+              std::move(admissionControl),
+              std::move(connectionTicket),
+              std::move(fileIoPool))}
     {}
     //------------------------------------------------------------------------------------------------------------------
     ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL_NO_DTOR(Session);
@@ -138,6 +213,7 @@ namespace Roar
     //------------------------------------------------------------------------------------------------------------------
     bool Session::onWriteComplete(bool expectsClose, boost::beast::error_code ec, std::size_t)
     {
+        // The next request is already being read, if the connection is reused (see SendIntermediate::enqueueWrite).
         if (ec || expectsClose)
         {
             close();
@@ -146,8 +222,93 @@ namespace Roar
         return false;
     }
     //------------------------------------------------------------------------------------------------------------------
+    void Session::enqueueResponse(std::function<void()> write)
+    {
+        {
+            std::scoped_lock lock{impl_->responseQueueMutex};
+            if (impl_->responseInFlight)
+            {
+                impl_->responseQueue.push_back(std::move(write));
+                return;
+            }
+            impl_->responseInFlight = true;
+        }
+        write();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Session::onResponseWritten(bool completesRequest)
+    {
+        std::function<void()> next;
+        {
+            std::scoped_lock lock{impl_->responseQueueMutex};
+            // Responses are written in request order, so the oldest ticket belongs to this response.
+            if (completesRequest && !impl_->requestTickets.empty())
+                impl_->requestTickets.pop_front();
+
+            if (impl_->responseQueue.empty())
+            {
+                impl_->responseInFlight = false;
+
+                // Writes reset the stream timeout, so the idle timeout of a pending header read has to be restored.
+                if (impl_->awaitingHeader)
+                {
+                    impl_->withStreamDo([this](auto& stream) {
+                        boost::beast::get_lowest_layer(stream).expires_after(impl_->idleTimeout);
+                    });
+                }
+            }
+            else
+            {
+                next = std::move(impl_->responseQueue.front());
+                impl_->responseQueue.pop_front();
+            }
+        }
+
+        if (next)
+            next();
+        else if (impl_->closeWhenWritten)
+            close();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Session::onReadComplete()
+    {
+        impl_->requestBodyConsumed = true;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool Session::keepAliveAllowed() const
+    {
+        // A request body that was not read would be misinterpreted as the next request header.
+        return impl_->requestKeepAlive && impl_->requestBodyConsumed &&
+            (impl_->maxRequestsPerConnection == 0 || impl_->requestCount < impl_->maxRequestsPerConnection);
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool Session::isHeadRequest() const
+    {
+        return impl_->headRequest;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::string_view Session::acceptEncoding() const
+    {
+        return impl_->acceptEncoding;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    bool Session::zeroCopyFileWritesAllowed() const
+    {
+        // sendfile bypasses the TLS layer and the rate policy of the stream.
+        return std::holds_alternative<Detail::StreamType>(impl_->stream) && !impl_->writeLimited &&
+            !impl_->headRequest;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    std::optional<boost::asio::any_io_executor> Session::fileIoExecutor() const
+    {
+        if (!impl_->fileIoPool)
+            return std::nullopt;
+        return impl_->fileIoPool->get_executor();
+    }
+    //------------------------------------------------------------------------------------------------------------------
     void Session::writeLimit(std::size_t bytesPerSecond)
     {
+        impl_->writeLimited = bytesPerSecond != std::numeric_limits<std::size_t>::max();
         withStreamDo([bytesPerSecond]<typename StreamT>(StreamT& stream) {
             if constexpr (std::is_same_v<std::decay_t<StreamT>, Detail::StreamType>)
                 stream.rate_policy().write_limit(bytesPerSecond);
@@ -191,7 +352,16 @@ namespace Roar
         impl_->headerParser = std::make_shared<boost::beast::http::request_parser<boost::beast::http::empty_body>>();
 
         impl_->withStreamDo([this](auto& stream) {
-            boost::beast::get_lowest_layer(stream).expires_after(sessionTimeout);
+            // Connections that are kept alive may only idle for so long.
+            // While a response is still being written, its write timeout stays in effect.
+            {
+                std::scoped_lock lock{impl_->responseQueueMutex};
+                impl_->awaitingHeader = true;
+                if (impl_->requestCount == 0)
+                    boost::beast::get_lowest_layer(stream).expires_after(sessionTimeout);
+                else if (!impl_->responseInFlight)
+                    boost::beast::get_lowest_layer(stream).expires_after(impl_->idleTimeout);
+            }
             impl_->headerParser->header_limit(defaultHeaderLimit);
 
             // Do not attempt to read available body bytes.
@@ -202,34 +372,87 @@ namespace Roar
                 impl_->buffer,
                 *impl_->headerParser,
                 [self = this->shared_from_this()](boost::beast::error_code ec, std::size_t) {
+                    bool responseInFlight = false;
+                    {
+                        std::scoped_lock lock{self->impl_->responseQueueMutex};
+                        self->impl_->awaitingHeader = false;
+                        responseInFlight = self->impl_->responseInFlight;
+                        if (ec == boost::beast::http::error::end_of_stream && responseInFlight)
+                            self->impl_->closeWhenWritten = true;
+                    }
+
                     if (ec)
                     {
-                        switch (static_cast<boost::beast::http::error>(ec.value()))
+                        // A client that is done sending still gets the responses to its pipelined requests.
+                        if (ec == boost::beast::http::error::end_of_stream)
                         {
-                            case boost::beast::http::error::end_of_stream:
-                            {
-                                return self->close();
-                            }
-                            default:
-                            {
-                                return self->impl_->onError(
-                                    {.error = ec, .additionalInfo = "Error during header read."});
-                            }
+                            if (!responseInFlight)
+                                self->close();
+                            return;
                         }
-                    }
 
-                    if (auto router = self->impl_->router.lock(); router)
-                    {
-                        router->followRoute(
-                            *self, Request<boost::beast::http::empty_body>{self->impl_->headerParser->get()});
+                        // Idle keep alive connections timing out or being dropped by the client are not errors.
+                        if (self->impl_->requestCount > 0 &&
+                            (ec == boost::beast::error::timeout || ec == boost::asio::ssl::error::stream_truncated))
+                            return;
+
+                        return self->impl_->onError({.error = ec, .additionalInfo = "Error during header read."});
                     }
+
+                    auto const& header = self->impl_->headerParser->get();
+                    ++self->impl_->requestCount;
+                    self->impl_->requestKeepAlive = header.keep_alive();
+                    self->impl_->requestBodyConsumed = self->impl_->headerParser->is_done();
+                    self->impl_->headRequest = header.method() == boost::beast::http::verb::head;
+                    self->impl_->acceptEncoding = std::string{header[boost::beast::http::field::accept_encoding]};
+                    self->dispatchRequest();
+                });
+        });
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void Session::dispatchRequest()
+    {
+        using namespace boost::beast::http;
+
+        auto const& admissionControl = impl_->admissionControl;
+        if (!admissionControl)
+            return routeRequest();
+
+        // Rejected requests get an empty ticket, so that every response pops exactly one.
+        auto ticket = admissionControl->tryAdmitRequest();
+        const bool admitted = static_cast<bool>(ticket);
+        {
+            std::scoped_lock lock{impl_->responseQueueMutex};
+            impl_->requestTickets.push_back(std::move(ticket));
+        }
+        if (!admitted)
+            return sendStandardResponse(status::service_unavailable, "Too many requests in flight.");
+
+        if (!admissionControl->measuresQueueingDelay())
+            return routeRequest();
+
+        // The queueing delay is how long the handler has to wait for the executor after the header was parsed.
+        impl_->withStreamDo([this](auto& stream) {
+            boost::asio::post(
+                stream.get_executor(),
+                [self = this->shared_from_this(), parsedAt = std::chrono::steady_clock::now()]() {
+                    if (self->impl_->admissionControl->shouldShed(std::chrono::steady_clock::now() - parsedAt))
+                        return self->sendStandardResponse(status::service_unavailable, "Server is overloaded.");
+                    self->routeRequest();
                 });
         });
     }
     //------------------------------------------------------------------------------------------------------------------
+    void Session::routeRequest()
+    {
+        if (auto router = impl_->router.lock(); router)
+            router->followRoute(*this, Request<boost::beast::http::empty_body>{impl_->headerParser->get()});
+    }
+    //------------------------------------------------------------------------------------------------------------------
     bool Session::isSecure() const
     {
-        return std::holds_alternative<boost::beast::ssl_stream<Detail::StreamType>>(impl_->stream);
+        // Connections with kernel TLS use a plain stream.
+        return impl_->isSecure;
     }
     //------------------------------------------------------------------------------------------------------------------
     void Session::performSslHandshake()
@@ -243,6 +466,16 @@ namespace Roar
 
                     if (ec)
                         return self->impl_->onError({.error = ec, .additionalInfo = "Error during SSL handshake."});
+
+                    try
+                    {
+                        self->impl_->offloadTlsToKernel();
+                    }
+                    catch (std::exception const& exc)
+                    {
+                        return self->impl_->onError(
+                            {.error = exc.what(), .additionalInfo = "Failed to set up kernel TLS."});
+                    }
                     self->readHeader();
                 });
     }
@@ -0,0 +1,390 @@
+#include <roar/ssl/kernel_tls.hpp>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/ssl.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#    include <linux/tls.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#    ifndef SOL_TLS
+#        define SOL_TLS 282
+#    endif
+#    ifndef TCP_ULP
+#        define TCP_ULP 31
+#    endif
+#endif
+
+namespace Roar
+{
+    namespace
+    {
+        struct KernelTlsState
+        {
+            std::vector<unsigned char> clientTrafficSecret;
+            std::vector<unsigned char> serverTrafficSecret;
+            /// Records protected by the current keys, which is the sequence number of the next one.
+            std::uint64_t recordsSent = 0;
+            std::uint64_t recordsReceived = 0;
+
+            ~KernelTlsState()
+            {
+                OPENSSL_cleanse(clientTrafficSecret.data(), clientTrafficSecret.size());
+                OPENSSL_cleanse(serverTrafficSecret.data(), serverTrafficSecret.size());
+            }
+        };
+
+        struct TrafficKeys
+        {
+            std::vector<unsigned char> key;
+            std::array<unsigned char, 4> salt;
+            std::array<unsigned char, 8> iv;
+            std::uint64_t sequence;
+        };
+
+        struct ConnectionKeys
+        {
+            int version;
+            int cipher;
+            TrafficKeys transmit;
+            TrafficKeys receive;
+
+            ~ConnectionKeys()
+            {
+                OPENSSL_cleanse(transmit.key.data(), transmit.key.size());
+                OPENSSL_cleanse(receive.key.data(), receive.key.size());
+            }
+        };
+
+        void freeKernelTlsState(void*, void* state, CRYPTO_EX_DATA*, int, long, void*)
+        {
+            delete static_cast<KernelTlsState*>(state);
+        }
+
+        int contextExDataIndex()
+        {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        int connectionExDataIndex()
+        {
+            static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeKernelTlsState);
+            return index;
+        }
+
+        KernelTlsState& stateOf(SSL const* ssl)
+        {
+            auto* state = static_cast<KernelTlsState*>(SSL_get_ex_data(ssl, connectionExDataIndex()));
+            if (!state)
+            {
+                state = new KernelTlsState{};
+                SSL_set_ex_data(const_cast<SSL*>(ssl), connectionExDataIndex(), state);
+            }
+            return *state;
+        }
+
+        std::vector<unsigned char> fromHex(std::string_view hex)
+        {
+            const auto nibble = [](char c) -> unsigned char {
+                if (c >= '0' && c <= '9')
+                    return static_cast<unsigned char>(c - '0');
+                if (c >= 'a' && c <= 'f')
+                    return static_cast<unsigned char>(c - 'a' + 10);
+                if (c >= 'A' && c <= 'F')
+                    return static_cast<unsigned char>(c - 'A' + 10);
+                return 0;
+            };
+            std::vector<unsigned char> result(hex.size() / 2);
+            for (std::size_t i = 0; i != result.size(); ++i)
+                result[i] = static_cast<unsigned char>((nibble(hex[2 * i]) << 4) | nibble(hex[2 * i + 1]));
+            return result;
+        }
+
+        /**
+         * @brief The kernel needs the traffic secrets of TLS 1.3 connections, which OpenSSL only hands out as key log.
+         */
+        void onKeyLog(SSL const* ssl, char const* line)
+        {
+            const std::string_view entry{line};
+            const auto store = [&entry](std::string_view label, std::vector<unsigned char>& secret) {
+                if (!entry.starts_with(label))
+                    return;
+                OPENSSL_cleanse(secret.data(), secret.size());
+                secret = fromHex(entry.substr(entry.rfind(' ') + 1));
+            };
+            auto& state = stateOf(ssl);
+            store("CLIENT_TRAFFIC_SECRET_0 ", state.clientTrafficSecret);
+            store("SERVER_TRAFFIC_SECRET_0 ", state.serverTrafficSecret);
+        }
+
+        /**
+         * @brief Counts the records protected by the application keys in each direction. Those are the sequence
+         * numbers the kernel has to continue with.
+         */
+        void onMessage(int writing, int, int contentType, void const* buffer, std::size_t length, SSL* ssl, void*)
+        {
+            auto& state = stateOf(ssl);
+            auto& records = writing ? state.recordsSent : state.recordsReceived;
+            const auto firstByte = length > 0 ? *static_cast<unsigned char const*>(buffer) : 0;
+            if (contentType == SSL3_RT_HEADER)
+            {
+                // In TLS 1.2 the Finished message after ChangeCipherSpec is the first record protected by the new keys.
+                if (firstByte == SSL3_RT_CHANGE_CIPHER_SPEC)
+                    records = 0;
+                else
+                    ++records;
+            }
+            else if (
+                SSL_version(ssl) >= TLS1_3_VERSION && contentType == SSL3_RT_HANDSHAKE && firstByte == SSL3_MT_FINISHED)
+            {
+                // In TLS 1.3 the application keys are used after the Finished message.
+                records = 0;
+            }
+        }
+
+        std::vector<unsigned char> derive(EVP_PKEY_CTX* ctx, std::size_t length)
+        {
+            std::vector<unsigned char> result(length);
+            std::size_t resultLength = length;
+            if (EVP_PKEY_derive(ctx, result.data(), &resultLength) <= 0 || resultLength != length)
+                return {};
+            return result;
+        }
+
+        /**
+         * @brief HKDF-Expand-Label of RFC 8446 with an empty context.
+         */
+        std::vector<unsigned char> expandLabel(
+            EVP_MD const* digest,
+            std::vector<unsigned char> const& secret,
+            std::string_view label,
+            std::size_t length)
+        {
+            const std::string fullLabel = std::string{"tls13 "} + std::string{label};
+            std::vector<unsigned char> info{
+                static_cast<unsigned char>(length >> 8),
+                static_cast<unsigned char>(length & 0xFF),
+                static_cast<unsigned char>(fullLabel.size())};
+            info.insert(info.end(), fullLabel.begin(), fullLabel.end());
+            info.push_back(0);
+
+            std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx{
+                EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr), &EVP_PKEY_CTX_free};
+            if (!ctx || EVP_PKEY_derive_init(ctx.get()) <= 0 ||
+                EVP_PKEY_CTX_hkdf_mode(ctx.get(), EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) <= 0 ||
+                EVP_PKEY_CTX_set_hkdf_md(ctx.get(), digest) <= 0 ||
+                EVP_PKEY_CTX_set1_hkdf_key(ctx.get(), secret.data(), static_cast<int>(secret.size())) <= 0 ||
+                EVP_PKEY_CTX_add1_hkdf_info(ctx.get(), info.data(), static_cast<int>(info.size())) <= 0)
+            {
+                return {};
+            }
+            return derive(ctx.get(), length);
+        }
+
+        /**
+         * @brief The TLS 1.2 key block of RFC 5246 section 6.3.
+         */
+        std::vector<unsigned char> keyBlock(SSL* ssl, EVP_MD const* digest, std::size_t length)
+        {
+            std::array<unsigned char, SSL_MAX_MASTER_KEY_LENGTH> masterKey;
+            const auto masterKeyLength =
+                SSL_SESSION_get_master_key(SSL_get_session(ssl), masterKey.data(), masterKey.size());
+            std::array<unsigned char, SSL3_RANDOM_SIZE> clientRandom;
+            std::array<unsigned char, SSL3_RANDOM_SIZE> serverRandom;
+            SSL_get_client_random(ssl, clientRandom.data(), clientRandom.size());
+            SSL_get_server_random(ssl, serverRandom.data(), serverRandom.size());
+
+            constexpr std::string_view label = "key expansion";
+            std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx{
+                EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr), &EVP_PKEY_CTX_free};
+            const auto addSeed = [&ctx](unsigned char const* seed, std::size_t length) {
+                return EVP_PKEY_CTX_add1_tls1_prf_seed(ctx.get(), seed, static_cast<int>(length)) > 0;
+            };
+            std::vector<unsigned char> result;
+            if (ctx && EVP_PKEY_derive_init(ctx.get()) > 0 && EVP_PKEY_CTX_set_tls1_prf_md(ctx.get(), digest) > 0 &&
+                EVP_PKEY_CTX_set1_tls1_prf_secret(ctx.get(), masterKey.data(), static_cast<int>(masterKeyLength)) > 0 &&
+                addSeed(reinterpret_cast<unsigned char const*>(label.data()), label.size()) &&
+                addSeed(serverRandom.data(), serverRandom.size()) && addSeed(clientRandom.data(), clientRandom.size()))
+            {
+                result = derive(ctx.get(), length);
+            }
+            OPENSSL_cleanse(masterKey.data(), masterKey.size());
+            return result;
+        }
+
+        std::array<unsigned char, 8> bigEndian(std::uint64_t value)
+        {
+            std::array<unsigned char, 8> result;
+            for (std::size_t i = 0; i != result.size(); ++i)
+                result[result.size() - 1 - i] = static_cast<unsigned char>(value >> (8 * i));
+            return result;
+        }
+
+        /**
+         * @brief Derives the keys for both directions of a TLS 1.2 or 1.3 AES-GCM connection.
+         */
+        std::optional<ConnectionKeys> connectionKeys(SSL* ssl)
+        {
+            const auto* cipher = SSL_get_current_cipher(ssl);
+            if (!cipher)
+                return std::nullopt;
+            const int cipherNid = SSL_CIPHER_get_cipher_nid(cipher);
+            std::size_t keyLength = 0;
+            if (cipherNid == NID_aes_128_gcm)
+                keyLength = 16;
+            else if (cipherNid == NID_aes_256_gcm)
+                keyLength = 32;
+            else
+                return std::nullopt;
+
+            const auto* digest = SSL_CIPHER_get_handshake_digest(cipher);
+            auto const& state = stateOf(ssl);
+            ConnectionKeys keys{
+                .version = SSL_version(ssl),
+                .cipher = cipherNid,
+                .transmit = {.key = {}, .salt = {}, .iv = {}, .sequence = state.recordsSent},
+                .receive = {.key = {}, .salt = {}, .iv = {}, .sequence = state.recordsReceived},
+            };
+
+            if (keys.version == TLS1_3_VERSION)
+            {
+                const auto fromSecret = [&](std::vector<unsigned char> const& secret, TrafficKeys& traffic) {
+                    if (secret.empty())
+                        return false;
+                    traffic.key = expandLabel(digest, secret, "key", keyLength);
+                    const auto iv = expandLabel(digest, secret, "iv", 12);
+                    if (traffic.key.empty() || iv.size() != 12)
+                        return false;
+                    std::copy_n(iv.begin(), 4, traffic.salt.begin());
+                    std::copy_n(iv.begin() + 4, 8, traffic.iv.begin());
+                    return true;
+                };
+                if (!fromSecret(state.serverTrafficSecret, keys.transmit) ||
+                    !fromSecret(state.clientTrafficSecret, keys.receive))
+                    return std::nullopt;
+            }
+            else if (keys.version == TLS1_2_VERSION)
+            {
+                // client key | server key | client salt | server salt, AEAD ciphers have no mac keys.
+                auto block = keyBlock(ssl, digest, 2 * keyLength + 8);
+                if (block.empty())
+                    return std::nullopt;
+                keys.receive.key.assign(block.begin(), block.begin() + keyLength);
+                keys.transmit.key.assign(block.begin() + keyLength, block.begin() + 2 * keyLength);
+                std::copy_n(block.begin() + 2 * keyLength, 4, keys.receive.salt.begin());
+                std::copy_n(block.begin() + 2 * keyLength + 4, 4, keys.transmit.salt.begin());
+                // The explicit nonce only has to be unique, the record sequence number is.
+                keys.transmit.iv = bigEndian(keys.transmit.sequence);
+                keys.receive.iv = bigEndian(keys.receive.sequence);
+                OPENSSL_cleanse(block.data(), block.size());
+            }
+            else
+                return std::nullopt;
+
+            return keys;
+        }
+
+#ifdef __linux__
+        template <typename CryptoInfoT>
+        bool
+        setCryptoInfo(int socket, int direction, int version, unsigned short cipherType, TrafficKeys const& traffic)
+        {
+            CryptoInfoT info{};
+            info.info.version = version == TLS1_3_VERSION ? TLS_1_3_VERSION : TLS_1_2_VERSION;
+            info.info.cipher_type = cipherType;
+            if (traffic.key.size() != sizeof(info.key))
+                return false;
+            std::copy(traffic.key.begin(), traffic.key.end(), info.key);
+            std::copy(traffic.salt.begin(), traffic.salt.end(), info.salt);
+            std::copy(traffic.iv.begin(), traffic.iv.end(), info.iv);
+            const auto sequence = bigEndian(traffic.sequence);
+            std::copy(sequence.begin(), sequence.end(), info.rec_seq);
+            const bool success = setsockopt(socket, SOL_TLS, direction, &info, sizeof(info)) == 0;
+            OPENSSL_cleanse(&info, sizeof(info));
+            return success;
+        }
+
+        bool setCryptoInfo(int socket, int direction, ConnectionKeys const& keys, TrafficKeys const& traffic)
+        {
+            if (keys.cipher == NID_aes_128_gcm)
+            {
+                return setCryptoInfo<tls12_crypto_info_aes_gcm_128>(
+                    socket, direction, keys.version, TLS_CIPHER_AES_GCM_128, traffic);
+            }
+            return setCryptoInfo<tls12_crypto_info_aes_gcm_256>(
+                socket, direction, keys.version, TLS_CIPHER_AES_GCM_256, traffic);
+        }
+#endif
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void enableKernelTls([[maybe_unused]] boost::asio::ssl::context& ctx)
+    {
+#ifdef __linux__
+        auto* native = ctx.native_handle();
+        SSL_CTX_set_ex_data(native, contextExDataIndex(), native);
+        SSL_CTX_set_keylog_callback(native, &onKeyLog);
+        SSL_CTX_set_msg_callback(native, &onMessage);
+#endif
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    namespace Detail
+    {
+        bool kernelTlsRequested(SSL* ssl)
+        {
+            return SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextExDataIndex()) != nullptr;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+        KernelTlsOffload offloadTlsToKernel(SSL* ssl, [[maybe_unused]] int socket)
+        {
+            KernelTlsOffload result{.offloaded = false, .plaintext = {}};
+            if (!SSL_is_init_finished(ssl) || BIO_ctrl_wpending(SSL_get_wbio(ssl)) > 0)
+                return result;
+
+            // The kernel only sees what is still in the socket, so decrypt what OpenSSL already received.
+            while (SSL_pending(ssl) > 0 || BIO_ctrl_pending(SSL_get_rbio(ssl)) > 0)
+            {
+                std::array<char, 4096> buffer;
+                const int amount = SSL_read(ssl, buffer.data(), static_cast<int>(buffer.size()));
+                if (amount <= 0)
+                    return result;
+                result.plaintext.append(buffer.data(), static_cast<std::size_t>(amount));
+            }
+
+#ifdef __linux__
+            const auto keys = connectionKeys(ssl);
+            if (!keys)
+                return result;
+
+            // Without the tls module the kernel refuses the upper layer protocol and nothing changes.
+            if (setsockopt(socket, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0)
+                return result;
+            // A socket with the tls module, but no keys, still behaves like a plain socket.
+            if (!setCryptoInfo(socket, TLS_TX, *keys, keys->transmit))
+                return result;
+            if (!setCryptoInfo(socket, TLS_RX, *keys, keys->receive))
+                throw std::system_error{errno, std::system_category(), "Kernel TLS rejected the receiving keys"};
+
+            auto& state = stateOf(ssl);
+            OPENSSL_cleanse(state.clientTrafficSecret.data(), state.clientTrafficSecret.size());
+            OPENSSL_cleanse(state.serverTrafficSecret.data(), state.serverTrafficSecret.size());
+            result.offloaded = true;
+#endif
+            return result;
+        }
+    }
+}
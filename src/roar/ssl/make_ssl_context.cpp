@@ -41,6 +41,12 @@ namespace Roar
             ctx.ctx.use_tmp_dh(
                 boost::asio::buffer(ctx.diffieHellmanParameters.data(), ctx.diffieHellmanParameters.size()));
         }
+
+        if (ctx.sessionResumption)
+            ctx.sessionResumptionState = SslSessionResumption::install(ctx.ctx, *ctx.sessionResumption);
+
+        if (ctx.kernelTls)
+            enableKernelTls(ctx.ctx);
     }
 
     boost::asio::ssl::context makeSslContext(const std::string& certificate, const std::string& privateKey)
@@ -0,0 +1,421 @@
+#include <roar/ssl/session_resumption.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#    include <openssl/core_names.h>
+#else
+#    include <openssl/hmac.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Roar
+{
+    namespace
+    {
+        int resumptionExDataIndex()
+        {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        struct TicketKey
+        {
+            std::array<unsigned char, 16> name;
+            std::array<unsigned char, 32> aesKey;
+            std::array<unsigned char, 32> hmacKey;
+            std::chrono::steady_clock::time_point created;
+
+            static TicketKey generate()
+            {
+                TicketKey key{};
+                if (RAND_bytes(key.name.data(), static_cast<int>(key.name.size())) != 1 ||
+                    RAND_bytes(key.aesKey.data(), static_cast<int>(key.aesKey.size())) != 1 ||
+                    RAND_bytes(key.hmacKey.data(), static_cast<int>(key.hmacKey.size())) != 1)
+                {
+                    throw std::runtime_error{"Could not generate session ticket key."};
+                }
+                key.created = std::chrono::steady_clock::now();
+                return key;
+            }
+        };
+
+        class SessionCacheShard
+        {
+          public:
+            void insert(std::string id, std::vector<unsigned char> session, std::size_t capacity)
+            {
+                std::scoped_lock lock{mutex_};
+                if (auto iter = index_.find(id); iter != std::end(index_))
+                {
+                    lru_.erase(iter->second);
+                    index_.erase(iter);
+                }
+                lru_.push_front(Entry{.id = id, .session = std::move(session)});
+                index_.emplace(std::move(id), std::begin(lru_));
+                while (lru_.size() > capacity)
+                {
+                    index_.erase(lru_.back().id);
+                    lru_.pop_back();
+                }
+            }
+
+            std::optional<std::vector<unsigned char>> find(std::string const& id)
+            {
+                std::scoped_lock lock{mutex_};
+                auto iter = index_.find(id);
+                if (iter == std::end(index_))
+                    return std::nullopt;
+                lru_.splice(std::begin(lru_), lru_, iter->second);
+                return iter->second->session;
+            }
+
+            void erase(std::string const& id)
+            {
+                std::scoped_lock lock{mutex_};
+                if (auto iter = index_.find(id); iter != std::end(index_))
+                {
+                    lru_.erase(iter->second);
+                    index_.erase(iter);
+                }
+            }
+
+            std::size_t size() const
+            {
+                std::scoped_lock lock{mutex_};
+                return lru_.size();
+            }
+
+          private:
+            struct Entry
+            {
+                std::string id;
+                std::vector<unsigned char> session;
+            };
+
+            mutable std::mutex mutex_{};
+            std::list<Entry> lru_{};
+            std::unordered_map<std::string, std::list<Entry>::iterator> index_{};
+        };
+    }
+    // ##################################################################################################################
+    struct SslSessionResumption::Implementation
+    {
+        SslSessionResumptionOptions options;
+        std::vector<SessionCacheShard> shards;
+        std::size_t shardCapacity;
+        std::shared_mutex ticketKeyMutex;
+        TicketKey currentTicketKey;
+        std::optional<TicketKey> previousTicketKey;
+        std::atomic<std::uint64_t> fullHandshakes;
+        std::atomic<std::uint64_t> resumedHandshakes;
+        std::atomic<std::uint64_t> cacheHits;
+        std::atomic<std::uint64_t> cacheMisses;
+        std::atomic<std::uint64_t> ticketKeyRotations;
+        SSL_CTX* context;
+
+        Implementation(SslSessionResumptionOptions options)
+            : options{std::move(options)}
+            , shards(std::max(this->options.cacheShards, std::size_t{1}))
+            , shardCapacity{(this->options.cacheSize + shards.size() - 1) / shards.size()}
+            , ticketKeyMutex{}
+            , currentTicketKey{TicketKey::generate()}
+            , previousTicketKey{}
+            , fullHandshakes{0}
+            , resumedHandshakes{0}
+            , cacheHits{0}
+            , cacheMisses{0}
+            , ticketKeyRotations{0}
+            , context{nullptr}
+        {}
+        ~Implementation()
+        {
+            // The context may outlive this object, its callbacks must not find it anymore.
+            if (context)
+                SSL_CTX_set_ex_data(context, resumptionExDataIndex(), nullptr);
+        }
+        Implementation(Implementation const&) = delete;
+        Implementation(Implementation&&) = delete;
+        Implementation& operator=(Implementation const&) = delete;
+        Implementation& operator=(Implementation&&) = delete;
+
+        SessionCacheShard& shardFor(std::string const& id)
+        {
+            return shards[std::hash<std::string>{}(id) % shards.size()];
+        }
+
+        static Implementation* fromContext(SSL_CTX const* ctx)
+        {
+            auto* resumption = static_cast<SslSessionResumption*>(SSL_CTX_get_ex_data(ctx, resumptionExDataIndex()));
+            return resumption ? resumption->impl_.get() : nullptr;
+        }
+
+        static Implementation* fromSsl(SSL const* ssl)
+        {
+            return fromContext(SSL_get_SSL_CTX(ssl));
+        }
+
+        static std::string sessionId(SSL_SESSION* session)
+        {
+            unsigned int length = 0;
+            auto const* id = SSL_SESSION_get_id(session, &length);
+            return std::string{reinterpret_cast<char const*>(id), length};
+        }
+
+        static int onNewSession(SSL* ssl, SSL_SESSION* session)
+        {
+            auto* impl = fromSsl(ssl);
+            const int length = i2d_SSL_SESSION(session, nullptr);
+            if (!impl || length <= 0)
+                return 0;
+            // TLS 1.3 sessions are resumed from their stateless ticket and never looked up by id.
+            if (impl->options.sessionTickets && SSL_version(ssl) >= TLS1_3_VERSION)
+                return 0;
+            std::vector<unsigned char> serialized(static_cast<std::size_t>(length));
+            auto* out = serialized.data();
+            i2d_SSL_SESSION(session, &out);
+
+            auto id = sessionId(session);
+            impl->shardFor(id).insert(std::move(id), std::move(serialized), impl->shardCapacity);
+            // The session is stored serialized, OpenSSL keeps its reference.
+            return 0;
+        }
+
+        static SSL_SESSION* onGetSession(SSL* ssl, unsigned char const* id, int idLength, int* copy)
+        {
+            auto* impl = fromSsl(ssl);
+            *copy = 0;
+            if (!impl)
+                return nullptr;
+            const std::string key{reinterpret_cast<char const*>(id), static_cast<std::size_t>(idLength)};
+            const auto serialized = impl->shardFor(key).find(key);
+            if (!serialized)
+            {
+                ++impl->cacheMisses;
+                return nullptr;
+            }
+            ++impl->cacheHits;
+            auto const* in = serialized->data();
+            return d2i_SSL_SESSION(nullptr, &in, static_cast<long>(serialized->size()));
+        }
+
+        static void onRemoveSession(SSL_CTX* ctx, SSL_SESSION* session)
+        {
+            auto* impl = fromContext(ctx);
+            if (!impl)
+                return;
+            const auto id = sessionId(session);
+            impl->shardFor(id).erase(id);
+        }
+
+        static void onInfo(SSL const* ssl, int where, int)
+        {
+            if (!(where & SSL_CB_HANDSHAKE_DONE))
+                return;
+            auto* impl = fromSsl(ssl);
+            if (!impl)
+                return;
+            if (SSL_session_reused(ssl))
+                ++impl->resumedHandshakes;
+            else
+                ++impl->fullHandshakes;
+        }
+
+        /// Must be called with ticketKeyMutex held.
+        bool ticketKeyIsDue() const
+        {
+            return std::chrono::steady_clock::now() - currentTicketKey.created >= options.ticketKeyRotationInterval;
+        }
+
+        void rotateTicketKeyIfDue()
+        {
+            {
+                std::shared_lock lock{ticketKeyMutex};
+                if (!ticketKeyIsDue())
+                    return;
+            }
+            auto fresh = TicketKey::generate();
+            std::scoped_lock lock{ticketKeyMutex};
+            // Concurrent handshakes may all have seen the old key, only the first one rotates.
+            if (!ticketKeyIsDue())
+                return;
+            previousTicketKey = std::exchange(currentTicketKey, std::move(fresh));
+            ++ticketKeyRotations;
+        }
+
+        void rotateTicketKey()
+        {
+            auto fresh = TicketKey::generate();
+            std::scoped_lock lock{ticketKeyMutex};
+            previousTicketKey = std::exchange(currentTicketKey, std::move(fresh));
+            ++ticketKeyRotations;
+        }
+
+        /// Returns 1 for the current key, 2 if the ticket has to be renewed and 0 for unknown keys.
+        template <typename InitMacT>
+        int onTicketKey(
+            SSL const* ssl,
+            unsigned char* keyName,
+            unsigned char* iv,
+            EVP_CIPHER_CTX* cipherContext,
+            int encrypt,
+            InitMacT&& initMac)
+        {
+            rotateTicketKeyIfDue();
+            std::shared_lock lock{ticketKeyMutex};
+            if (encrypt)
+            {
+                if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1)
+                    return -1;
+                std::memcpy(keyName, currentTicketKey.name.data(), currentTicketKey.name.size());
+                if (EVP_EncryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, currentTicketKey.aesKey.data(), iv) !=
+                        1 ||
+                    !initMac(currentTicketKey.hmacKey))
+                    return -1;
+                return 1;
+            }
+
+            TicketKey const* key = nullptr;
+            if (std::memcmp(keyName, currentTicketKey.name.data(), currentTicketKey.name.size()) == 0)
+                key = &currentTicketKey;
+            else if (
+                previousTicketKey &&
+                std::memcmp(keyName, previousTicketKey->name.data(), previousTicketKey->name.size()) == 0)
+                key = &*previousTicketKey;
+            else
+                return 0;
+
+            if (EVP_DecryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, key->aesKey.data(), iv) != 1 ||
+                !initMac(key->hmacKey))
+                return -1;
+            // TLS 1.3 clients only receive a new ticket after resumption if it is renewed, and should not reuse tickets.
+            return key == &currentTicketKey && SSL_version(ssl) < TLS1_3_VERSION ? 1 : 2;
+        }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        static int onTicketKeyEvp(
+            SSL* ssl,
+            unsigned char* keyName,
+            unsigned char* iv,
+            EVP_CIPHER_CTX* cipherContext,
+            EVP_MAC_CTX* macContext,
+            int encrypt)
+        {
+            auto* impl = fromSsl(ssl);
+            if (!impl)
+                return 0;
+            return impl->onTicketKey(
+                ssl, keyName, iv, cipherContext, encrypt, [macContext](std::array<unsigned char, 32> const& hmacKey) {
+                    std::array<OSSL_PARAM, 3> params{
+                        OSSL_PARAM_construct_octet_string(
+                            OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(hmacKey.data()), hmacKey.size()),
+                        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+                        OSSL_PARAM_construct_end(),
+                    };
+                    return EVP_MAC_CTX_set_params(macContext, params.data()) == 1;
+                });
+        }
+#else
+        static int onTicketKeyHmac(
+            SSL* ssl,
+            unsigned char* keyName,
+            unsigned char* iv,
+            EVP_CIPHER_CTX* cipherContext,
+            HMAC_CTX* hmacContext,
+            int encrypt)
+        {
+            auto* impl = fromSsl(ssl);
+            if (!impl)
+                return 0;
+            return impl->onTicketKey(
+                ssl, keyName, iv, cipherContext, encrypt, [hmacContext](std::array<unsigned char, 32> const& hmacKey) {
+                    return HMAC_Init_ex(
+                               hmacContext, hmacKey.data(), static_cast<int>(hmacKey.size()), EVP_sha256(), nullptr) ==
+                        1;
+                });
+        }
+#endif
+    };
+    // ##################################################################################################################
+    SslSessionResumption::SslSessionResumption(SslSessionResumptionOptions options)
+        : impl_{std::make_unique<Implementation>(std::move(options))}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL_NO_MOVE(SslSessionResumption);
+    //------------------------------------------------------------------------------------------------------------------
+    std::shared_ptr<SslSessionResumption>
+    SslSessionResumption::install(boost::asio::ssl::context& ctx, SslSessionResumptionOptions options)
+    {
+        // The callbacks find this object through the ex data of the context.
+        std::shared_ptr<SslSessionResumption> resumption{new SslSessionResumption(std::move(options))};
+        auto* handle = ctx.native_handle();
+        SSL_CTX_set_ex_data(handle, resumptionExDataIndex(), resumption.get());
+        resumption->impl_->context = handle;
+
+        auto const& opts = resumption->impl_->options;
+        SSL_CTX_set_timeout(handle, static_cast<long>(opts.sessionLifetime.count()));
+        SSL_CTX_set_info_callback(handle, &Implementation::onInfo);
+
+        static constexpr unsigned char sessionIdContext[] = "roar";
+        SSL_CTX_set_session_id_context(handle, sessionIdContext, sizeof(sessionIdContext) - 1);
+
+        if (opts.cacheSize > 0)
+        {
+            SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+            SSL_CTX_sess_set_new_cb(handle, &Implementation::onNewSession);
+            SSL_CTX_sess_set_get_cb(handle, &Implementation::onGetSession);
+            SSL_CTX_sess_set_remove_cb(handle, &Implementation::onRemoveSession);
+        }
+        else
+            SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_OFF);
+
+        if (opts.sessionTickets)
+        {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            SSL_CTX_set_tlsext_ticket_key_evp_cb(handle, &Implementation::onTicketKeyEvp);
+#else
+            SSL_CTX_set_tlsext_ticket_key_cb(handle, &Implementation::onTicketKeyHmac);
+#endif
+        }
+        else
+            SSL_CTX_set_options(handle, SSL_OP_NO_TICKET);
+
+        return resumption;
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    SslSessionStatistics SslSessionResumption::statistics() const
+    {
+        std::uint64_t cachedSessions = 0;
+        for (auto const& shard : impl_->shards)
+            cachedSessions += shard.size();
+
+        return SslSessionStatistics{
+            .fullHandshakes = impl_->fullHandshakes.load(),
+            .resumedHandshakes = impl_->resumedHandshakes.load(),
+            .cacheHits = impl_->cacheHits.load(),
+            .cacheMisses = impl_->cacheMisses.load(),
+            .cachedSessions = cachedSessions,
+            .ticketKeyRotations = impl_->ticketKeyRotations.load(),
+        };
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void SslSessionResumption::rotateTicketKey()
+    {
+        impl_->rotateTicketKey();
+    }
+    // ##################################################################################################################
+}
@@ -1,49 +1,143 @@
 #include <roar/url/encode.hpp>
+#include <roar/detail/character_scan.hpp>
 
-#include <curl/curl.h>
-#include <roar/curl/instance.hpp>
-
-#include <stdexcept>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 namespace Roar
 {
-    std::string urlEncode(const std::string& source)
+    namespace
     {
-        // Curl crashes on empty paths.
-        if (source.empty())
-            return {};
+        constexpr char hexDigits[] = "0123456789ABCDEF";
 
-        Curl::Instance temporaryInstance;
-        std::string encoded;
-        auto* escaped =
-            curl_easy_escape(static_cast<CURL*>(temporaryInstance), source.c_str(), static_cast<int>(source.length()));
-        if (escaped != nullptr)
+        constexpr bool isUnreserved(char c)
+        {
+            return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' ||
+                c == '.' || c == '_' || c == '~';
+        }
+
+        /**
+         * @brief Returns the length of the run of unreserved characters at the start of [begin, end).
+         */
+        std::size_t unreservedRun(char const* begin, char const* end)
+        {
+            char const* const start = begin;
+#ifdef ROAR_CHARACTER_SCAN_SSE2
+            // Signed compares, bytes >= 0x80 are negative and never in range.
+            const auto inRange = [](__m128i block, char low, char high) {
+                return _mm_and_si128(
+                    _mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(low - 1))),
+                    _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(high + 1))));
+            };
+            while (end - begin >= 16)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin));
+                __m128i unreserved = _mm_or_si128(
+                    _mm_or_si128(inRange(block, 'A', 'Z'), inRange(block, 'a', 'z')), inRange(block, '0', '9'));
+                for (char c : {'-', '.', '_', '~'})
+                    unreserved = _mm_or_si128(unreserved, _mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(unreserved));
+                if (mask != 0xFFFF)
+                    return static_cast<std::size_t>(begin - start) + std::countr_one(mask);
+                begin += 16;
+            }
+#else
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                constexpr std::uint64_t ones = 0x0101010101010101ULL;
+                constexpr std::uint64_t highBits = 0x8080808080808080ULL;
+                // Works on the low 7 bits of every byte, so additions never carry into the next byte.
+                const auto atLeast = [](std::uint64_t low7, unsigned char bound) {
+                    return low7 + ones * (0x80 - bound);
+                };
+                const auto atMost = [](std::uint64_t low7, unsigned char bound) {
+                    return ~(low7 + ones * (0x7F - bound));
+                };
+                const auto equals = [](std::uint64_t low7, unsigned char value) {
+                    return ~((low7 ^ (ones * value)) + ones * 0x7F);
+                };
+                while (end - begin >= 8)
+                {
+                    std::uint64_t word;
+                    std::memcpy(&word, begin, sizeof(word));
+                    const std::uint64_t low7 = word & ~highBits;
+                    const std::uint64_t unreserved = ~word &
+                        ((atLeast(low7, 'A') & atMost(low7, 'Z')) | (atLeast(low7, 'a') & atMost(low7, 'z')) |
+                         (atLeast(low7, '0') & atMost(low7, '9')) | equals(low7, '-') | equals(low7, '.') |
+                         equals(low7, '_') | equals(low7, '~')) &
+                        highBits;
+                    if (unreserved != highBits)
+                        return static_cast<std::size_t>(begin - start) + std::countr_zero(~unreserved & highBits) / 8;
+                    begin += 8;
+                }
+            }
+#endif
+            while (begin != end && isUnreserved(*begin))
+                ++begin;
+            return static_cast<std::size_t>(begin - start);
+        }
+    }
+
+    void urlEncode(std::string_view source, std::string& output)
+    {
+        output.reserve(output.size() + source.size());
+        while (!source.empty())
         {
-            encoded = escaped;
-            curl_free(escaped);
+            const auto run = unreservedRun(source.data(), source.data() + source.size());
+            output.append(source.data(), run);
+            source.remove_prefix(run);
+            // Reserved characters often come in groups (UTF-8 sequences), so encode them without scanning.
+            while (!source.empty() && !isUnreserved(source.front()))
+            {
+                const auto byte = static_cast<unsigned char>(source.front());
+                const char escape[3] = {'%', hexDigits[byte >> 4], hexDigits[byte & 0x0F]};
+                output.append(escape, sizeof(escape));
+                source.remove_prefix(1);
+            }
         }
-        else
-            throw std::runtime_error("Could not encode url.");
+    }
 
+    std::string urlEncode(std::string_view source)
+    {
+        std::string encoded;
+        urlEncode(source, encoded);
         return encoded;
     }
 
-    std::string urlDecode(const std::string& source)
+    void urlDecode(std::string_view source, std::string& output)
     {
-        Curl::Instance temporaryInstance;
-        std::string decoded;
-        int actual = 0;
-        auto* dec = curl_easy_unescape(
-            static_cast<CURL*>(temporaryInstance), source.c_str(), static_cast<int>(source.length()), &actual);
-        if (dec != nullptr)
+        output.reserve(output.size() + source.size());
+        char const* position = source.data();
+        char const* const end = position + source.size();
+        while (position != end)
         {
-            decoded = std::string{dec, dec + actual};
-            curl_free(dec);
+            char const* percent = Detail::findFirstOf<'%'>(position, end);
+            output.append(position, percent);
+            if (percent == end)
+                break;
+
+            position = percent + 1;
+            if (end - position >= 2)
+            {
+                const int high = Detail::hexDigitValue(position[0]);
+                const int low = Detail::hexDigitValue(position[1]);
+                if (high >= 0 && low >= 0)
+                {
+                    output.push_back(static_cast<char>(high * 16 + low));
+                    position += 2;
+                    continue;
+                }
+            }
+            output.push_back('%');
         }
-        else
-            throw std::runtime_error("Could not decode url.");
+    }
 
+    std::string urlDecode(std::string_view source)
+    {
+        std::string decoded;
+        urlDecode(source, decoded);
         return decoded;
     }
 } // namespace Roar
@@ -0,0 +1,121 @@
+#include <roar/url/query.hpp>
+#include <roar/detail/character_scan.hpp>
+
+namespace Roar
+{
+    void decodeQueryComponent(std::string_view encoded, std::string& output)
+    {
+        output.reserve(output.size() + encoded.size());
+        char const* position = encoded.data();
+        char const* const end = position + encoded.size();
+        while (position != end)
+        {
+            char const* special = Detail::findFirstOf<'%', '+'>(position, end);
+            output.append(position, special);
+            if (special == end)
+                break;
+
+            position = special + 1;
+            if (*special == '+')
+            {
+                output.push_back(' ');
+                continue;
+            }
+            if (end - position >= 2)
+            {
+                const int high = Detail::hexDigitValue(position[0]);
+                const int low = Detail::hexDigitValue(position[1]);
+                if (high >= 0 && low >= 0)
+                {
+                    output.push_back(static_cast<char>(high * 16 + low));
+                    position += 2;
+                    continue;
+                }
+            }
+            output.push_back('%');
+        }
+    }
+
+    std::string decodeQueryComponent(std::string_view encoded)
+    {
+        std::string decoded;
+        decodeQueryComponent(encoded, decoded);
+        return decoded;
+    }
+
+    std::string QueryView::Parameter::decodedKey() const
+    {
+        if (!keyIsEncoded)
+            return std::string{key};
+        return decodeQueryComponent(key);
+    }
+
+    std::string QueryView::Parameter::decodedValue() const
+    {
+        if (!valueIsEncoded)
+            return std::string{value};
+        return decodeQueryComponent(value);
+    }
+
+    QueryView::QueryView(std::string_view query)
+        : query_{query}
+        , parameters_{}
+    {
+        char const* const end = query.data() + query.size();
+        char const* parameterBegin = query.data();
+        char const* equalSign = nullptr;
+        bool keyIsEncoded = false;
+        bool valueIsEncoded = false;
+
+        // Single pass, every stop of the scan is a separator or a character that needs decoding.
+        for (char const* position = parameterBegin;; ++position)
+        {
+            position = Detail::findFirstOf<'&', ';', '=', '%', '+'>(position, end);
+            if (position == end || *position == '&' || *position == ';')
+            {
+                if (position != parameterBegin)
+                {
+                    char const* keyEnd = equalSign ? equalSign : position;
+                    char const* valueBegin = equalSign ? equalSign + 1 : position;
+                    parameters_.push_back(Parameter{
+                        .key = std::string_view(parameterBegin, static_cast<std::size_t>(keyEnd - parameterBegin)),
+                        .value = std::string_view(valueBegin, static_cast<std::size_t>(position - valueBegin)),
+                        .keyIsEncoded = keyIsEncoded,
+                        .valueIsEncoded = valueIsEncoded,
+                    });
+                }
+                if (position == end)
+                    break;
+                parameterBegin = position + 1;
+                equalSign = nullptr;
+                keyIsEncoded = false;
+                valueIsEncoded = false;
+            }
+            else if (*position == '=')
+            {
+                // Further '=' are part of the value.
+                if (equalSign == nullptr)
+                    equalSign = position;
+            }
+            else
+                (equalSign ? valueIsEncoded : keyIsEncoded) = true;
+        }
+    }
+
+    bool QueryView::keyEquals(Parameter const& parameter, std::string_view key)
+    {
+        if (!parameter.keyIsEncoded)
+            return parameter.key == key;
+        return parameter.decodedKey() == key;
+    }
+
+    QueryView::Parameter const* QueryView::find(std::string_view key) const
+    {
+        for (auto iter = parameters_.rbegin(), end = parameters_.rend(); iter != end; ++iter)
+        {
+            if (keyEquals(*iter, key))
+                return &*iter;
+        }
+        return nullptr;
+    }
+}
@@ -179,38 +179,42 @@ namespace Roar
 
     std::string Url::pathAsString(bool doUrlEncode) const
     {
-        std::stringstream result;
+        std::string result;
         for (auto const& pathPart : path)
         {
+            result.push_back('/');
             if (doUrlEncode)
-                result << "/" << urlEncode(pathPart);
+                urlEncode(pathPart, result);
             else
-                result << "/" << pathPart;
+                result.append(pathPart);
         }
-        return result.str();
+        return result;
     }
 
     std::string Url::toString(bool doUrlEncode, bool includeFragment) const
     {
-        std::stringstream result;
-        result << schemeAndAuthority(doUrlEncode);
-        result << pathAsString(doUrlEncode);
+        std::string result = schemeAndAuthority(doUrlEncode);
+        result.append(pathAsString(doUrlEncode));
         if (!query.empty())
         {
-            result.put('?');
+            result.push_back('?');
             for (auto iter = std::begin(query), end = std::end(query); iter != end; ++iter)
             {
                 if (doUrlEncode)
-                    result << urlEncode(iter->first) << '=' << urlEncode(iter->second);
+                {
+                    urlEncode(iter->first, result);
+                    result.push_back('=');
+                    urlEncode(iter->second, result);
+                }
                 else
-                    result << iter->first << '=' << iter->second;
+                    result.append(iter->first).append(1, '=').append(iter->second);
                 if (std::next(iter) != end)
-                    result << '&';
+                    result.push_back('&');
             }
         }
         if (includeFragment && !fragment.empty())
-            result << '#' << fragment;
-        return result.str();
+            result.append(1, '#').append(fragment);
+        return result;
     }
 
     std::string Url::schemeAndAuthority(bool doUrlEncode) const
@@ -1,5 +1,6 @@
 #include <roar/utility/date.hpp>
 
+#include <ctime>
 #include <sstream>
 #include <iomanip>
 
@@ -8,14 +9,15 @@ namespace Roar
     // #####################################################################################################################
     std::string tmFormatter(std::tm* tm, const char* suffix = nullptr)
     {
-        static constexpr const char* weekdays[] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+        static constexpr const char* weekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
         static constexpr const char* months[] = {
             "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 
         std::stringstream sstr;
-        sstr << weekdays[tm->tm_wday] << ", " << tm->tm_mday << " " << months[tm->tm_mon] << ' ' << (1900 + tm->tm_year)
-             << " " << std::setfill('0') << std::setw(2) << tm->tm_hour << ':' << std::setfill('0') << std::setw(2)
-             << tm->tm_min << ':' << std::setfill('0') << std::setw(2) << tm->tm_sec;
+        sstr << weekdays[tm->tm_wday] << ", " << std::setfill('0') << std::setw(2) << tm->tm_mday << " "
+             << months[tm->tm_mon] << ' ' << (1900 + tm->tm_year) << " " << std::setfill('0') << std::setw(2)
+             << tm->tm_hour << ':' << std::setfill('0') << std::setw(2) << tm->tm_min << ':' << std::setfill('0')
+             << std::setw(2) << tm->tm_sec;
         if (suffix != nullptr)
             sstr << suffix;
         return sstr.str();
@@ -29,6 +31,26 @@ namespace Roar
         : timePoint_{std::chrono::system_clock::now()}
     {}
     //---------------------------------------------------------------------------------------------------------------------
+    std::optional<date> date::fromGmtString(std::string const& str)
+    {
+        std::tm tmTime{};
+        std::istringstream sstr{str};
+        sstr.imbue(std::locale::classic());
+        sstr >> std::get_time(&tmTime, "%a, %d %b %Y %H:%M:%S");
+        std::string zone;
+        sstr >> zone;
+        if (sstr.fail() || zone != "GMT")
+            return std::nullopt;
+#ifdef _MSC_VER
+        const auto time = _mkgmtime(&tmTime);
+#else
+        const auto time = timegm(&tmTime);
+#endif
+        if (time == -1)
+            return std::nullopt;
+        return date{std::chrono::system_clock::from_time_t(time)};
+    }
+    //---------------------------------------------------------------------------------------------------------------------
     std::chrono::system_clock::time_point& date::getTimePoint()
     {
         return timePoint_;
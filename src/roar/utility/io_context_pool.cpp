@@ -0,0 +1,121 @@
+#include <roar/utility/io_context_pool.hpp>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace Roar
+{
+    namespace
+    {
+        void pinToCpu([[maybe_unused]] std::thread& thread, [[maybe_unused]] std::size_t cpu)
+        {
+#ifdef __linux__
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(cpu, &cpuSet);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+#endif
+        }
+    }
+    // ##################################################################################################################
+    struct IoContextPool::Implementation
+    {
+        using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+        /// Shared with the thread running the context, which may outlive the pool if it was stopped from that thread.
+        std::vector<std::shared_ptr<boost::asio::io_context>> contexts;
+        std::vector<std::optional<WorkGuard>> workGuards;
+        std::vector<std::thread> threads;
+
+        Implementation(ConstructionArguments const& constructionArgs);
+        ~Implementation();
+        Implementation(Implementation const&) = delete;
+        Implementation(Implementation&&) = delete;
+        Implementation& operator=(Implementation const&) = delete;
+        Implementation& operator=(Implementation&&) = delete;
+
+        void stop();
+    };
+    //------------------------------------------------------------------------------------------------------------------
+    IoContextPool::Implementation::Implementation(ConstructionArguments const& constructionArgs)
+        : contexts{}
+        , workGuards{}
+        , threads{}
+    {
+        const std::size_t cpuCount = std::max(std::thread::hardware_concurrency(), 1u);
+        const std::size_t threadCount = constructionArgs.threadCount == 0 ? cpuCount : constructionArgs.threadCount;
+
+        contexts.reserve(threadCount);
+        workGuards.reserve(threadCount);
+        threads.reserve(threadCount);
+        for (std::size_t i = 0; i != threadCount; ++i)
+        {
+            contexts.push_back(std::make_shared<boost::asio::io_context>(1));
+            workGuards.emplace_back(boost::asio::make_work_guard(*contexts.back()));
+        }
+        for (std::size_t i = 0; i != threadCount; ++i)
+        {
+            threads.emplace_back([context = contexts[i]]() {
+                context->run();
+            });
+            if (constructionArgs.pinThreads)
+                pinToCpu(threads.back(), i % cpuCount);
+        }
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    IoContextPool::Implementation::~Implementation()
+    {
+        stop();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void IoContextPool::Implementation::stop()
+    {
+        for (auto& workGuard : workGuards)
+            workGuard.reset();
+        for (auto& context : contexts)
+            context->stop();
+        for (auto& thread : threads)
+        {
+            if (!thread.joinable())
+                continue;
+            // Stopping from within the pool cannot wait for the calling thread itself. The detached thread keeps its
+            // io_context alive until run() returns, even if the pool is destroyed before that.
+            if (thread.get_id() == std::this_thread::get_id())
+                thread.detach();
+            else
+                thread.join();
+        }
+    }
+    // ##################################################################################################################
+    IoContextPool::IoContextPool(ConstructionArguments constructionArgs)
+        : impl_{std::make_unique<Implementation>(constructionArgs)}
+    {}
+    //------------------------------------------------------------------------------------------------------------------
+    ROAR_PIMPL_SPECIAL_FUNCTIONS_IMPL(IoContextPool);
+    //------------------------------------------------------------------------------------------------------------------
+    std::size_t IoContextPool::size() const
+    {
+        return impl_->contexts.size();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    boost::asio::any_io_executor IoContextPool::executor(std::size_t index) const
+    {
+        return impl_->contexts[index]->get_executor();
+    }
+    //------------------------------------------------------------------------------------------------------------------
+    void IoContextPool::stop()
+    {
+        impl_->stop();
+    }
+    // ##################################################################################################################
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace Roar::Benchmarks
+{
+    /**
+     * @brief Runs the function repeatedly for roughly the given duration.
+     *
+     * @return double The average time of one call in nanoseconds.
+     */
+    template <typename FunctionT>
+    double measure(FunctionT&& func, std::chrono::milliseconds duration = std::chrono::milliseconds{300})
+    {
+        using clock = std::chrono::steady_clock;
+        std::size_t iterations = 0;
+        const auto start = clock::now();
+        auto now = start;
+        do
+        {
+            func();
+            ++iterations;
+            now = clock::now();
+        } while (now - start < duration);
+        return std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(iterations);
+    }
+
+    inline void report(std::string_view name, std::size_t size, double nanoseconds)
+    {
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(8) << size << std::setw(16)
+                  << std::fixed << std::setprecision(1) << nanoseconds << " ns/op\n";
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "benchmark.hpp"
+
+#include <roar/routing/regex_route_matcher.hpp>
+#include <roar/routing/route.hpp>
+
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Roar::Benchmarks
+{
+    inline std::vector<std::string> makeRegexRoutePatterns(std::size_t count)
+    {
+        std::vector<std::string> patterns;
+        patterns.reserve(count);
+        for (std::size_t i = 0; i != count; ++i)
+            patterns.push_back(R"(\/api\/v1\/resource)" + std::to_string(i) + R"(\/([0-9]+)\/(\w+))");
+        return patterns;
+    }
+
+    inline void benchmarkRegexRoutes(std::size_t count)
+    {
+        const auto patterns = makeRegexRoutePatterns(count);
+        // Matches the last route, which is the worst case for trying routes one after the other.
+        const std::string path = "/api/v1/resource" + std::to_string(count - 1) + "/42/details";
+
+        // Previous behavior: every match attempt compiled the pattern again.
+        report(
+            "regex compiled per attempt",
+            count,
+            measure([&]() {
+                for (auto const& pattern : patterns)
+                {
+                    std::smatch smatch;
+                    if (std::regex_match(path, smatch, std::regex{pattern}))
+                        break;
+                }
+            }));
+
+        std::vector<std::regex> compiled;
+        compiled.reserve(count);
+        for (auto const& pattern : patterns)
+            compiled.emplace_back(pattern);
+        report(
+            "cached regex, tried in turn",
+            count,
+            measure([&]() {
+                for (auto const& regex : compiled)
+                {
+                    std::smatch smatch;
+                    if (std::regex_match(path, smatch, regex))
+                        break;
+                }
+            }));
+
+        RegexRouteMatcher matcher;
+        for (auto const& pattern : patterns)
+        {
+            ProtoRoute proto{};
+            proto.path = Detail::RegexPath{.pattern = pattern, .regex = std::regex{pattern}};
+            auto regexPath = std::get<Detail::RegexPath>(proto.path);
+            matcher.insert(
+                boost::beast::http::verb::get, regexPath.pattern, std::move(regexPath.regex), Route{std::move(proto)});
+        }
+        report(
+            "RegexRouteMatcher",
+            count,
+            measure([&]() {
+                const auto match = matcher.find(boost::beast::http::verb::get, path);
+                if (!match)
+                    throw std::runtime_error{"Benchmark route did not match."};
+            }));
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "benchmark.hpp"
+
+#include <roar/curl/instance.hpp>
+#include <roar/url/encode.hpp>
+
+#include <curl/curl.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace Roar::Benchmarks
+{
+    // Previous behavior: a new curl handle for every call.
+    inline std::string curlUrlEncode(std::string const& source)
+    {
+        Curl::Instance temporaryInstance;
+        auto* escaped = curl_easy_escape(temporaryInstance, source.c_str(), static_cast<int>(source.size()));
+        if (escaped == nullptr)
+            throw std::runtime_error("Could not encode url.");
+        std::string encoded{escaped};
+        curl_free(escaped);
+        return encoded;
+    }
+
+    inline std::string curlUrlDecode(std::string const& source)
+    {
+        Curl::Instance temporaryInstance;
+        int length = 0;
+        auto* unescaped =
+            curl_easy_unescape(temporaryInstance, source.c_str(), static_cast<int>(source.size()), &length);
+        if (unescaped == nullptr)
+            throw std::runtime_error("Could not decode url.");
+        std::string decoded{unescaped, unescaped + length};
+        curl_free(unescaped);
+        return decoded;
+    }
+
+    inline std::string makeUrlSegment(std::size_t size, std::size_t reservedEvery)
+    {
+        std::string segment;
+        segment.reserve(size);
+        for (std::size_t i = 0; i != size; ++i)
+            segment.push_back(i % reservedEvery == reservedEvery - 1 ? ' ' : static_cast<char>('a' + i % 26));
+        return segment;
+    }
+
+    inline void benchmarkUrlEncode(std::size_t size)
+    {
+        // Mostly unreserved, like typical path segments and query values.
+        const auto segment = makeUrlSegment(size, 32);
+        const auto encoded = urlEncode(segment);
+        if (curlUrlEncode(segment) != encoded || curlUrlDecode(encoded) != segment || urlDecode(encoded) != segment)
+            throw std::runtime_error{"Url encoding implementations disagree."};
+
+        report(
+            "urlEncode curl",
+            size,
+            measure([&]() {
+                curlUrlEncode(segment);
+            }));
+        report(
+            "urlEncode",
+            size,
+            measure([&]() {
+                urlEncode(segment);
+            }));
+
+        std::string output;
+        report(
+            "urlEncode into buffer",
+            size,
+            measure([&]() {
+                output.clear();
+                urlEncode(segment, output);
+            }));
+
+        report(
+            "urlDecode curl",
+            size,
+            measure([&]() {
+                curlUrlDecode(encoded);
+            }));
+        report(
+            "urlDecode",
+            size,
+            measure([&]() {
+                urlDecode(encoded);
+            }));
+        report(
+            "urlDecode into buffer",
+            size,
+            measure([&]() {
+                output.clear();
+                urlDecode(encoded, output);
+            }));
+    }
+}
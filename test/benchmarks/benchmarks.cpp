@@ -0,0 +1,13 @@
+#include "benchmark_regex_routes.hpp"
+#include "benchmark_url_encode.hpp"
+
+int main()
+{
+    using namespace Roar::Benchmarks;
+
+    for (std::size_t count : {10, 100, 1000})
+        benchmarkRegexRoutes(count);
+
+    for (std::size_t size : {16, 256, 4096})
+        benchmarkUrlEncode(size);
+}
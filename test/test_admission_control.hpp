@@ -0,0 +1,175 @@
+#pragma once
+
+#include "util/common_server_setup.hpp"
+#include "util/common_listeners.hpp"
+
+#include <roar/session/admission_control.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+namespace Roar::Tests
+{
+    TEST(AdmissionControlTests, ConnectionsAreAdmittedUpToTheLimit)
+    {
+        auto admissionControl = std::make_shared<AdmissionControl>(AdmissionLimits{.maxConnections = 2});
+        auto first = admissionControl->tryAdmitConnection();
+        auto second = admissionControl->tryAdmitConnection();
+        EXPECT_TRUE(first);
+        EXPECT_TRUE(second);
+        EXPECT_FALSE(admissionControl->tryAdmitConnection());
+        EXPECT_EQ(admissionControl->connectionCount(), 2);
+
+        first.release();
+        EXPECT_EQ(admissionControl->connectionCount(), 1);
+        EXPECT_TRUE(admissionControl->tryAdmitConnection());
+    }
+
+    TEST(AdmissionControlTests, WaiterIsResumedWhenConnectionIsReleased)
+    {
+        auto admissionControl = std::make_shared<AdmissionControl>(AdmissionLimits{.maxConnections = 1});
+        auto ticket = admissionControl->tryAdmitConnection();
+
+        bool resumed = false;
+        admissionControl->onConnectionAvailable([&resumed]() {
+            resumed = true;
+        });
+        EXPECT_FALSE(resumed);
+
+        ticket = AdmissionTicket{};
+        EXPECT_TRUE(resumed);
+    }
+
+    TEST(AdmissionControlTests, WaiterIsResumedImmediatelyIfConnectionIsAvailable)
+    {
+        auto admissionControl = std::make_shared<AdmissionControl>(AdmissionLimits{.maxConnections = 1});
+        bool resumed = false;
+        admissionControl->onConnectionAvailable([&resumed]() {
+            resumed = true;
+        });
+        EXPECT_TRUE(resumed);
+    }
+
+    TEST(AdmissionControlTests, ZeroMeansUnlimited)
+    {
+        auto admissionControl = std::make_shared<AdmissionControl>(AdmissionLimits{});
+        std::vector<AdmissionTicket> tickets;
+        for (int i = 0; i != 100; ++i)
+            tickets.push_back(admissionControl->tryAdmitRequest());
+        EXPECT_EQ(admissionControl->inFlightRequestCount(), 100);
+        tickets.clear();
+        EXPECT_EQ(admissionControl->inFlightRequestCount(), 0);
+    }
+
+    TEST(AdmissionControlTests, RequestsAreShedAboveTheQueueingDelay)
+    {
+        using namespace std::chrono_literals;
+        const AdmissionControl admissionControl{AdmissionLimits{.maxQueueingDelay = 10ms}};
+        EXPECT_TRUE(admissionControl.measuresQueueingDelay());
+        EXPECT_FALSE(admissionControl.shouldShed(5ms));
+        EXPECT_TRUE(admissionControl.shouldShed(20ms));
+    }
+
+    class AdmissionTests
+        : public CommonServerSetup
+        , public ::testing::Test
+    {
+      protected:
+        void makeServer(AdmissionLimits limits)
+        {
+            server_ = std::make_unique<Roar::Server>(Roar::Server::ConstructionArguments{
+                .executor = executor_,
+                .onError =
+                    [this](Roar::Error&& err) {
+                        errors_.push_back(std::move(err));
+                    },
+                .admissionLimits = std::move(limits),
+            });
+            if (!server_->start())
+                throw std::runtime_error{"Failed to start server"};
+            server_->installRequestListener<SimpleRoutes>();
+        }
+
+        void connect(boost::asio::ip::tcp::socket& socket)
+        {
+            boost::asio::ip::tcp::resolver resolver{context_};
+            boost::asio::connect(
+                socket, resolver.resolve("localhost", std::to_string(server_->getLocalEndpoint().port())));
+        }
+
+        boost::beast::http::response<boost::beast::http::string_body>
+        get(boost::asio::ip::tcp::socket& socket, std::string const& target)
+        {
+            using namespace boost::beast::http;
+            request<empty_body> req{verb::get, target, 11};
+            req.set(field::host, "localhost");
+            write(socket, req);
+
+            boost::beast::flat_buffer buffer;
+            response<string_body> res;
+            read(socket, buffer, res);
+            return res;
+        }
+
+      protected:
+        boost::asio::io_context context_{};
+    };
+
+    TEST_F(AdmissionTests, AcceptingPausesWhileConnectionLimitIsReached)
+    {
+        using namespace std::chrono_literals;
+        makeServer({.maxConnections = 1});
+
+        boost::asio::ip::tcp::socket first{context_};
+        connect(first);
+        EXPECT_EQ(get(first, "/index.txt").body(), "Hello");
+
+        auto second = std::async(std::launch::async, [this]() {
+            boost::asio::ip::tcp::socket socket{context_};
+            connect(socket);
+            return get(socket, "/index.txt").body();
+        });
+        EXPECT_EQ(second.wait_for(300ms), std::future_status::timeout);
+
+        first.close();
+        EXPECT_EQ(second.get(), "Hello");
+    }
+
+    TEST_F(AdmissionTests, RequestsAboveInFlightLimitAreRejected)
+    {
+        using namespace boost::beast::http;
+        makeServer({.maxInFlightRequests = 1});
+
+        // Stays in flight until its body is sent.
+        boost::asio::ip::tcp::socket first{context_};
+        connect(first);
+        request<empty_body> put{verb::put, "/putHere", 11};
+        put.set(field::host, "localhost");
+        put.set(field::content_length, "5");
+        write(first, put);
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+        boost::asio::ip::tcp::socket second{context_};
+        connect(second);
+        EXPECT_EQ(get(second, "/index.txt").result(), status::service_unavailable);
+
+        boost::asio::write(first, boost::asio::buffer(std::string_view{"Hello"}));
+        boost::beast::flat_buffer buffer;
+        response<string_body> res;
+        read(first, buffer, res);
+        EXPECT_EQ(res.body(), "Hello");
+    }
+}
@@ -0,0 +1,490 @@
+#pragma once
+
+#include "util/common_server_setup.hpp"
+
+#include <roar/body/compressed_body.hpp>
+#include <roar/body/void_body.hpp>
+#include <roar/curl/request.hpp>
+#include <roar/mechanics/compression.hpp>
+#include <roar/routing/request_listener.hpp>
+
+#include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+namespace Roar::Tests
+{
+    namespace
+    {
+        std::string makeCompressibleText(std::size_t size)
+        {
+            std::string text;
+            for (int i = 0; text.size() < size; ++i)
+                text += "{\"id\": " + std::to_string(i) + ", \"name\": \"element\", \"valid\": true},\n";
+            text.resize(size);
+            return text;
+        }
+
+        std::string inflateAll(std::string const& compressed)
+        {
+            z_stream stream{};
+            // 15 + 32 detects gzip and zlib headers.
+            inflateInit2(&stream, 15 + 32);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+            stream.avail_in = static_cast<uInt>(compressed.size());
+            std::string result;
+            int status = Z_OK;
+            while (status == Z_OK)
+            {
+                char buffer[4096];
+                stream.next_out = reinterpret_cast<Bytef*>(buffer);
+                stream.avail_out = sizeof(buffer);
+                status = inflate(&stream, Z_NO_FLUSH);
+                result.append(buffer, sizeof(buffer) - stream.avail_out);
+            }
+            inflateEnd(&stream);
+            EXPECT_EQ(status, Z_STREAM_END);
+            return result;
+        }
+    }
+
+    class CompressingRoutes
+    {
+      public:
+        std::string text = makeCompressibleText(100'000);
+        std::filesystem::path file;
+
+      private:
+        ROAR_MAKE_LISTENER(CompressingRoutes);
+
+        ROAR_GET(json)
+        ({
+            .path = "/json",
+            .routeOptions = {.compression = CompressionOptions{}},
+        });
+        ROAR_GET(varied)
+        ({
+            .path = "/varied",
+            .routeOptions = {.compression = CompressionOptions{}},
+        });
+        ROAR_GET(small)
+        ({
+            .path = "/small",
+            .routeOptions = {.compression = CompressionOptions{}},
+        });
+        ROAR_GET(image)
+        ({
+            .path = "/image",
+            .routeOptions = {.compression = CompressionOptions{}},
+        });
+        ROAR_GET(uncompressedRoute)("/uncompressedRoute");
+        ROAR_GET(fileRoute)
+        ({
+            .path = "/file",
+            .routeOptions = {.compression = CompressionOptions{.level = 9}},
+        });
+        ROAR_POST(decode)("/decode");
+        ROAR_POST(decodeLimited)("/decodeLimited");
+        ROAR_POST(decodeToFile)("/decodeToFile");
+        ROAR_POST(decodeToVoid)("/decodeToVoid");
+
+      private:
+        BOOST_DESCRIBE_CLASS(
+            CompressingRoutes,
+            (),
+            (),
+            (),
+            (roar_json,
+             roar_varied,
+             roar_small,
+             roar_image,
+             roar_uncompressedRoute,
+             roar_fileRoute,
+             roar_decode,
+             roar_decodeLimited,
+             roar_decodeToFile,
+             roar_decodeToVoid))
+    };
+    inline void CompressingRoutes::json(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<CompressedBody<string_body>>(req)
+            ->body(text)
+            .contentType("application/json; charset=utf-8")
+            .status(status::ok)
+            .commit();
+    }
+    inline void CompressingRoutes::varied(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<CompressedBody<string_body>>(req)
+            ->body(text)
+            .contentType("text/plain")
+            .setHeader(field::vary, "Origin")
+            .status(status::ok)
+            .commit();
+    }
+    inline void CompressingRoutes::small(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<CompressedBody<string_body>>(req)
+            ->body("tiny")
+            .contentType("text/plain")
+            .status(status::ok)
+            .commit();
+    }
+    inline void CompressingRoutes::image(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<CompressedBody<string_body>>(req)->body(text).contentType("image/png").status(status::ok).commit();
+    }
+    inline void CompressingRoutes::uncompressedRoute(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<CompressedBody<string_body>>(req)
+            ->body(text)
+            .contentType("text/plain")
+            .status(status::ok)
+            .commit();
+    }
+    inline void CompressingRoutes::fileRoute(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        auto intermediate = session.send<CompressedBody<file_body>>(req);
+        boost::beast::error_code ec;
+        intermediate->body().open(file.string().c_str(), boost::beast::file_mode::read, ec);
+        intermediate->contentType("text/plain").status(status::ok).commit();
+    }
+
+    inline void CompressingRoutes::decode(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.template readDecoded<string_body>(std::move(req))
+            ->commit()
+            .then([](Session& session, Roar::Request<string_body> const& req) {
+                session.send<string_body>(req)->body(req.body()).contentType("text/plain").status(status::ok).commit();
+            });
+    }
+    inline void CompressingRoutes::decodeLimited(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.template readDecoded<string_body>(std::move(req))
+            ->bodyLimit(500'000)
+            .commit()
+            .then([](Session& session, Roar::Request<string_body> const& req) {
+                session.send<string_body>(req)->body(req.body()).contentType("text/plain").status(status::ok).commit();
+            });
+    }
+    inline void CompressingRoutes::decodeToFile(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        file_body::value_type body;
+        boost::beast::error_code ec;
+        body.open(file.string().c_str(), boost::beast::file_mode::write, ec);
+        session.template readDecoded<file_body>(std::move(req), std::move(body))
+            ->bodyLimit(3'000'000)
+            .commit()
+            .then([](Session& session, Roar::Request<file_body> const& req) {
+                // Answers with the framing headers the handler got to see.
+                session.send<string_body>(req)
+                    ->body(std::string{req[field::content_encoding]} + ";" + std::string{req[field::content_length]})
+                    .contentType("text/plain")
+                    .status(status::ok)
+                    .commit();
+            });
+    }
+    inline void CompressingRoutes::decodeToVoid(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.template readDecoded<VoidBody>(std::move(req))
+            ->bodyLimit(500'000)
+            .commit()
+            .then([](Session& session, Roar::Request<VoidBody> const& req) {
+                session.send<string_body>(req)
+                    ->body(std::string{req[field::content_encoding]} + ";" + std::string{req[field::content_length]})
+                    .contentType("text/plain")
+                    .status(status::ok)
+                    .commit();
+            });
+    }
+
+    class CompressionTests
+        : public CommonServerSetup
+        , public ::testing::Test
+    {
+      protected:
+        void SetUp() override
+        {
+            makeDefaultServer();
+            listener_ = server_->installRequestListener<CompressingRoutes>();
+        }
+
+        Curl::Response get(
+            std::string const& target,
+            std::string const& acceptEncoding,
+            std::string& body,
+            std::unordered_map<std::string, std::string>& headers)
+        {
+            auto request = Curl::Request{};
+            if (!acceptEncoding.empty())
+                request.acceptEncoding(acceptEncoding);
+            return request.headerSink(headers).sink(body).get(url(target));
+        }
+
+      protected:
+        std::shared_ptr<CompressingRoutes> listener_;
+    };
+
+    TEST(StreamCompressorTests, PiecewiseCompressionRoundTrips)
+    {
+        const auto text = makeCompressibleText(200'000);
+        for (auto coding : {ContentCoding::Gzip, ContentCoding::Deflate})
+        {
+            StreamCompressor compressor{coding};
+            std::string compressed;
+            for (std::size_t offset = 0; offset < text.size(); offset += 1000)
+                EXPECT_TRUE(compressor.compress(std::string_view{text}.substr(offset, 1000), false, compressed));
+            EXPECT_TRUE(compressor.compress({}, true, compressed));
+
+            EXPECT_LT(compressed.size(), text.size() / 10);
+            EXPECT_EQ(inflateAll(compressed), text);
+        }
+    }
+
+    TEST(StreamCompressorTests, EmptyStreamIsValid)
+    {
+        StreamCompressor compressor{ContentCoding::Gzip, 1};
+        std::string compressed;
+        EXPECT_TRUE(compressor.compress({}, true, compressed));
+        EXPECT_EQ(inflateAll(compressed), "");
+    }
+
+    TEST(StreamDecompressorTests, DecompressesInBoundedSteps)
+    {
+        const auto text = makeCompressibleText(200'000);
+        std::string compressed;
+        StreamCompressor compressor{ContentCoding::Gzip};
+        compressor.compress(text, true, compressed);
+
+        StreamDecompressor decompressor{ContentCoding::Gzip};
+        std::string_view input{compressed};
+        std::string decompressed;
+        while (!decompressor.finished())
+        {
+            const auto previousSize = decompressed.size();
+            EXPECT_TRUE(decompressor.decompress(input, decompressed, 1000));
+            EXPECT_LE(decompressed.size() - previousSize, 1000);
+        }
+        EXPECT_TRUE(input.empty());
+        EXPECT_EQ(decompressed, text);
+    }
+
+    TEST(StreamDecompressorTests, CorruptDataIsDetected)
+    {
+        std::string compressed;
+        StreamCompressor compressor{ContentCoding::Deflate};
+        compressor.compress(makeCompressibleText(10'000), true, compressed);
+        compressed[compressed.size() / 2] ^= 0x55;
+
+        StreamDecompressor decompressor{ContentCoding::Deflate};
+        std::string_view input{compressed};
+        std::string decompressed;
+        bool valid = true;
+        while (valid && !decompressor.finished() && !input.empty())
+            valid = decompressor.decompress(input, decompressed, 1000);
+        EXPECT_FALSE(valid && decompressor.finished());
+    }
+
+    TEST(StreamDecompressorTests, ContentCodingIsParsed)
+    {
+        EXPECT_EQ(parseContentCoding(""), ContentCoding::Identity);
+        EXPECT_EQ(parseContentCoding(" GZIP "), ContentCoding::Gzip);
+        EXPECT_EQ(parseContentCoding("x-gzip"), ContentCoding::Gzip);
+        EXPECT_EQ(parseContentCoding("deflate"), ContentCoding::Deflate);
+        EXPECT_EQ(parseContentCoding("br"), ContentCoding::Brotli);
+        EXPECT_FALSE(parseContentCoding("gzip, br"));
+        EXPECT_FALSE(parseContentCoding("compress"));
+    }
+
+    TEST(SelectCompressionTests, FollowsTheRoutePolicy)
+    {
+        const CompressionOptions options{};
+        EXPECT_EQ(selectCompression(options, "gzip", "application/json", 5000), ContentCoding::Gzip);
+        EXPECT_EQ(selectCompression(options, "gzip", "text/html; charset=utf-8", std::nullopt), ContentCoding::Gzip);
+        EXPECT_EQ(selectCompression(options, "deflate, gzip;q=0.5", "text/css", 5000), ContentCoding::Deflate);
+        EXPECT_EQ(selectCompression(options, "gzip", "application/json", 10), ContentCoding::Identity);
+        EXPECT_EQ(selectCompression(options, "gzip", "image/png", 5000), ContentCoding::Identity);
+        EXPECT_EQ(selectCompression(options, "", "application/json", 5000), ContentCoding::Identity);
+        EXPECT_EQ(selectCompression(options, "identity", "application/json", 5000), ContentCoding::Identity);
+    }
+
+    TEST_F(CompressionTests, ResponseIsCompressedIfAccepted)
+    {
+        for (auto const* coding : {"gzip", "deflate"})
+        {
+            std::string body;
+            std::unordered_map<std::string, std::string> headers;
+            const auto res = get("/json", coding, body, headers);
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(headers["Content-Encoding"], coding);
+            EXPECT_EQ(headers["Transfer-Encoding"], "chunked");
+            EXPECT_EQ(headers["Vary"], "Accept-Encoding");
+            EXPECT_EQ(headers.count("Content-Length"), 0);
+            EXPECT_EQ(body, listener_->text);
+        }
+    }
+
+    TEST_F(CompressionTests, AcceptEncodingIsAddedToAnExistingVary)
+    {
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = get("/varied", "gzip", body, headers);
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(headers["Content-Encoding"], "gzip");
+        EXPECT_EQ(headers["Vary"], "Origin, Accept-Encoding");
+        EXPECT_EQ(body, listener_->text);
+    }
+
+    TEST_F(CompressionTests, ResponseIsSentAsIsWithoutAcceptEncoding)
+    {
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = get("/json", "", body, headers);
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(headers.count("Content-Encoding"), 0);
+        EXPECT_EQ(headers["Content-Length"], std::to_string(listener_->text.size()));
+        EXPECT_EQ(body, listener_->text);
+    }
+
+    TEST_F(CompressionTests, SmallAndIncompressibleResponsesAreSentAsIs)
+    {
+        for (auto const* target : {"/small", "/image", "/uncompressedRoute"})
+        {
+            std::string body;
+            std::unordered_map<std::string, std::string> headers;
+            const auto res = get(target, "gzip", body, headers);
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(headers.count("Content-Encoding"), 0);
+            EXPECT_EQ(headers["Content-Length"], std::to_string(body.size()));
+        }
+    }
+
+    TEST_F(CompressionTests, FileIsCompressedWhileItIsStreamed)
+    {
+        const auto text = makeCompressibleText(2'000'000);
+        listener_->file = tmpDir_.path() / "compressible.txt";
+        {
+            std::ofstream writer{listener_->file, std::ios_base::binary};
+            writer << text;
+        }
+
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = get("/file", "gzip", body, headers);
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(headers["Content-Encoding"], "gzip");
+        EXPECT_EQ(body, text);
+    }
+
+    TEST_F(CompressionTests, CompressedRequestBodyIsDecoded)
+    {
+        const auto text = makeCompressibleText(2'000'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Gzip}.compress(text, true, compressed);
+
+        std::string body;
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "gzip")
+                             .source(compressed)
+                             .sink(body)
+                             .post(url("/decode"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, text);
+    }
+
+    TEST_F(CompressionTests, DecodedSizeCountsAgainstBodyLimit)
+    {
+        const auto text = makeCompressibleText(2'000'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Gzip}.compress(text, true, compressed);
+        ASSERT_LT(compressed.size(), 500'000);
+
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "gzip")
+                             .source(compressed)
+                             .post(url("/decodeLimited"));
+        EXPECT_NE(res.code(), boost::beast::http::status::ok);
+    }
+
+    TEST_F(CompressionTests, CompressedRequestBodyIsDecodedIntoAFile)
+    {
+        const auto text = makeCompressibleText(2'000'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Gzip}.compress(text, true, compressed);
+        listener_->file = tmpDir_.path() / "decoded.txt";
+
+        std::string body;
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "gzip")
+                             .source(compressed)
+                             .sink(body)
+                             .post(url("/decodeToFile"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, ";" + std::to_string(text.size()));
+
+        std::ifstream reader{listener_->file, std::ios_base::binary};
+        const std::string written{std::istreambuf_iterator<char>{reader}, std::istreambuf_iterator<char>{}};
+        EXPECT_EQ(written, text);
+    }
+
+    TEST_F(CompressionTests, DecodedSizeCountsAgainstBodyLimitOfAFile)
+    {
+        const auto text = makeCompressibleText(4'000'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Gzip}.compress(text, true, compressed);
+        ASSERT_LT(compressed.size(), 3'000'000);
+        listener_->file = tmpDir_.path() / "decoded.txt";
+
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "gzip")
+                             .source(compressed)
+                             .post(url("/decodeToFile"));
+        EXPECT_NE(res.code(), boost::beast::http::status::ok);
+    }
+
+    TEST_F(CompressionTests, CompressedRequestBodyIsDecodedIntoNothing)
+    {
+        const auto text = makeCompressibleText(200'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Deflate}.compress(text, true, compressed);
+
+        std::string body;
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "deflate")
+                             .source(compressed)
+                             .sink(body)
+                             .post(url("/decodeToVoid"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, ";" + std::to_string(text.size()));
+    }
+
+    TEST_F(CompressionTests, DecodedSizeCountsAgainstBodyLimitOfAVoidBody)
+    {
+        const auto text = makeCompressibleText(2'000'000);
+        std::string compressed;
+        StreamCompressor{ContentCoding::Gzip}.compress(text, true, compressed);
+        ASSERT_LT(compressed.size(), 500'000);
+
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::content_encoding, "gzip")
+                             .source(compressed)
+                             .post(url("/decodeToVoid"));
+        EXPECT_NE(res.code(), boost::beast::http::status::ok);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <roar/mechanics/entity_tag.hpp>
+#include <roar/utility/date.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace Roar::Tests
+{
+    TEST(EntityTagTests, ExactTagMatches)
+    {
+        EXPECT_TRUE(entityTagListMatches("\"abc\"", "\"abc\""));
+        EXPECT_FALSE(entityTagListMatches("\"abd\"", "\"abc\""));
+    }
+
+    TEST(EntityTagTests, AnyTagInTheListMatches)
+    {
+        EXPECT_TRUE(entityTagListMatches("\"x\", \"abc\" ,\"y\"", "\"abc\""));
+        EXPECT_FALSE(entityTagListMatches("\"x\", \"y\"", "\"abc\""));
+    }
+
+    TEST(EntityTagTests, WeakComparisonIgnoresWeakness)
+    {
+        EXPECT_TRUE(entityTagListMatches("W/\"abc\"", "\"abc\""));
+        EXPECT_TRUE(entityTagListMatches("\"abc\"", "W/\"abc\""));
+    }
+
+    TEST(EntityTagTests, AsteriskMatchesAnyTag)
+    {
+        EXPECT_TRUE(entityTagListMatches(" * ", "\"abc\""));
+        EXPECT_FALSE(entityTagListMatches("*", ""));
+    }
+
+    TEST(DateTests, CanParseGmtString)
+    {
+        auto parsed = date::fromGmtString("Sun, 06 Nov 1994 08:49:37 GMT");
+        ASSERT_TRUE(parsed);
+        EXPECT_EQ(std::chrono::system_clock::to_time_t(parsed->getTimePoint()), 784111777);
+        EXPECT_EQ(parsed->toGmtString(), "Sun, 06 Nov 1994 08:49:37 GMT");
+    }
+
+    TEST(DateTests, RejectsMalformedDates)
+    {
+        EXPECT_FALSE(date::fromGmtString("Sunday, 06-Nov-94 08:49:37"));
+        EXPECT_FALSE(date::fromGmtString("yesterday"));
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <roar/mechanics/content_encoding.hpp>
+
+#include <gtest/gtest.h>
+
+namespace Roar::Tests
+{
+    TEST(ContentEncodingTests, NothingIsChosenWithoutAcceptableEncoding)
+    {
+        EXPECT_FALSE(negotiateContentEncoding("", {"gzip"}));
+        EXPECT_FALSE(negotiateContentEncoding("deflate", {"gzip", "br"}));
+        EXPECT_FALSE(negotiateContentEncoding("gzip", {}));
+    }
+
+    TEST(ContentEncodingTests, OfferedOrderBreaksTies)
+    {
+        EXPECT_EQ(negotiateContentEncoding("gzip, br", {"br", "gzip"}), "br");
+        EXPECT_EQ(negotiateContentEncoding("gzip, br", {"gzip", "br"}), "gzip");
+    }
+
+    TEST(ContentEncodingTests, HighestQualityWins)
+    {
+        EXPECT_EQ(negotiateContentEncoding("br;q=0.5, gzip;q=0.8", {"br", "gzip"}), "gzip");
+        EXPECT_EQ(negotiateContentEncoding("br ; q=1.0, GZIP;q=0.999", {"gzip", "br"}), "br");
+    }
+
+    TEST(ContentEncodingTests, ZeroQualityExcludesEncoding)
+    {
+        EXPECT_FALSE(negotiateContentEncoding("gzip;q=0", {"gzip"}));
+        EXPECT_EQ(negotiateContentEncoding("*, br;q=0", {"br", "zstd"}), "zstd");
+        EXPECT_FALSE(negotiateContentEncoding("*;q=0", {"br", "gzip"}));
+    }
+
+    TEST(ContentEncodingTests, AsteriskAcceptsAnyOtherEncoding)
+    {
+        EXPECT_EQ(negotiateContentEncoding("*", {"zstd"}), "zstd");
+        EXPECT_EQ(negotiateContentEncoding("gzip;q=0.1, *;q=0.5", {"gzip", "br"}), "br");
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "util/temporary_directory.hpp"
+
+#include <roar/filesystem/file_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace Roar::Tests
+{
+    class FileCacheTests : public ::testing::Test
+    {
+      protected:
+        void writeFile(std::string const& name, std::string const& content)
+        {
+            std::ofstream writer{tempDir_.path() / name, std::ios_base::binary};
+            writer << content;
+        }
+
+        std::shared_ptr<CachedFile const> get(FileCache& cache, std::string const& name)
+        {
+            return cache.get(name, [this, &name]() {
+                ++lookups_;
+                return describeFile(tempDir_.path() / name, name);
+            });
+        }
+
+      protected:
+        TemporaryDirectory tempDir_{TEST_TEMPORARY_DIRECTORY};
+        int lookups_{0};
+    };
+
+    TEST_F(FileCacheTests, DescribesRegularFiles)
+    {
+        writeFile("style.css", "body{}");
+        const auto file = describeFile(tempDir_.path() / "style.css", "style.css");
+        EXPECT_EQ(file.fileAndStatus.status.type(), std::filesystem::file_type::regular);
+        EXPECT_EQ(file.size, 6);
+        EXPECT_EQ(file.contentType, "text/css");
+        EXPECT_FALSE(file.etag.empty());
+    }
+
+    TEST_F(FileCacheTests, DescribesMissingFilesWithoutStatus)
+    {
+        const auto file = describeFile(tempDir_.path() / "missing.txt", "missing.txt");
+        EXPECT_EQ(file.fileAndStatus.status.type(), std::filesystem::file_type::none);
+        EXPECT_TRUE(file.etag.empty());
+    }
+
+    TEST_F(FileCacheTests, EtagChangesWithTheContent)
+    {
+        writeFile("a.txt", "1");
+        const auto before = describeFile(tempDir_.path() / "a.txt", "a.txt").etag;
+        writeFile("a.txt", "22");
+        EXPECT_NE(describeFile(tempDir_.path() / "a.txt", "a.txt").etag, before);
+    }
+
+    TEST_F(FileCacheTests, RepeatedLookupsAreCached)
+    {
+        writeFile("a.txt", "a");
+        FileCache cache{};
+        for (int i = 0; i != 3; ++i)
+            EXPECT_EQ(get(cache, "a.txt")->size, 1);
+        EXPECT_EQ(lookups_, 1);
+    }
+
+    TEST_F(FileCacheTests, LeastRecentlyUsedEntryIsEvicted)
+    {
+        FileCache cache{{.capacity = 2}};
+        get(cache, "a");
+        get(cache, "b");
+        get(cache, "a");
+        get(cache, "c");
+        EXPECT_EQ(cache.size(), 2);
+        EXPECT_EQ(lookups_, 3);
+
+        get(cache, "a");
+        EXPECT_EQ(lookups_, 3);
+        get(cache, "b");
+        EXPECT_EQ(lookups_, 4);
+    }
+
+    TEST_F(FileCacheTests, ExpiredEntriesAreLookedUpAgain)
+    {
+        FileCache cache{{.timeToLive = std::chrono::milliseconds{20}}};
+        get(cache, "a");
+        std::this_thread::sleep_for(std::chrono::milliseconds{40});
+        get(cache, "a");
+        EXPECT_EQ(lookups_, 2);
+    }
+
+    TEST_F(FileCacheTests, InvalidatedEntriesAreLookedUpAgain)
+    {
+        FileCache cache{};
+        get(cache, "a");
+        get(cache, "b");
+        cache.invalidate("a");
+        get(cache, "a");
+        get(cache, "b");
+        EXPECT_EQ(lookups_, 3);
+
+        cache.clear();
+        EXPECT_EQ(cache.size(), 0);
+    }
+
+    TEST_F(FileCacheTests, LookupsRacingAnInvalidationAreNotCached)
+    {
+        FileCache cache{};
+        writeFile("a.txt", "old");
+        const auto file = cache.get("a.txt", [this, &cache]() {
+            auto described = describeFile(tempDir_.path() / "a.txt", "a.txt");
+            // An upload replaces the file while it is being looked up.
+            writeFile("a.txt", "new content");
+            cache.invalidate("a.txt");
+            return described;
+        });
+        EXPECT_EQ(file->size, 3);
+        EXPECT_EQ(cache.size(), 0);
+        EXPECT_EQ(get(cache, "a.txt")->size, 11);
+    }
+}
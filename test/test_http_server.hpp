@@ -29,6 +29,27 @@ namespace Roar::Tests
         TemporaryDirectory tempDir_{TEST_TEMPORARY_DIRECTORY};
     };
 
+    class ShadowedIndex
+    {
+      private:
+        ROAR_MAKE_LISTENER(ShadowedIndex);
+        ROAR_GET(index)("/index.txt");
+
+      private:
+        BOOST_DESCRIBE_CLASS(ShadowedIndex, (), (), (), (roar_index))
+    };
+
+    inline void ShadowedIndex::index(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<string_body>(req)
+            ->status(status::ok)
+            .contentType("text/plain")
+            .body("Shadowed")
+            .preparePayload()
+            .commit();
+    }
+
     class HttpServerTests
         : public CommonServerSetup
         , public ::testing::Test
@@ -111,6 +132,122 @@ namespace Roar::Tests
         EXPECT_EQ(body, "AB");
     }
 
+    TEST_F(HttpServerTests, PathTemplateParametersAreExtracted)
+    {
+        nlohmann::json body;
+        auto res = Curl::Request{}.sink(body).get(url("/users/42/files/notes.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body["id"], 42);
+        EXPECT_EQ(body["name"], "notes.txt");
+    }
+
+    TEST_F(HttpServerTests, PathTemplateWithMismatchingTypeFallsBackToRegexPaths)
+    {
+        using namespace ::testing;
+
+        nlohmann::json body;
+        auto res = Curl::Request{}.sink(body).get(url("/users/bob/files/notes.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        ASSERT_THAT(body["matches"], ElementsAre("users", "bob/files/notes.txt"));
+    }
+
+    TEST_F(HttpServerTests, RemovedRequestListenerNoLongerReceivesRequests)
+    {
+        EXPECT_EQ(Curl::Request{}.get(url("/index.txt")).code(), boost::beast::http::status::ok);
+        EXPECT_TRUE(server_->removeRequestListener(listener_));
+        EXPECT_EQ(Curl::Request{}.get(url("/index.txt")).code(), boost::beast::http::status::not_found);
+        EXPECT_FALSE(server_->removeRequestListener(listener_));
+
+        listener_ = server_->installRequestListener<SimpleRoutes>();
+        EXPECT_EQ(Curl::Request{}.get(url("/index.txt")).code(), boost::beast::http::status::ok);
+    }
+
+    TEST_F(HttpServerTests, FirstInstalledListenerWinsForTheSameRoute)
+    {
+        auto shadowed = server_->installRequestListener<ShadowedIndex>();
+
+        std::string body;
+        Curl::Request{}.sink(body).get(url("/index.txt"));
+        EXPECT_EQ(body, "Hello");
+
+        EXPECT_TRUE(server_->removeRequestListener(listener_));
+        body.clear();
+        Curl::Request{}.sink(body).get(url("/index.txt"));
+        EXPECT_EQ(body, "Shadowed");
+
+        listener_ = server_->installRequestListener<SimpleRoutes>();
+        body.clear();
+        Curl::Request{}.sink(body).get(url("/index.txt"));
+        EXPECT_EQ(body, "Shadowed");
+    }
+
+    TEST_F(HttpServerTests, ListenerWithOnlyStringRoutesCanBeRemoved)
+    {
+        auto reflector = server_->installRequestListener<HeaderReflector>();
+        EXPECT_EQ(Curl::Request{}.get(url("/headers")).code(), boost::beast::http::status::ok);
+        EXPECT_TRUE(server_->removeRequestListener(reflector));
+        EXPECT_EQ(Curl::Request{}.get(url("/headers")).code(), boost::beast::http::status::not_found);
+    }
+
+    TEST_F(HttpServerTests, ServerWithMultipleAcceptorsServesAllConnections)
+    {
+        Roar::Server server{Roar::Server::ConstructionArguments{
+            .executor = executor_,
+            .acceptorCount = 4,
+        }};
+        ASSERT_TRUE(server.start());
+        server.installRequestListener<SimpleRoutes>();
+
+        for (int i = 0; i != 16; ++i)
+        {
+            std::string body;
+            const auto res = Curl::Request{}.sink(body).get(urlImpl(server, "/index.txt"));
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(body, "Hello");
+        }
+    }
+
+    TEST_F(HttpServerTests, ThreadPerCoreServerServesAllConnections)
+    {
+        Roar::Server server{Roar::Server::ConstructionArguments{
+            .threadPerCore = IoContextPool::ConstructionArguments{.threadCount = 2},
+        }};
+        ASSERT_TRUE(server.start());
+        server.installRequestListener<SimpleRoutes>();
+
+        for (int i = 0; i != 16; ++i)
+        {
+            std::string body;
+            const auto res = Curl::Request{}.sink(body).get(urlImpl(server, "/index.txt"));
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(body, "Hello");
+        }
+    }
+
+    TEST_F(HttpServerTests, ServerWithBatchedAcceptsServesConcurrentConnections)
+    {
+        Roar::Server server{Roar::Server::ConstructionArguments{
+            .executor = executor_,
+            .pendingAccepts = 4,
+            .acceptBatchSize = 8,
+            .listenBacklog = 64,
+        }};
+        ASSERT_TRUE(server.start());
+        server.installRequestListener<SimpleRoutes>();
+
+        std::vector<std::future<std::string>> bodies;
+        for (int i = 0; i != 32; ++i)
+        {
+            bodies.push_back(std::async(std::launch::async, [this, &server]() {
+                std::string body;
+                Curl::Request{}.sink(body).get(urlImpl(server, "/index.txt"));
+                return body;
+            }));
+        }
+        for (auto& body : bodies)
+            EXPECT_EQ(body.get(), "Hello");
+    }
+
     TEST_F(HttpServerTests, EncryptedServerAcceptsEncryptedConnection)
     {
         auto res =
@@ -118,6 +255,31 @@ namespace Roar::Tests
         EXPECT_EQ(res.code(), boost::beast::http::status::ok);
     }
 
+    TEST_F(HttpServerTests, DedicatedPlainAndTlsListenersServeTheirKindOfConnection)
+    {
+        const boost::asio::ip::tcp::endpoint loopback{boost::asio::ip::make_address("127.0.0.1"), 0};
+        const auto plainEndpoint = secureServer_->listen(loopback, ConnectionMode::Plain);
+        const auto tlsEndpoint = secureServer_->listen(loopback, ConnectionMode::Tls);
+        ASSERT_TRUE(plainEndpoint);
+        ASSERT_TRUE(tlsEndpoint);
+
+        auto res = Curl::Request{}.verifyPeer(false).verifyHost(false).get(
+            "https://127.0.0.1:" + std::to_string(tlsEndpoint->port()) + "/index.txt");
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+
+        // The secure server answers plain connections with a redirect to https.
+        std::unordered_map<std::string, std::string> headers;
+        res = Curl::Request{}.headerSink(headers).get(
+            "http://127.0.0.1:" + std::to_string(plainEndpoint->port()) + "/index.txt");
+        EXPECT_NE(headers.find("Strict-Transport-Security"), std::end(headers));
+    }
+
+    TEST_F(HttpServerTests, TlsListenerRequiresSslContext)
+    {
+        const boost::asio::ip::tcp::endpoint loopback{boost::asio::ip::make_address("127.0.0.1"), 0};
+        EXPECT_FALSE(server_->listen(loopback, ConnectionMode::Tls));
+    }
+
     TEST_F(HttpServerTests, EncryptedServerDoesNotAcceptUnencryptedConnection)
     {
         std::unordered_map<std::string, std::string> headers;
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "util/common_server_setup.hpp"
+#include "util/common_listeners.hpp"
+
+#include <roar/routing/request_listener.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include <boost/asio/write.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Roar::Tests
+{
+    class PipelineRoutes
+    {
+      public:
+        std::string large = std::string(8'000'000, 'x');
+
+      private:
+        ROAR_MAKE_LISTENER(PipelineRoutes);
+
+        ROAR_GET(largeBody)("/large");
+        ROAR_HEAD(delayedHead)("/delayedHead");
+
+      private:
+        BOOST_DESCRIBE_CLASS(PipelineRoutes, (), (), (), (roar_largeBody, roar_delayedHead))
+    };
+    inline void PipelineRoutes::largeBody(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<string_body>(req)->status(status::ok).body(large).commit();
+    }
+    inline void PipelineRoutes::delayedHead(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        std::shared_ptr<boost::asio::steady_timer> timer;
+        session.withStreamDo([&timer](auto& stream) {
+            timer = std::make_shared<boost::asio::steady_timer>(stream.get_executor(), std::chrono::milliseconds{50});
+        });
+        timer->async_wait([timer, session = session.shared_from_this(), req = std::move(req)](auto) {
+            // A HEAD response with a body type, only the header may be sent.
+            session->send<string_body>(req)->status(status::ok).body("Hello").commit();
+        });
+    }
+
+    class KeepAliveTests
+        : public CommonServerSetup
+        , public ::testing::Test
+    {
+      protected:
+        void SetUp() override
+        {
+            makeServer(0);
+        }
+
+        void makeServer(std::size_t maxRequestsPerConnection)
+        {
+            server_ = std::make_unique<Roar::Server>(Roar::Server::ConstructionArguments{
+                .executor = executor_,
+                .onError =
+                    [this](Roar::Error&& err) {
+                        errors_.push_back(std::move(err));
+                    },
+                .maxRequestsPerConnection = maxRequestsPerConnection,
+            });
+            if (!server_->start())
+                throw std::runtime_error{"Failed to start server"};
+            server_->installRequestListener<SimpleRoutes>();
+        }
+
+        void connect()
+        {
+            boost::asio::ip::tcp::resolver resolver{context_};
+            boost::asio::connect(
+                socket_, resolver.resolve("localhost", std::to_string(server_->getLocalEndpoint().port())));
+        }
+
+        boost::beast::http::response<boost::beast::http::string_body> get(std::string const& target)
+        {
+            using namespace boost::beast::http;
+            request<empty_body> req{verb::get, target, 11};
+            req.set(field::host, "localhost");
+            write(socket_, req);
+
+            response<string_body> res;
+            read(socket_, buffer_, res);
+            return res;
+        }
+
+        void pipeline(std::vector<std::string> const& targets)
+        {
+            std::vector<std::pair<boost::beast::http::verb, std::string>> requests;
+            for (auto const& target : targets)
+                requests.emplace_back(boost::beast::http::verb::get, target);
+            pipelineRequests(requests);
+        }
+
+        void pipelineRequests(std::vector<std::pair<boost::beast::http::verb, std::string>> const& requests)
+        {
+            using namespace boost::beast::http;
+            std::stringstream stream;
+            for (auto const& [method, target] : requests)
+            {
+                request<empty_body> req{method, target, 11};
+                req.set(field::host, "localhost");
+                stream << req;
+            }
+            boost::asio::write(socket_, boost::asio::buffer(stream.str()));
+        }
+
+      protected:
+        boost::asio::io_context context_{};
+        boost::asio::ip::tcp::socket socket_{context_};
+        boost::beast::flat_buffer buffer_{};
+    };
+
+    TEST_F(KeepAliveTests, ConnectionIsReusedForSubsequentRequests)
+    {
+        connect();
+        for (int i = 0; i != 5; ++i)
+        {
+            const auto res = get("/index.txt");
+            EXPECT_EQ(res.result(), boost::beast::http::status::ok);
+            EXPECT_EQ(res.body(), "Hello");
+            EXPECT_TRUE(res.keep_alive());
+        }
+    }
+
+    TEST_F(KeepAliveTests, HeaderOnlyResponsesKeepConnectionAlive)
+    {
+        connect();
+        for (int i = 0; i != 3; ++i)
+        {
+            using namespace boost::beast::http;
+            request<empty_body> req{verb::put, "/putHereNothing", 11};
+            req.set(field::host, "localhost");
+            write(socket_, req);
+
+            response<empty_body> res;
+            read(socket_, buffer_, res);
+            EXPECT_EQ(res.result(), status::no_content);
+        }
+    }
+
+    TEST_F(KeepAliveTests, ConnectionIsClosedAfterMaximumRequestCount)
+    {
+        makeServer(2);
+        connect();
+
+        auto res = get("/index.txt");
+        EXPECT_TRUE(res.keep_alive());
+
+        res = get("/index.txt");
+        EXPECT_EQ(res.result(), boost::beast::http::status::ok);
+        EXPECT_FALSE(res.keep_alive());
+
+        boost::beast::error_code ec;
+        boost::beast::http::response<boost::beast::http::string_body> another;
+        boost::beast::http::read(socket_, buffer_, another, ec);
+        EXPECT_EQ(ec, boost::beast::http::error::end_of_stream);
+    }
+
+    TEST_F(KeepAliveTests, PipelinedRequestsAreAnsweredInOrder)
+    {
+        using namespace boost::beast::http;
+        connect();
+        pipeline({"/index.txt", "/a/b", "/sendIntermediate", "/index.txt"});
+
+        for (auto const* expected : {"Hello", "AB", "Hi", "Hello"})
+        {
+            response<string_body> res;
+            read(socket_, buffer_, res);
+            EXPECT_EQ(res.result(), status::ok);
+            EXPECT_EQ(res.body(), expected);
+        }
+    }
+
+    TEST_F(KeepAliveTests, DelayedResponseKeepsStateOfItsOwnRequest)
+    {
+        using namespace boost::beast::http;
+        server_->installRequestListener<PipelineRoutes>();
+        connect();
+        // The large body fills the socket buffers while nothing is read. The HEAD handler commits late, so its
+        // response is queued behind the large one and the following GET is read before it is written.
+        pipelineRequests({{verb::get, "/large"}, {verb::head, "/delayedHead"}, {verb::get, "/index.txt"}});
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+        response_parser<string_body> large;
+        large.body_limit(16'000'000);
+        read(socket_, buffer_, large);
+        EXPECT_EQ(large.get().body().size(), 8'000'000);
+
+        response_parser<string_body> head;
+        head.skip(true);
+        read(socket_, buffer_, head);
+        EXPECT_EQ(head.get().result(), status::ok);
+        EXPECT_EQ(head.get()[field::content_length], "5");
+
+        response<string_body> res;
+        read(socket_, buffer_, res);
+        EXPECT_EQ(res.result(), status::ok);
+        EXPECT_EQ(res.body(), "Hello");
+    }
+
+    TEST_F(KeepAliveTests, PipelinedRequestsAreAnsweredAfterClientStoppedSending)
+    {
+        using namespace boost::beast::http;
+        connect();
+        pipeline({"/index.txt", "/a/b"});
+        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_send);
+
+        for (auto const* expected : {"Hello", "AB"})
+        {
+            response<string_body> res;
+            read(socket_, buffer_, res);
+            EXPECT_EQ(res.body(), expected);
+        }
+    }
+
+    TEST_F(KeepAliveTests, ConnectionIsClosedWhenClientRequestsIt)
+    {
+        using namespace boost::beast::http;
+        connect();
+
+        request<empty_body> req{verb::get, "/index.txt", 11};
+        req.set(field::host, "localhost");
+        req.keep_alive(false);
+        write(socket_, req);
+
+        response<string_body> res;
+        read(socket_, buffer_, res);
+        EXPECT_EQ(res.result(), status::ok);
+        EXPECT_FALSE(res.keep_alive());
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <roar/routing/path_template.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace Roar::Tests
+{
+    TEST(PathTemplateTests, ParsesLiteralAndParameterSegments)
+    {
+        const PathTemplate pathTemplate{"/users/{id:uint}/files/{name}"};
+        ASSERT_EQ(pathTemplate.segments().size(), 4);
+        EXPECT_EQ(pathTemplate.segments()[0].text, "users");
+        EXPECT_FALSE(pathTemplate.segments()[0].parameterType);
+        EXPECT_EQ(pathTemplate.segments()[1].text, "id");
+        EXPECT_EQ(pathTemplate.segments()[1].parameterType, PathParameterType::Uint);
+        EXPECT_EQ(pathTemplate.segments()[3].parameterType, PathParameterType::String);
+        EXPECT_EQ(pathTemplate.parameterCount(), 2);
+        EXPECT_EQ(pathTemplate.parameterIndex("name"), 1);
+        EXPECT_FALSE(pathTemplate.parameterIndex("users"));
+    }
+
+    TEST(PathTemplateTests, RejectsMalformedTemplates)
+    {
+        EXPECT_THROW(PathTemplate{"users/{id}"}, std::runtime_error);
+        EXPECT_THROW(PathTemplate{"/users/{id}.json"}, std::runtime_error);
+        EXPECT_THROW(PathTemplate{"/users/{id:float}"}, std::runtime_error);
+        EXPECT_THROW(PathTemplate{"/users/{}"}, std::runtime_error);
+        EXPECT_THROW(PathTemplate{"/{a}/{a}"}, std::runtime_error);
+    }
+
+    TEST(PathTemplateTests, OnlyParameterSegmentsMakeATemplate)
+    {
+        EXPECT_TRUE(PathTemplate::isTemplate("/users/{id}"));
+        EXPECT_TRUE(PathTemplate::isTemplate("/users/{id:uint}/files"));
+        EXPECT_TRUE(PathTemplate::isTemplate("/users/{id:float}"));
+        EXPECT_FALSE(PathTemplate::isTemplate("/plain/path"));
+        EXPECT_FALSE(PathTemplate::isTemplate("/{}"));
+        EXPECT_FALSE(PathTemplate::isTemplate("/a{b}"));
+        EXPECT_FALSE(PathTemplate::isTemplate("/{not a name}"));
+        EXPECT_FALSE(PathTemplate::isTemplate("/json/{\"key\":1}"));
+        EXPECT_FALSE(PathTemplate::isTemplate("users/{id}"));
+    }
+
+    TEST(PathTemplateTests, MatchesByParameterType)
+    {
+        const PathTemplate pathTemplate{"/items/{id:int}/{ref:uuid}"};
+        EXPECT_TRUE(pathTemplate.matches("/items/-3/123e4567-e89b-12d3-a456-426614174000"));
+        EXPECT_FALSE(pathTemplate.matches("/items/x/123e4567-e89b-12d3-a456-426614174000"));
+        EXPECT_FALSE(pathTemplate.matches("/items/3/123e4567"));
+        EXPECT_FALSE(pathTemplate.matches("/items/3"));
+        EXPECT_FALSE(pathTemplate.matches("/items/3/123e4567-e89b-12d3-a456-426614174000/"));
+    }
+
+    TEST(PathTemplateTests, ConvertsParameters)
+    {
+        EXPECT_EQ(Detail::convertPathParameter<int>("-12"), -12);
+        EXPECT_FALSE(Detail::convertPathParameter<unsigned>("12a"));
+        EXPECT_FALSE(Detail::convertPathParameter<std::uint8_t>("300"));
+        EXPECT_EQ(Detail::convertPathParameter<std::string>("abc"), "abc");
+
+        const auto uuid = Detail::convertPathParameter<Uuid>("123e4567-e89b-12d3-a456-4266141740ff");
+        ASSERT_TRUE(uuid);
+        EXPECT_EQ((*uuid)[0], 0x12);
+        EXPECT_EQ((*uuid)[15], 0xff);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <roar/detail/perfect_hash.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace Roar::Tests
+{
+    TEST(PerfectHashTableTests, EmptyTableFindsNothing)
+    {
+        const Detail::PerfectHashTable<int> table{};
+        EXPECT_EQ(table.find(boost::beast::http::verb::get, "/"), nullptr);
+    }
+
+    TEST(PerfectHashTableTests, FindsAllEntries)
+    {
+        using boost::beast::http::verb;
+        std::vector<Detail::PerfectHashTable<int>::Entry> entries;
+        for (int i = 0; i != 1500; ++i)
+            entries.push_back({.method = i % 2 ? verb::get : verb::post, .path = "/route/" + std::to_string(i), .value = i});
+
+        const Detail::PerfectHashTable<int> table{entries};
+        EXPECT_EQ(table.size(), entries.size());
+        for (auto const& entry : entries)
+        {
+            auto const* value = table.find(entry.method, entry.path);
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, entry.value);
+        }
+    }
+
+    TEST(PerfectHashTableTests, VerbIsPartOfTheKey)
+    {
+        using boost::beast::http::verb;
+        const Detail::PerfectHashTable<int> table{{
+            {.method = verb::get, .path = "/index.txt", .value = 1},
+            {.method = verb::put, .path = "/index.txt", .value = 2},
+        }};
+        EXPECT_EQ(*table.find(verb::get, "/index.txt"), 1);
+        EXPECT_EQ(*table.find(verb::put, "/index.txt"), 2);
+        EXPECT_EQ(table.find(verb::post, "/index.txt"), nullptr);
+        EXPECT_EQ(table.find(verb::get, "/index.html"), nullptr);
+    }
+
+    TEST(PerfectHashTableTests, FirstDuplicateIsKept)
+    {
+        using boost::beast::http::verb;
+        const Detail::PerfectHashTable<int> table{{
+            {.method = verb::get, .path = "/a", .value = 1},
+            {.method = verb::get, .path = "/a", .value = 2},
+        }};
+        EXPECT_EQ(table.size(), 1);
+        EXPECT_EQ(*table.find(verb::get, "/a"), 1);
+    }
+}
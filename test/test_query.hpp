@@ -0,0 +1,116 @@
+#pragma once
+
+#include <roar/url/query.hpp>
+#include <roar/detail/character_scan.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Roar::Tests
+{
+    class QueryTests : public ::testing::Test
+    {};
+
+    TEST_F(QueryTests, FindFirstOfFindsCharactersInAnyBlockPosition)
+    {
+        std::string text(100, 'a');
+        for (std::size_t i = 0; i != text.size(); ++i)
+        {
+            text[i] = i % 2 ? '%' : '+';
+            auto const* found = Detail::findFirstOf<'%', '+'>(text.data(), text.data() + text.size());
+            EXPECT_EQ(found - text.data(), i);
+            text[i] = 'a';
+        }
+        EXPECT_EQ(Detail::findFirstOf<'%'>(text.data(), text.data() + text.size()), text.data() + text.size());
+    }
+
+    TEST_F(QueryTests, DecodesPlusAndPercentEscapes)
+    {
+        EXPECT_EQ(decodeQueryComponent("hello+world%21"), "hello world!");
+        EXPECT_EQ(decodeQueryComponent("%e2%82%AC"), "\xE2\x82\xAC");
+        EXPECT_EQ(decodeQueryComponent("plain"), "plain");
+        EXPECT_EQ(decodeQueryComponent(""), "");
+    }
+
+    TEST_F(QueryTests, MalformedEscapesAreKept)
+    {
+        EXPECT_EQ(decodeQueryComponent("100%"), "100%");
+        EXPECT_EQ(decodeQueryComponent("%4"), "%4");
+        EXPECT_EQ(decodeQueryComponent("%zz%41"), "%zzA");
+    }
+
+    TEST_F(QueryTests, SplitsParametersWithoutDecoding)
+    {
+        const QueryView query{"a=1&b=x%20y;c&=d&&e=f=g"};
+
+        std::vector<std::pair<std::string_view, std::string_view>> parameters;
+        for (auto const& parameter : query)
+            parameters.emplace_back(parameter.key, parameter.value);
+
+        EXPECT_EQ(
+            parameters,
+            (std::vector<std::pair<std::string_view, std::string_view>>{
+                {"a", "1"}, {"b", "x%20y"}, {"c", ""}, {"", "d"}, {"e", "f=g"}}));
+        EXPECT_FALSE(query.begin()[0].valueIsEncoded);
+        EXPECT_TRUE(query.begin()[1].valueIsEncoded);
+        EXPECT_TRUE(QueryView{""}.empty());
+    }
+
+    TEST_F(QueryTests, GetDecodesAndLastValueWins)
+    {
+        const QueryView query{"q=red+shoes&q=blue%20shoes&tag"};
+
+        EXPECT_EQ(query.get("q"), "blue shoes");
+        EXPECT_EQ(query.get<std::string_view>("q"), "blue%20shoes");
+        EXPECT_EQ(query.get("tag"), "");
+        EXPECT_FALSE(query.get("missing"));
+        EXPECT_TRUE(query.contains("tag"));
+    }
+
+    TEST_F(QueryTests, GetAllReturnsRepeatedValuesInOrder)
+    {
+        const QueryView query{"id=1&other=x&id=2&id=three&id=4"};
+
+        EXPECT_EQ(query.getAll("id"), (std::vector<std::string>{"1", "2", "three", "4"}));
+        EXPECT_EQ(query.getAll<int>("id"), (std::vector<int>{1, 2, 4}));
+        EXPECT_TRUE(query.getAll("missing").empty());
+    }
+
+    TEST_F(QueryTests, EncodedKeysAreMatchedDecoded)
+    {
+        const QueryView query{"first+name=Jane&last%20name=Doe"};
+
+        EXPECT_EQ(query.get("first name"), "Jane");
+        EXPECT_EQ(query.get("last name"), "Doe");
+        EXPECT_FALSE(query.get("first+name"));
+    }
+
+    TEST_F(QueryTests, TypedAccessorsConvertValues)
+    {
+        const QueryView query{"page=3&ratio=0.5&debug=true&verbose=0&limit=%2D7&bad=12x"};
+
+        EXPECT_EQ(query.get<int>("page"), 3);
+        EXPECT_EQ(query.get<double>("ratio"), 0.5);
+        EXPECT_EQ(query.get<bool>("debug"), true);
+        EXPECT_EQ(query.get<bool>("verbose"), false);
+        EXPECT_EQ(query.get<long>("limit"), -7);
+        EXPECT_FALSE(query.get<unsigned>("limit"));
+        EXPECT_FALSE(query.get<int>("bad"));
+        EXPECT_FALSE(query.get<bool>("page"));
+    }
+
+    TEST_F(QueryTests, ManyParametersAreKept)
+    {
+        std::string queryString;
+        for (int i = 0; i != 200; ++i)
+            queryString += "p" + std::to_string(i) + "=" + std::to_string(i) + "&";
+        const QueryView query{queryString};
+
+        EXPECT_EQ(query.size(), 200);
+        EXPECT_EQ(query.get<int>("p0"), 0);
+        EXPECT_EQ(query.get<int>("p199"), 199);
+    }
+}
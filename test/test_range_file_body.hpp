@@ -0,0 +1,126 @@
+#pragma once
+
+#include "util/temporary_directory.hpp"
+
+#include <roar/body/range_file_body.hpp>
+
+#include <boost/beast/http/message.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+namespace Roar::Tests
+{
+    class RangeFileBodyTests : public ::testing::Test
+    {
+      protected:
+        void SetUp() override
+        {
+            for (std::size_t i = 0; i != 300'000; ++i)
+                content_.push_back(static_cast<char>('a' + i % 26));
+            std::ofstream writer{file(), std::ios::binary};
+            writer << content_;
+        }
+
+        std::filesystem::path file() const
+        {
+            return tempDir_.path() / "file.bin";
+        }
+
+        RangeFileBody::value_type open(Ranges const& ranges, std::size_t bufferSize)
+        {
+            RangeFileBody::value_type body;
+            std::error_code ec;
+            body.open(file(), std::ios_base::in, ec);
+            EXPECT_FALSE(ec);
+            body.bufferSize(bufferSize);
+            body.setReadRanges(ranges, "text/plain");
+            return body;
+        }
+
+        /**
+         * @brief Serializes the body like beast would and returns the produced bytes.
+         */
+        std::string serialize(RangeFileBody::value_type&& body, std::size_t& chunks)
+        {
+            boost::beast::http::response<RangeFileBody> response{
+                boost::beast::http::status::partial_content, 11, std::move(body)};
+            RangeFileBody::writer writer{response, response.body()};
+            boost::beast::error_code ec;
+            writer.init(ec);
+
+            std::string result;
+            chunks = 0;
+            while (auto buffer = writer.get(ec))
+            {
+                result.append(static_cast<char const*>(buffer->first.data()), buffer->first.size());
+                ++chunks;
+            }
+            EXPECT_FALSE(ec);
+            return result;
+        }
+
+        std::string expected(RangeFileBody::value_type const& body) const
+        {
+            std::string result;
+            for (auto const& segment : body.segments())
+                result += segment.prefix + content_.substr(segment.offset, segment.length);
+            return result;
+        }
+
+      protected:
+        TemporaryDirectory tempDir_{TEST_TEMPORARY_DIRECTORY};
+        std::string content_{};
+    };
+
+    TEST_F(RangeFileBodyTests, FileSizeIsKnownAfterOpen)
+    {
+        auto body = open(Ranges{.ranges = {{.start = 0, .end = 10}}}, 4096);
+        EXPECT_EQ(body.fileSize(), content_.size());
+        EXPECT_EQ(body.size(), 10);
+    }
+
+    TEST_F(RangeFileBodyTests, UnsupportedOpenModesAreRejected)
+    {
+        RangeFileBody::value_type body;
+        std::error_code ec;
+        body.open(file(), std::ios_base::in | std::ios_base::ate, ec);
+        EXPECT_EQ(ec, std::errc::invalid_argument);
+        EXPECT_FALSE(body.isOpen());
+
+        body.open(file(), std::ios_base::in | std::ios_base::binary, ec);
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(body.fileSize(), content_.size());
+    }
+
+    TEST_F(RangeFileBodyTests, SingleRangeIsReadInBufferSizedChunks)
+    {
+        auto body = open(Ranges{.ranges = {{.start = 10, .end = 250'010}}}, 64'000);
+        const auto expect = content_.substr(10, 250'000);
+        std::size_t chunks = 0;
+        EXPECT_EQ(serialize(std::move(body), chunks), expect);
+        EXPECT_EQ(chunks, 4);
+    }
+
+    TEST_F(RangeFileBodyTests, MultipartRangesAreSerializedInOrder)
+    {
+        for (std::size_t bufferSize : {1, 7, 4096, 131'072})
+        {
+            auto body = open(
+                Ranges{
+                    .ranges =
+                        {
+                            {.start = 0, .end = 5},
+                            {.start = 100, .end = 200'000},
+                            {.start = 299'990, .end = 300'000},
+                        },
+                },
+                bufferSize);
+            const auto expect = expected(body);
+            std::size_t chunks = 0;
+            EXPECT_EQ(serialize(std::move(body), chunks), expect) << "buffer size: " << bufferSize;
+        }
+    }
+}
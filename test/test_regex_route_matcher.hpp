@@ -0,0 +1,73 @@
+#pragma once
+
+#include <roar/routing/regex_route_matcher.hpp>
+#include <roar/routing/route.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace Roar::Tests
+{
+    class RegexRouteMatcherTests : public ::testing::Test
+    {
+      protected:
+        void insert(std::string const& pattern)
+        {
+            ProtoRoute proto{};
+            proto.path = Detail::RegexPath{.pattern = pattern, .regex = std::regex{pattern}};
+            auto regexPath = std::get<Detail::RegexPath>(proto.path);
+            matcher_.insert(
+                boost::beast::http::verb::get, regexPath.pattern, std::move(regexPath.regex), Route{std::move(proto)});
+        }
+
+        std::optional<std::vector<std::string>> captures(std::string const& path) const
+        {
+            auto match = matcher_.find(boost::beast::http::verb::get, path);
+            if (!match)
+                return std::nullopt;
+            return std::vector<std::string>(std::begin(match->second), std::end(match->second));
+        }
+
+      protected:
+        RegexRouteMatcher matcher_{};
+    };
+
+    TEST_F(RegexRouteMatcherTests, LiteralPrefixStopsAtFirstOperator)
+    {
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix(R"(\/api\/v1\/(\d+))"), "/api/v1/");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix("^/index.html"), "/index");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix(R"(/file\.txt)"), "/file.txt");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix(R"(/a\d)"), "/a");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix("/abc?"), "/ab");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix("/x(/y|/z)"), "/x");
+    }
+
+    TEST_F(RegexRouteMatcherTests, TopLevelAlternativeHasNoLiteralPrefix)
+    {
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix("/a|/b"), "");
+        EXPECT_EQ(RegexRouteMatcher::literalPrefix("/[|]"), "/");
+    }
+
+    TEST_F(RegexRouteMatcherTests, ReturnsCapturesOfMatchingRoute)
+    {
+        insert(R"(\/users\/(\d+))");
+        insert(R"(\/posts\/(\d+)\/(\w+))");
+
+        EXPECT_EQ(captures("/users/12"), (std::vector<std::string>{"12"}));
+        EXPECT_EQ(captures("/posts/3/title"), (std::vector<std::string>{"3", "title"}));
+        EXPECT_FALSE(captures("/users/abc"));
+        EXPECT_FALSE(captures("/other"));
+    }
+
+    TEST_F(RegexRouteMatcherTests, FirstAddedRouteWins)
+    {
+        insert(R"(\/([^\/]+)\/(.+))");
+        insert(R"(\/users\/(\d+))");
+        insert("/a|/b");
+
+        EXPECT_EQ(captures("/users/12"), (std::vector<std::string>{"users", "12"}));
+        EXPECT_EQ(captures("/b"), (std::vector<std::string>{}));
+    }
+}
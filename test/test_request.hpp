@@ -0,0 +1,125 @@
+#pragma once
+
+#include <roar/request.hpp>
+
+#include <boost/beast/http/string_body.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Roar::Tests
+{
+    class RequestTests : public ::testing::Test
+    {
+      protected:
+        static EmptyBodyRequest makeRequest(std::string_view target)
+        {
+            EmptyBodyRequest req{};
+            req.target(target);
+            return req;
+        }
+    };
+
+    TEST_F(RequestTests, PathAndQueryPointIntoTheTarget)
+    {
+        const auto req = makeRequest("/some/path?a=1&b=2");
+        const auto target = req.target();
+
+        EXPECT_EQ(req.pathView(), "/some/path");
+        EXPECT_EQ(req.pathView().data(), target.data());
+        EXPECT_EQ(req.path(), "/some/path");
+        EXPECT_EQ(req.queryString(), "a=1&b=2");
+        EXPECT_EQ(req.queryString().data(), target.data() + 11);
+    }
+
+    TEST_F(RequestTests, PathEndsAtTheFirstQuestionMark)
+    {
+        const auto req = makeRequest("/search?q=why?");
+        EXPECT_EQ(req.path(), "/search");
+        EXPECT_EQ(req.queryString(), "q=why?");
+        EXPECT_TRUE(makeRequest("/plain").queryString().empty());
+    }
+
+    TEST_F(RequestTests, QueryIsSplitIntoPairs)
+    {
+        const auto req = makeRequest("/?a=1&b=&c;d=4&&a=5");
+        const auto query = req.queryView();
+
+        EXPECT_EQ(query.size(), 5);
+        EXPECT_EQ(query.get("a"), "5");
+        EXPECT_EQ(query.get("b"), "");
+        EXPECT_EQ(query.get("c"), "");
+        EXPECT_EQ(query.get("d"), "4");
+        EXPECT_EQ(query.string().data(), req.target().data() + 2);
+    }
+
+    TEST_F(RequestTests, QueryMapKeepsLastRawValue)
+    {
+        const auto req = makeRequest("/?a=1&b=x%20y&a=5");
+        EXPECT_EQ(req.query(), (std::unordered_map<std::string, std::string>{{"a", "5"}, {"b", "x%20y"}}));
+    }
+
+    TEST_F(RequestTests, QueryMapCanBeBoundByReference)
+    {
+        auto req = makeRequest("/?k=v");
+        auto const& value = req.query().at("k");
+        EXPECT_EQ(value, "v");
+        EXPECT_EQ(&req.query(), &req.query());
+
+        req.target("/?k=w");
+        EXPECT_EQ(req.query().at("k"), "w");
+    }
+
+    TEST_F(RequestTests, PathIsOnlyDecodedOnRequest)
+    {
+        const auto req = makeRequest("/a%20b/c+d");
+        EXPECT_EQ(req.pathView(), "/a%20b/c+d");
+        EXPECT_EQ(req.decodedPath(), "/a b/c+d");
+    }
+
+    TEST_F(RequestTests, PathMatchesAreResolvedAgainstTheTarget)
+    {
+        auto req = makeRequest("/users/12/posts/3?x=y");
+        req.pathMatches({{7, 2}, {16, 1}});
+
+        ASSERT_EQ(req.pathMatchCount(), 2);
+        EXPECT_EQ(req.pathMatchAt(0), "12");
+        EXPECT_EQ(req.pathMatchAt(1), "3");
+        EXPECT_EQ(*req.pathMatches(), (std::vector<std::string>{"12", "3"}));
+        EXPECT_FALSE(makeRequest("/").pathMatches());
+    }
+
+    TEST_F(RequestTests, PathMatchesCanBeBoundByReference)
+    {
+        auto req = makeRequest("/users/12/posts/3");
+        req.pathMatches({{7, 2}, {16, 1}});
+
+        std::vector<std::string> matches;
+        for (auto const& match : *req.pathMatches())
+            matches.push_back(match);
+        EXPECT_EQ(matches, (std::vector<std::string>{"12", "3"}));
+        EXPECT_EQ(&req.pathMatches(), &req.pathMatches());
+
+        req.pathMatches({{1, 5}});
+        EXPECT_EQ(*req.pathMatches(), (std::vector<std::string>{"users"}));
+    }
+
+    TEST_F(RequestTests, ExtensionsCarryOverToRequestWithBody)
+    {
+        auto req = makeRequest("/users/12");
+        req.pathMatches({{7, 2}});
+
+        boost::beast::http::request<boost::beast::http::string_body> beastRequest{
+            boost::beast::http::verb::post, "/users/12", 11};
+        Roar::Request<boost::beast::http::string_body> upgraded{
+            std::move(beastRequest), std::move(req).ejectExtensions()};
+
+        EXPECT_EQ(upgraded.pathView(), "/users/12");
+        ASSERT_EQ(upgraded.pathMatchCount(), 1);
+        EXPECT_EQ(upgraded.pathMatchAt(0), "12");
+    }
+}
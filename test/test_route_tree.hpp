@@ -0,0 +1,87 @@
+#pragma once
+
+#include <roar/routing/route_tree.hpp>
+#include <roar/routing/route.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace Roar::Tests
+{
+    class RouteTreeTests : public ::testing::Test
+    {
+      protected:
+        void insert(boost::beast::http::verb method, std::string const& path, std::string name, bool isPrefix = false)
+        {
+            ProtoRoute proto{};
+            proto.path = path;
+            tree_.insert(method, path, Route{std::move(proto)}, isPrefix);
+
+            // Routes have stable addresses, a rejected duplicate resolves to the route that was kept.
+            const auto match = tree_.find(method, path);
+            names_.emplace(isPrefix ? match.served : match.exact, std::move(name));
+        }
+
+        std::string nameOf(Route const* route) const
+        {
+            if (route == nullptr)
+                return "";
+            return names_.at(route);
+        }
+
+      protected:
+        RouteTree tree_{};
+        std::unordered_map<Route const*, std::string> names_{};
+    };
+
+    TEST_F(RouteTreeTests, EmptyTreeFindsNothing)
+    {
+        const auto match = tree_.find(boost::beast::http::verb::get, "/index.txt");
+        EXPECT_TRUE(tree_.empty());
+        EXPECT_EQ(match.exact, nullptr);
+        EXPECT_EQ(match.served, nullptr);
+    }
+
+    TEST_F(RouteTreeTests, FindsExactRoutesWithSharedPrefixes)
+    {
+        using boost::beast::http::verb;
+        insert(verb::get, "/a", "a");
+        insert(verb::get, "/a/b", "ab");
+        insert(verb::get, "/abc", "abc");
+        insert(verb::put, "/a/b", "putAb");
+
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/a").exact), "a");
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/a/b").exact), "ab");
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/abc").exact), "abc");
+        EXPECT_EQ(nameOf(tree_.find(verb::put, "/a/b").exact), "putAb");
+        EXPECT_EQ(tree_.find(verb::get, "/ab").exact, nullptr);
+        EXPECT_EQ(tree_.find(verb::get, "/a/b/c").exact, nullptr);
+        EXPECT_EQ(tree_.find(verb::post, "/a").exact, nullptr);
+    }
+
+    TEST_F(RouteTreeTests, FirstRouteForSamePathIsKept)
+    {
+        using boost::beast::http::verb;
+        insert(verb::get, "/index.txt", "first");
+        insert(verb::get, "/index.txt", "second");
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/index.txt").exact), "first");
+    }
+
+    TEST_F(RouteTreeTests, LongestServedPathWins)
+    {
+        using boost::beast::http::verb;
+        insert(verb::get, "/static", "static", true);
+        insert(verb::get, "/static/deep", "deep", true);
+        insert(verb::get, "/static/index.html", "index");
+
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/static/file.txt").served), "static");
+        EXPECT_EQ(nameOf(tree_.find(verb::get, "/static/deep/file.txt").served), "deep");
+        EXPECT_EQ(tree_.find(verb::get, "/stat").served, nullptr);
+
+        const auto match = tree_.find(verb::get, "/static/index.html");
+        EXPECT_EQ(nameOf(match.exact), "index");
+        EXPECT_EQ(nameOf(match.served), "static");
+    }
+}
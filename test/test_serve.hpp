@@ -5,10 +5,23 @@
 #include "util/common_listeners.hpp"
 #include "util/common_server_setup.hpp"
 #include "util/temporary_directory.hpp"
+#include "util/test_sources.hpp"
 
 #include <gtest/gtest.h>
 
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <thread>
 
 namespace Roar::Tests
 {
@@ -153,6 +166,20 @@ namespace Roar::Tests
                     .pathProvider = &ServingListener::pathSupplier,
                 },
         });
+        ROAR_SERVE(cached)
+        ({
+            .path = "/cached",
+            .routeOptions = {.allowUnsecure = true},
+            .serveOptions =
+                {
+                    .allowUpload = true,
+                    .allowOverwrite = true,
+                    .allowDelete = true,
+                    .pathProvider = &ServingListener::pathSupplier,
+                    .servePrecompressed = true,
+                    .fileCache = FileCacheOptions{.timeToLive = std::chrono::minutes{1}},
+                },
+        });
 
       private: // reflection.
         BOOST_DESCRIBE_CLASS(
@@ -171,7 +198,8 @@ namespace Roar::Tests
              roar_nothingAllowed,
              roar_deleteAllowedButNotDirectories,
              roar_overwriteNotAllowed,
-             roar_deep))
+             roar_deep,
+             roar_cached))
     };
     inline void ServingListener::precendenceCheck(Session& session, EmptyBodyRequest&& req)
     {
@@ -275,6 +303,15 @@ namespace Roar::Tests
         return Roar::ServeDecision::Continue;
     }
 
+    inline Roar::ServeDecision ServingListener::cached(
+        Roar::Session& session,
+        Roar::EmptyBodyRequest const& request,
+        Roar::FileAndStatus const& fileAndStatus,
+        Roar::ServeOptions<ServingListener>& options)
+    {
+        return Roar::ServeDecision::Continue;
+    }
+
     class SlashServer
     {
       public:
@@ -517,6 +554,173 @@ namespace Roar::Tests
         EXPECT_FALSE(std::filesystem::exists(listener_->pathSupplier() / "file.txt"));
     }
 
+    TEST_F(ServeTests, CachedServeAnswersRepeatedRequests)
+    {
+        for (int i = 0; i != 3; ++i)
+        {
+            std::string body;
+            const auto res = Curl::Request{}.sink(body).get(url("/cached/file.txt"));
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(body, ServingListener::DummyFileContent);
+        }
+
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = Curl::Request{}.headerSink(headers).head(url("/cached/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(headers["Content-Length"], "13");
+    }
+
+    TEST_F(ServeTests, CachedServeForgetsDeletedFiles)
+    {
+        EXPECT_EQ(Curl::Request{}.get(url("/cached/file.txt")).code(), boost::beast::http::status::ok);
+        EXPECT_EQ(Curl::Request{}.delete_(url("/cached/file.txt")).code(), boost::beast::http::status::no_content);
+        EXPECT_EQ(Curl::Request{}.get(url("/cached/file.txt")).code(), boost::beast::http::status::not_found);
+    }
+
+    TEST_F(ServeTests, CachedServeForgetsFilesReadDuringAnUpload)
+    {
+        std::unordered_map<std::string, std::string> headers;
+        Curl::Request{}.headerSink(headers).get(url("/cached/file.txt"));
+        const auto before = headers["ETag"];
+
+        boost::asio::io_context context;
+        boost::asio::ip::tcp::socket socket{context};
+        boost::asio::ip::tcp::resolver resolver{context};
+        boost::asio::connect(socket, resolver.resolve("localhost", std::to_string(server_->getLocalEndpoint().port())));
+
+        const std::string content = "First half|Second half";
+        http::request<http::empty_body> req{http::verb::put, "/cached/file.txt", 11};
+        req.set(http::field::host, "localhost");
+        req.set(http::field::expect, "100-continue");
+        req.content_length(content.size());
+        http::request_serializer<http::empty_body> serializer{req};
+        http::write_header(socket, serializer);
+
+        boost::beast::flat_buffer buffer;
+        http::response<http::empty_body> continueResponse;
+        http::read(socket, buffer, continueResponse);
+        ASSERT_EQ(continueResponse.result(), http::status::continue_);
+
+        boost::asio::write(socket, boost::asio::buffer(content.substr(0, 11)));
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        headers.clear();
+        Curl::Request{}.headerSink(headers).get(url("/cached/file.txt"));
+        const auto during = headers["ETag"];
+
+        boost::asio::write(socket, boost::asio::buffer(content.substr(11)));
+        http::response<http::string_body> uploaded;
+        http::read(socket, buffer, uploaded);
+        ASSERT_EQ(uploaded.result(), http::status::ok);
+
+        std::string body;
+        headers.clear();
+        Curl::Request{}.headerSink(headers).sink(body).get(url("/cached/file.txt"));
+        EXPECT_EQ(body, content);
+        EXPECT_EQ(headers["Content-Length"], std::to_string(content.size()));
+        EXPECT_NE(headers["ETag"], before);
+        EXPECT_NE(headers["ETag"], during);
+    }
+
+    TEST_F(ServeTests, DownloadsCarryValidators)
+    {
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = Curl::Request{}.headerSink(headers).get(url("/allAllowed/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_FALSE(headers["ETag"].empty());
+        EXPECT_TRUE(date::fromGmtString(headers["Last-Modified"]));
+    }
+
+    TEST_F(ServeTests, MatchingEtagIsAnsweredWithNotModified)
+    {
+        std::unordered_map<std::string, std::string> headers;
+        Curl::Request{}.headerSink(headers).get(url("/cached/file.txt"));
+        const auto etag = headers["ETag"];
+
+        for (auto const& target : {"/allAllowed/file.txt", "/cached/file.txt"})
+        {
+            std::string body;
+            auto res = Curl::Request{}
+                           .setHeader(boost::beast::http::field::if_none_match, "\"other\", " + etag)
+                           .sink(body)
+                           .get(url(target));
+            EXPECT_EQ(res.code(), boost::beast::http::status::not_modified);
+            EXPECT_TRUE(body.empty());
+
+            res = Curl::Request{}.setHeader(boost::beast::http::field::if_none_match, etag).head(url(target));
+            EXPECT_EQ(res.code(), boost::beast::http::status::not_modified);
+
+            res = Curl::Request{}.setHeader(boost::beast::http::field::if_none_match, "\"other\"").get(url(target));
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        }
+    }
+
+    TEST_F(ServeTests, UnmodifiedFileIsAnsweredWithNotModified)
+    {
+        std::unordered_map<std::string, std::string> headers;
+        Curl::Request{}.headerSink(headers).get(url("/allAllowed/file.txt"));
+
+        auto res = Curl::Request{}
+                       .setHeader(boost::beast::http::field::if_modified_since, headers["Last-Modified"])
+                       .get(url("/allAllowed/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::not_modified);
+
+        res = Curl::Request{}
+                  .setHeader(boost::beast::http::field::if_modified_since, "Sun, 06 Nov 1994 08:49:37 GMT")
+                  .get(url("/allAllowed/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+    }
+
+    TEST_F(ServeTests, PrecompressedFileIsServedIfAccepted)
+    {
+        {
+            std::ofstream writer{listener_->pathSupplier() / "file.txt.gz", std::ios_base::binary};
+            writer << "Compressed";
+        }
+
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        auto res = Curl::Request{}
+                       .setHeader(boost::beast::http::field::accept_encoding, "br;q=0.5, gzip")
+                       .headerSink(headers)
+                       .sink(body)
+                       .get(url("/cached/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, "Compressed");
+        EXPECT_EQ(headers["Content-Encoding"], "gzip");
+        EXPECT_EQ(headers["Vary"], "Accept-Encoding");
+        EXPECT_EQ(headers["Content-Type"], "text/plain");
+
+        body.clear();
+        headers.clear();
+        res = Curl::Request{}
+                  .setHeader(boost::beast::http::field::accept_encoding, "gzip;q=0")
+                  .headerSink(headers)
+                  .sink(body)
+                  .get(url("/cached/file.txt"));
+        EXPECT_EQ(body, ServingListener::DummyFileContent);
+        EXPECT_EQ(headers.count("Content-Encoding"), 0);
+        EXPECT_EQ(headers["Vary"], "Accept-Encoding");
+    }
+
+    TEST_F(ServeTests, PrecompressedFilesAreNotServedUnlessEnabled)
+    {
+        {
+            std::ofstream writer{listener_->pathSupplier() / "file.txt.gz", std::ios_base::binary};
+            writer << "Compressed";
+        }
+
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::accept_encoding, "gzip")
+                             .headerSink(headers)
+                             .sink(body)
+                             .get(url("/allAllowed/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, ServingListener::DummyFileContent);
+        EXPECT_EQ(headers.count("Content-Encoding"), 0);
+    }
+
     TEST_F(ServeTests, CanGetDirectoryListingIfAllowed)
     {
         std::string body;
@@ -614,6 +818,123 @@ namespace Roar::Tests
         EXPECT_EQ(body, std::string{ServingListener::DummyFileContent}.substr(1, 2));
     }
 
+    TEST_F(ServeTests, CanMakeMultipartRangeRequest)
+    {
+        std::string body;
+        const auto res = Curl::Request{}
+                             .setHeader(boost::beast::http::field::range, "bytes=0-2,5-8")
+                             .sink(body)
+                             .get(url("/allAllowed/file.txt"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::partial_content);
+        EXPECT_NE(body.find("Content-Range: bytes 0-2/13\r\n\r\nFi"), std::string::npos);
+        EXPECT_NE(body.find("Content-Range: bytes 5-8/13\r\n\r\nCon"), std::string::npos);
+    }
+
+    TEST_F(ServeTests, CanDownloadFileLargerThanTheSocketBuffers)
+    {
+        std::string content(8_MiB, '\0');
+        LetterGenerator gen;
+        std::generate(std::begin(content), std::end(content), gen);
+        {
+            std::ofstream writer{listener_->pathSupplier() / "big.bin", std::ios_base::binary};
+            writer << content;
+        }
+
+        std::string body;
+        const auto res = Curl::Request{}.sink(body).get(url("/allAllowed/big.bin"));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body.size(), content.size());
+        EXPECT_TRUE(body == content);
+    }
+
+    TEST_F(ServeTests, CanDownloadFileOverTls)
+    {
+        std::string body;
+        const auto res = Curl::Request{}
+                             .verifyPeer(false)
+                             .verifyHost(false)
+                             .sink(body)
+                             .get(urlEncryptedServer("/allAllowed/file.txt", {.secure = true}));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body, ServingListener::DummyFileContent);
+    }
+
+    TEST_F(ServeTests, CanDownloadFilesOverTlsReadOnTheFileIoPool)
+    {
+        auto ctx = SslServerContext{
+            .certificate = std::string{certificateForTests},
+            .privateKey = std::string{keyForTests},
+            .password = std::string{keyPassphrase},
+        };
+        initializeServerSslContext(ctx);
+        secureServer_ = std::make_unique<Roar::Server>(Roar::Server::ConstructionArguments{
+            .executor = executor_,
+            .sslContext = std::move(ctx),
+            .fileIoThreads = 2,
+        });
+        ASSERT_TRUE(secureServer_->start());
+        auto listener = secureServer_->installRequestListener<ServingListener>();
+
+        std::string content(3_MiB + 7, '\0');
+        LetterGenerator gen;
+        std::generate(std::begin(content), std::end(content), gen);
+        {
+            std::ofstream writer{listener->pathSupplier() / "big.bin", std::ios_base::binary};
+            writer << content;
+        }
+
+        std::string body;
+        auto res = Curl::Request{}
+                       .verifyPeer(false)
+                       .verifyHost(false)
+                       .sink(body)
+                       .get(urlEncryptedServer("/allAllowed/big.bin", {.secure = true}));
+        EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+        EXPECT_EQ(body.size(), content.size());
+        EXPECT_TRUE(body == content);
+
+        body.clear();
+        res = Curl::Request{}
+                  .verifyPeer(false)
+                  .verifyHost(false)
+                  .setHeader(boost::beast::http::field::range, "bytes=0-2,1048576-2097151")
+                  .sink(body)
+                  .get(urlEncryptedServer("/allAllowed/big.bin", {.secure = true}));
+        EXPECT_EQ(res.code(), boost::beast::http::status::partial_content);
+        EXPECT_NE(body.find("\r\n\r\n" + content.substr(0, 2) + "\r\n"), std::string::npos);
+        EXPECT_NE(body.find("\r\n\r\n" + content.substr(1_MiB, 1_MiB - 1)), std::string::npos);
+    }
+
+    TEST_F(ServeTests, CanDownloadFileWithKernelTlsRequested)
+    {
+        // Falls back to OpenSSL where the kernel has no tls module.
+        auto ctx = SslServerContext{
+            .certificate = std::string{certificateForTests},
+            .privateKey = std::string{keyForTests},
+            .password = std::string{keyPassphrase},
+            .kernelTls = true,
+        };
+        initializeServerSslContext(ctx);
+        secureServer_ = std::make_unique<Roar::Server>(Roar::Server::ConstructionArguments{
+            .executor = executor_,
+            .sslContext = std::move(ctx),
+        });
+        ASSERT_TRUE(secureServer_->start());
+        secureServer_->installRequestListener<ServingListener>();
+
+        for (int i = 0; i != 2; ++i)
+        {
+            std::string body;
+            const auto res = Curl::Request{}
+                                 .verifyPeer(false)
+                                 .verifyHost(false)
+                                 .sink(body)
+                                 .get(urlEncryptedServer("/allAllowed/file.txt", {.secure = true}));
+            EXPECT_EQ(res.code(), boost::beast::http::status::ok);
+            EXPECT_EQ(body, ServingListener::DummyFileContent);
+        }
+    }
+
     TEST_F(SlashServeTests, CanServeSlash)
     {
         std::string body;
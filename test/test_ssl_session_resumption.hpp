@@ -0,0 +1,147 @@
+#pragma once
+
+#include "resources/keys.hpp"
+
+#include <roar/ssl/make_ssl_context.hpp>
+#include <roar/ssl/session_resumption.hpp>
+
+#include <openssl/ssl.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace Roar::Tests
+{
+    class SslSessionResumptionTests : public ::testing::Test
+    {
+      protected:
+        struct SessionDeleter
+        {
+            void operator()(SSL_SESSION* session) const
+            {
+                SSL_SESSION_free(session);
+            }
+        };
+        using SessionPointer = std::unique_ptr<SSL_SESSION, SessionDeleter>;
+
+        void TearDown() override
+        {
+            if (clientContext_)
+                SSL_CTX_free(clientContext_);
+        }
+
+        void setup(SslSessionResumptionOptions options, int maxVersion)
+        {
+            serverContext_.certificate = std::string{certificateForTests};
+            serverContext_.privateKey = std::string{keyForTests};
+            serverContext_.password = std::string{keyPassphrase};
+            serverContext_.sessionResumption = options;
+            initializeServerSslContext(serverContext_);
+
+            clientContext_ = SSL_CTX_new(TLS_client_method());
+            SSL_CTX_set_max_proto_version(clientContext_, maxVersion);
+            SSL_CTX_set_session_cache_mode(clientContext_, SSL_SESS_CACHE_CLIENT);
+        }
+
+        /**
+         * @brief Performs a full handshake over an in-memory BIO pair, optionally offering a previous session.
+         * Returns the session the client ended up with.
+         */
+        SessionPointer connect(SSL_SESSION* previous, bool& resumed)
+        {
+            SSL* client = SSL_new(clientContext_);
+            SSL* server = SSL_new(serverContext_.ctx.native_handle());
+            BIO* clientBio = nullptr;
+            BIO* serverBio = nullptr;
+            BIO_new_bio_pair(&clientBio, 0, &serverBio, 0);
+            SSL_set_bio(client, clientBio, clientBio);
+            SSL_set_bio(server, serverBio, serverBio);
+            SSL_set_connect_state(client);
+            SSL_set_accept_state(server);
+            if (previous)
+                SSL_set_session(client, previous);
+
+            bool done = false;
+            for (int i = 0; i != 100 && !done; ++i)
+                done = (SSL_do_handshake(client) == 1) & (SSL_do_handshake(server) == 1);
+            EXPECT_TRUE(done);
+
+            // TLS 1.3 tickets are sent after the handshake, exchange some data to get them across.
+            char buffer[16];
+            for (int i = 0; i != 3; ++i)
+            {
+                SSL_write(server, "x", 1);
+                SSL_read(client, buffer, sizeof(buffer));
+                SSL_write(client, "y", 1);
+                SSL_read(server, buffer, sizeof(buffer));
+            }
+
+            resumed = SSL_session_reused(client) == 1;
+            SessionPointer session{SSL_get1_session(client)};
+            SSL_shutdown(client);
+            SSL_shutdown(server);
+            SSL_free(client);
+            SSL_free(server);
+            return session;
+        }
+
+        bool reconnect(SessionPointer& session)
+        {
+            bool resumed = false;
+            session = connect(session.get(), resumed);
+            return resumed;
+        }
+
+      protected:
+        SslServerContext serverContext_{};
+        SSL_CTX* clientContext_{nullptr};
+    };
+
+    TEST_F(SslSessionResumptionTests, TicketsResumeTls13Sessions)
+    {
+        setup({.sessionTickets = true}, TLS1_3_VERSION);
+
+        bool resumed = true;
+        auto session = connect(nullptr, resumed);
+        EXPECT_FALSE(resumed);
+        for (int i = 0; i != 3; ++i)
+            EXPECT_TRUE(reconnect(session));
+
+        const auto statistics = serverContext_.sessionResumptionState->statistics();
+        EXPECT_EQ(statistics.fullHandshakes, 1);
+        EXPECT_EQ(statistics.resumedHandshakes, 3);
+        EXPECT_DOUBLE_EQ(statistics.resumptionRate(), 0.75);
+    }
+
+    TEST_F(SslSessionResumptionTests, SessionCacheResumesSessionsWithoutTickets)
+    {
+        setup({.sessionTickets = false}, TLS1_2_VERSION);
+
+        bool resumed = true;
+        auto session = connect(nullptr, resumed);
+        EXPECT_FALSE(resumed);
+        for (int i = 0; i != 3; ++i)
+            EXPECT_TRUE(reconnect(session));
+
+        const auto statistics = serverContext_.sessionResumptionState->statistics();
+        EXPECT_EQ(statistics.cacheHits, 3);
+        EXPECT_EQ(statistics.cachedSessions, 1);
+    }
+
+    TEST_F(SslSessionResumptionTests, TicketsSurviveOneKeyRotation)
+    {
+        setup({.sessionTickets = true}, TLS1_2_VERSION);
+
+        bool resumed = true;
+        auto session = connect(nullptr, resumed);
+        serverContext_.sessionResumptionState->rotateTicketKey();
+        EXPECT_TRUE(reconnect(session));
+
+        serverContext_.sessionResumptionState->rotateTicketKey();
+        serverContext_.sessionResumptionState->rotateTicketKey();
+        EXPECT_FALSE(reconnect(session));
+        EXPECT_EQ(serverContext_.sessionResumptionState->statistics().ticketKeyRotations, 3);
+    }
+}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <roar/url/url.hpp>
+#include <roar/url/encode.hpp>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <cctype>
 #include <string>
+#include <string_view>
 
 namespace Roar::Tests
 {
@@ -383,4 +386,45 @@ namespace Roar::Tests
         ASSERT_TRUE(url);
         ASSERT_EQ(url.value().pathAsString(), "/path/here");
     }
+
+    TEST_F(UrlTests, UrlEncodeKeepsOnlyUnreservedCharacters)
+    {
+        EXPECT_EQ(urlEncode(""), "");
+        EXPECT_EQ(urlEncode("AZaz09-._~"), "AZaz09-._~");
+        EXPECT_EQ(urlEncode("a b/c?d=e&f"), "a%20b%2Fc%3Fd%3De%26f");
+        EXPECT_EQ(urlEncode("\xE2\x82\xAC"), "%E2%82%AC");
+        EXPECT_EQ(urlEncode(std::string_view{"\0@", 2}), "%00%40");
+    }
+
+    TEST_F(UrlTests, UrlEncodeClassifiesEveryByteInLongInput)
+    {
+        // Long enough for the vectorized scan, every byte in every position of a block.
+        for (int byte = 0; byte != 256; ++byte)
+        {
+            std::string source(40, 'x');
+            source[byte % 40] = static_cast<char>(byte);
+            const auto encoded = urlEncode(source);
+            const auto c = static_cast<char>(byte);
+            const bool unreserved = std::isalnum(byte) || c == '-' || c == '.' || c == '_' || c == '~';
+            EXPECT_EQ(encoded.size(), unreserved ? 40 : 42) << byte;
+            EXPECT_EQ(urlDecode(encoded), source) << byte;
+        }
+    }
+
+    TEST_F(UrlTests, UrlEncodeAndDecodeAppendToOutput)
+    {
+        std::string output = "/prefix/";
+        urlEncode("a b", output);
+        EXPECT_EQ(output, "/prefix/a%20b");
+        urlDecode("%2Fc", output);
+        EXPECT_EQ(output, "/prefix/a%20b/c");
+    }
+
+    TEST_F(UrlTests, UrlDecodeKeepsPlusAndMalformedEscapes)
+    {
+        EXPECT_EQ(urlDecode("a+b%20c"), "a+b c");
+        EXPECT_EQ(urlDecode("100%"), "100%");
+        EXPECT_EQ(urlDecode("%4g%41%"), "%4gA%");
+        EXPECT_EQ(urlDecode("%e2%82%ac"), "\xE2\x82\xAC");
+    }
 }
\ No newline at end of file
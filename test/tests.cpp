@@ -3,9 +3,23 @@
 #include "test_cors.hpp"
 #include "test_reading.hpp"
 #include "test_http_server.hpp"
+#include "test_keep_alive.hpp"
 #include "test_web_socket.hpp"
 #include "test_serve.hpp"
 #include "test_url.hpp"
+#include "test_request.hpp"
+#include "test_query.hpp"
+#include "test_route_tree.hpp"
+#include "test_regex_route_matcher.hpp"
+#include "test_path_template.hpp"
+#include "test_perfect_hash.hpp"
+#include "test_admission_control.hpp"
+#include "test_ssl_session_resumption.hpp"
+#include "test_range_file_body.hpp"
+#include "test_file_cache.hpp"
+#include "test_conditional_requests.hpp"
+#include "test_content_encoding.hpp"
+#include "test_compression.hpp"
 #include "test_secure_async_client.hpp"
 #include "test_unsecure_async_client.hpp"
 
@@ -50,6 +50,7 @@ namespace Roar::Tests
         ROAR_GET(index)("/index.txt");
         ROAR_GET(ab)("/a/b");
         ROAR_GET(anything)(R"(\/([^\/]+)\/(.+))"_rgx);
+        ROAR_GET(userFile)("/users/{id:uint}/files/{name}");
         ROAR_PUT(putHere)("/putHere");
         ROAR_PUT(putHereNothing)("/putHereNothing");
         ROAR_POST(postHere)("/postHere");
@@ -104,6 +105,7 @@ namespace Roar::Tests
              roar_headHere,
              roar_anything,
              roar_ab,
+             roar_userFile,
              roar_sse,
              roar_unsecure,
              roar_sendIntermediate,
@@ -218,6 +220,19 @@ namespace Roar::Tests
             .status(status::ok)
             .commit();
     }
+    inline void SimpleRoutes::userFile(Session& session, EmptyBodyRequest&& req)
+    {
+        using namespace boost::beast::http;
+        session.send<string_body>(req)
+            ->body(nlohmann::json{
+                {"id", *req.pathParameter<std::uint64_t>("id")},
+                {"name", std::string{*req.pathParameter("name")}},
+            })
+            .contentType("text/plain")
+            .preparePayload()
+            .status(status::ok)
+            .commit();
+    }
     inline void SimpleRoutes::unsecure(Session& session, EmptyBodyRequest&& req)
     {
         using namespace boost::beast::http;